@@ -33,6 +33,20 @@ if(BUILD_FAIRMQ)
   find_package2(BUNDLED PicoSHA2 REQUIRED)
   set(PicoSHA2_VERSION "1.0.0")
   set(PicoSHA2_PREFIX "<bundled>")
+
+  # optional codecs for the channel compression (zeromq transport)
+  find_package2(PRIVATE LZ4)
+  find_package2(PRIVATE zstd)
+  if(LZ4_FOUND)
+    set(FAIRMQ_HAS_LZ4 1)
+  else()
+    set(FAIRMQ_HAS_LZ4 0)
+  endif()
+  if(zstd_FOUND)
+    set(FAIRMQ_HAS_ZSTD 1)
+  else()
+    set(FAIRMQ_HAS_ZSTD 0)
+  endif()
 endif()
 
 if(BUILD_TESTING)
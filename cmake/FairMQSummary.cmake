@@ -94,11 +94,21 @@ macro(fairmq_summary_debug_mode)
   endif()
 endmacro()
 
+macro(fairmq_summary_shm_block_walk)
+  if(FAIRMQ_SHM_BLOCK_WALK)
+    message(STATUS "  ${Cyan}SHM BLOCK WALK${CR}     ${BGreen}${FAIRMQ_SHM_BLOCK_WALK}${CR} (disable with ${BMagenta}-DFAIRMQ_SHM_BLOCK_WALK=OFF${CR})")
+  else()
+    message(STATUS "  ${Cyan}SHM BLOCK WALK${CR}     ${BRed}${FAIRMQ_SHM_BLOCK_WALK}${CR} (enable with ${BMagenta}-DFAIRMQ_SHM_BLOCK_WALK=ON${CR})")
+  endif()
+endmacro()
+
 macro(fairmq_summary_compile_definitions)
   message(STATUS "  ")
   message(STATUS "  ${Cyan}COMPILE DEFINITION               VALUE${CR}")
   message(STATUS "  ${BWhite}FAIRMQ_HAS_STD_FILESYSTEM${CR}        ${FAIRMQ_HAS_STD_FILESYSTEM}  (overridable with ${BMagenta}-DFAIRMQ_HAS_STD_FILESYSTEM=0|1${CR})")
   message(STATUS "  ${BWhite}FAIRMQ_HAS_STD_PMR${CR}               ${FAIRMQ_HAS_STD_PMR}  (overridable with ${BMagenta}-DFAIRMQ_HAS_STD_PMR=0|1${CR})")
+  message(STATUS "  ${BWhite}FAIRMQ_HAS_LZ4${CR}                   ${FAIRMQ_HAS_LZ4}  (channel compression, found LZ4 library)")
+  message(STATUS "  ${BWhite}FAIRMQ_HAS_ZSTD${CR}                  ${FAIRMQ_HAS_ZSTD}  (channel compression, found zstd library)")
   if(DEFINED FAIRMQ_CHANNEL_DEFAULT_AUTOBIND)
     message(STATUS "  ${BWhite}FAIRMQ_CHANNEL_DEFAULT_AUTOBIND${CR}  ${FAIRMQ_CHANNEL_DEFAULT_AUTOBIND}")
   endif()
@@ -0,0 +1,78 @@
+################################################################################
+# Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH       #
+#                                                                              #
+#              This software is distributed under the terms of the             #
+#              GNU Lesser General Public Licence (LGPL) version 3,             #
+#                  copied verbatim in the file "LICENSE"                       #
+################################################################################
+#
+# ##########################
+# # Locate the LZ4 library #
+# ##########################
+#
+#
+# Usage:
+#
+#   find_package(LZ4 [version] [QUIET] [REQUIRED])
+#
+#
+# Defines the following variables:
+#
+#   LZ4_FOUND - Found the LZ4 library
+#   LZ4_INCLUDE_DIR (CMake cache) - Include directory
+#   LZ4_LIBRARY (CMake cache) - Path to liblz4
+#   LZ4_VERSION - full version string
+#
+# and the imported target LZ4::LZ4.
+#
+#
+# Accepts the following variables as hints for installation directories:
+#
+#   LZ4_ROOT (CMake var, ENV var)
+#
+
+if(NOT LZ4_ROOT)
+  set(LZ4_ROOT $ENV{LZ4_ROOT})
+endif()
+
+find_path(LZ4_INCLUDE_DIR
+  NAMES lz4.h lz4hc.h
+  HINTS ${LZ4_ROOT}
+  PATH_SUFFIXES include
+  DOC "LZ4 include directory"
+)
+
+find_library(LZ4_LIBRARY
+  NAMES lz4
+  HINTS ${LZ4_ROOT}
+  PATH_SUFFIXES lib
+  DOC "Path to liblz4"
+)
+
+if(LZ4_INCLUDE_DIR AND EXISTS "${LZ4_INCLUDE_DIR}/lz4.h")
+  file(READ "${LZ4_INCLUDE_DIR}/lz4.h" _LZ4_HEADER_FILE_CONTENT)
+  string(REGEX MATCH "#define LZ4_VERSION_MAJOR +([0-9]+)" _MATCH "${_LZ4_HEADER_FILE_CONTENT}")
+  set(_LZ4_VERSION_MAJOR ${CMAKE_MATCH_1})
+  string(REGEX MATCH "#define LZ4_VERSION_MINOR +([0-9]+)" _MATCH "${_LZ4_HEADER_FILE_CONTENT}")
+  set(_LZ4_VERSION_MINOR ${CMAKE_MATCH_1})
+  string(REGEX MATCH "#define LZ4_VERSION_RELEASE +([0-9]+)" _MATCH "${_LZ4_HEADER_FILE_CONTENT}")
+  set(_LZ4_VERSION_RELEASE ${CMAKE_MATCH_1})
+  set(LZ4_VERSION "${_LZ4_VERSION_MAJOR}.${_LZ4_VERSION_MINOR}.${_LZ4_VERSION_RELEASE}")
+  unset(_LZ4_HEADER_FILE_CONTENT)
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4
+  REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR
+  VERSION_VAR LZ4_VERSION
+)
+
+if(LZ4_FOUND AND NOT TARGET LZ4::LZ4)
+  add_library(LZ4::LZ4 UNKNOWN IMPORTED)
+  set_target_properties(LZ4::LZ4 PROPERTIES
+    IMPORTED_LOCATION ${LZ4_LIBRARY}
+    INTERFACE_INCLUDE_DIRECTORIES ${LZ4_INCLUDE_DIR}
+  )
+endif()
+
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
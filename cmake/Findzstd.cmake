@@ -0,0 +1,78 @@
+################################################################################
+# Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH       #
+#                                                                              #
+#              This software is distributed under the terms of the             #
+#              GNU Lesser General Public Licence (LGPL) version 3,             #
+#                  copied verbatim in the file "LICENSE"                       #
+################################################################################
+#
+# ###########################
+# # Locate the zstd library #
+# ###########################
+#
+#
+# Usage:
+#
+#   find_package(zstd [version] [QUIET] [REQUIRED])
+#
+#
+# Defines the following variables:
+#
+#   zstd_FOUND - Found the zstd library
+#   zstd_INCLUDE_DIR (CMake cache) - Include directory
+#   zstd_LIBRARY (CMake cache) - Path to libzstd
+#   zstd_VERSION - full version string
+#
+# and the imported target zstd::zstd.
+#
+#
+# Accepts the following variables as hints for installation directories:
+#
+#   ZSTD_ROOT (CMake var, ENV var)
+#
+
+if(NOT ZSTD_ROOT)
+  set(ZSTD_ROOT $ENV{ZSTD_ROOT})
+endif()
+
+find_path(zstd_INCLUDE_DIR
+  NAMES zstd.h
+  HINTS ${ZSTD_ROOT}
+  PATH_SUFFIXES include
+  DOC "zstd include directory"
+)
+
+find_library(zstd_LIBRARY
+  NAMES zstd
+  HINTS ${ZSTD_ROOT}
+  PATH_SUFFIXES lib
+  DOC "Path to libzstd"
+)
+
+if(zstd_INCLUDE_DIR AND EXISTS "${zstd_INCLUDE_DIR}/zstd.h")
+  file(READ "${zstd_INCLUDE_DIR}/zstd.h" _zstd_HEADER_FILE_CONTENT)
+  string(REGEX MATCH "#define ZSTD_VERSION_MAJOR +([0-9]+)" _MATCH "${_zstd_HEADER_FILE_CONTENT}")
+  set(_zstd_VERSION_MAJOR ${CMAKE_MATCH_1})
+  string(REGEX MATCH "#define ZSTD_VERSION_MINOR +([0-9]+)" _MATCH "${_zstd_HEADER_FILE_CONTENT}")
+  set(_zstd_VERSION_MINOR ${CMAKE_MATCH_1})
+  string(REGEX MATCH "#define ZSTD_VERSION_RELEASE +([0-9]+)" _MATCH "${_zstd_HEADER_FILE_CONTENT}")
+  set(_zstd_VERSION_RELEASE ${CMAKE_MATCH_1})
+  set(zstd_VERSION "${_zstd_VERSION_MAJOR}.${_zstd_VERSION_MINOR}.${_zstd_VERSION_RELEASE}")
+  unset(_zstd_HEADER_FILE_CONTENT)
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(zstd
+  REQUIRED_VARS zstd_LIBRARY zstd_INCLUDE_DIR
+  VERSION_VAR zstd_VERSION
+)
+
+if(zstd_FOUND AND NOT TARGET zstd::zstd)
+  add_library(zstd::zstd UNKNOWN IMPORTED)
+  set_target_properties(zstd::zstd PROPERTIES
+    IMPORTED_LOCATION ${zstd_LIBRARY}
+    INTERFACE_INCLUDE_DIRECTORIES ${zstd_INCLUDE_DIR}
+  )
+endif()
+
+mark_as_advanced(zstd_INCLUDE_DIR zstd_LIBRARY)
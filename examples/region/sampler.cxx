@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace bpo = boost::program_options;
 
@@ -67,23 +68,23 @@ struct Sampler : fair::mq::Device
 
         fair::mq::tools::RateLimiter rateLimiter(fSamplingRate);
 
+        auto& channel = GetChannel(fChanName, 0);
+        std::vector<fair::mq::RegionBlock> blocks;
+        blocks.reserve(64);
+
         while (!NewStatePending()) {
-            fair::mq::Parts parts;
-            // make 64 parts
+            // send 64 blocks of the region as one multipart message
+            blocks.clear();
             for (int i = 0; i < 64; ++i) {
-                parts.AddPart(NewMessageFor(
-                    fChanName, // channel
-                    0, // sub-channel
-                    fRegion, // region
-                    fRegion->GetData(), // ptr within region
-                    fMsgSize, // offset from ptr
-                    nullptr // hint
-                    ));
+                blocks.emplace_back(fRegion->GetData(), // ptr within region
+                                    fMsgSize, // size of the block
+                                    nullptr // hint
+                );
             }
 
             std::lock_guard<std::mutex> lock(fMtx);
-            fNumUnackedMsgs += parts.Size();
-            if (Send(parts, fChanName, 0) > 0) {
+            fNumUnackedMsgs += blocks.size();
+            if (channel.SendRegionBlocks(fRegion, blocks) > 0) {
                 if (fMaxIterations > 0 && ++fNumIterations >= fMaxIterations) {
                     LOG(info) << "Configured maximum number of iterations reached. Stopping sending.";
                     break;
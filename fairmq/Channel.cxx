@@ -16,6 +16,7 @@
 #include <random>
 #include <regex>
 #include <set>
+#include <thread>
 
 namespace fair::mq {
 
@@ -46,6 +47,13 @@ constexpr int Channel::DefaultLinger;
 constexpr int Channel::DefaultRateLogging;
 constexpr int Channel::DefaultPortRangeMin;
 constexpr int Channel::DefaultPortRangeMax;
+constexpr const char* Channel::DefaultCompression;
+constexpr int Channel::DefaultCompressionLevel;
+constexpr int Channel::DefaultCompressionThreshold;
+constexpr int Channel::DefaultCompressionThreads;
+constexpr int64_t Channel::DefaultMaxBytesPerSec;
+constexpr int64_t Channel::DefaultMaxMsgsPerSec;
+constexpr int Channel::DefaultShapingBurstMs;
 constexpr bool Channel::DefaultAutoBind;
 
 Channel::Channel()
@@ -82,6 +90,13 @@ Channel::Channel(string name, string type, string method, string address, shared
     , fRateLogging(DefaultRateLogging)
     , fPortRangeMin(DefaultPortRangeMin)
     , fPortRangeMax(DefaultPortRangeMax)
+    , fCompression(DefaultCompression)
+    , fCompressionLevel(DefaultCompressionLevel)
+    , fCompressionThreshold(DefaultCompressionThreshold)
+    , fCompressionThreads(DefaultCompressionThreads)
+    , fMaxBytesPerSec(DefaultMaxBytesPerSec)
+    , fMaxMsgsPerSec(DefaultMaxMsgsPerSec)
+    , fShapingBurstMs(DefaultShapingBurstMs)
     , fAutoBind(DefaultAutoBind)
     , fValid(false)
     , fMultipart(false)
@@ -108,6 +123,13 @@ Channel::Channel(const string& name, int index, const Properties& properties)
     fRateLogging = GetPropertyOrDefault(properties, string(prefix + "rateLogging"), DefaultRateLogging);
     fPortRangeMin = GetPropertyOrDefault(properties, string(prefix + "portRangeMin"), DefaultPortRangeMin);
     fPortRangeMax = GetPropertyOrDefault(properties, string(prefix + "portRangeMax"), DefaultPortRangeMax);
+    fCompression = GetPropertyOrDefault(properties, string(prefix + "compression"), std::string(DefaultCompression));
+    fCompressionLevel = GetPropertyOrDefault(properties, string(prefix + "compressionLevel"), DefaultCompressionLevel);
+    fCompressionThreshold = GetPropertyOrDefault(properties, string(prefix + "compressionThreshold"), DefaultCompressionThreshold);
+    fCompressionThreads = GetPropertyOrDefault(properties, string(prefix + "compressionThreads"), DefaultCompressionThreads);
+    fMaxBytesPerSec = GetPropertyOrDefault(properties, string(prefix + "maxBytesPerSec"), DefaultMaxBytesPerSec);
+    fMaxMsgsPerSec = GetPropertyOrDefault(properties, string(prefix + "maxMsgsPerSec"), DefaultMaxMsgsPerSec);
+    fShapingBurstMs = GetPropertyOrDefault(properties, string(prefix + "shapingBurstMs"), DefaultShapingBurstMs);
     fAutoBind = GetPropertyOrDefault(properties, string(prefix + "autoBind"), DefaultAutoBind);
 }
 
@@ -133,9 +155,17 @@ Channel::Channel(const Channel& chan, string newName)
     , fRateLogging(chan.fRateLogging)
     , fPortRangeMin(chan.fPortRangeMin)
     , fPortRangeMax(chan.fPortRangeMax)
+    , fCompression(chan.fCompression)
+    , fCompressionLevel(chan.fCompressionLevel)
+    , fCompressionThreshold(chan.fCompressionThreshold)
+    , fCompressionThreads(chan.fCompressionThreads)
+    , fMaxBytesPerSec(chan.fMaxBytesPerSec)
+    , fMaxMsgsPerSec(chan.fMaxMsgsPerSec)
+    , fShapingBurstMs(chan.fShapingBurstMs)
     , fAutoBind(chan.fAutoBind)
     , fValid(false)
     , fMultipart(chan.fMultipart)
+    , fShaper(nullptr)
 {}
 
 Channel& Channel::operator=(const Channel& chan)
@@ -161,9 +191,17 @@ Channel& Channel::operator=(const Channel& chan)
     fRateLogging = chan.fRateLogging;
     fPortRangeMin = chan.fPortRangeMin;
     fPortRangeMax = chan.fPortRangeMax;
+    fCompression = chan.fCompression;
+    fCompressionLevel = chan.fCompressionLevel;
+    fCompressionThreshold = chan.fCompressionThreshold;
+    fCompressionThreads = chan.fCompressionThreads;
+    fMaxBytesPerSec = chan.fMaxBytesPerSec;
+    fMaxMsgsPerSec = chan.fMaxMsgsPerSec;
+    fShapingBurstMs = chan.fShapingBurstMs;
     fAutoBind = chan.fAutoBind;
     fValid = false;
     fMultipart = chan.fMultipart;
+    fShaper = nullptr;
 
     return *this;
 }
@@ -308,6 +346,54 @@ try {
         throw ChannelConfigurationError(tools::ToString("invalid socket rate logging interval (cannot be negative): '", fRateLogging, "'"));
     }
 
+    // validate compression
+    if (fCompression != "none" && fCompression != "lz4" && fCompression != "zstd") {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid compression codec: '" << fCompression << "' (expected none, lz4 or zstd)";
+        throw ChannelConfigurationError(tools::ToString("invalid compression codec: '", fCompression, "' (expected none, lz4 or zstd)"));
+    }
+    // compression is implemented by the zeromq transport only (the transport of the channel is resolved once it has a factory)
+    const mq::Transport transport = fTransportFactory ? fTransportFactory->GetType() : fTransportType;
+    if (fCompression != "none" && transport != mq::Transport::ZMQ && transport != mq::Transport::DEFAULT) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid compression codec: '" << fCompression << "' (not supported by the " << TransportName(transport) << " transport)";
+        throw ChannelConfigurationError(tools::ToString("invalid compression codec: '", fCompression, "' (not supported by the ", TransportName(transport), " transport)"));
+    }
+    if (fCompressionThreshold < 0) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid compression threshold (cannot be negative): '" << fCompressionThreshold << "'";
+        throw ChannelConfigurationError(tools::ToString("invalid compression threshold (cannot be negative): '", fCompressionThreshold, "'"));
+    }
+    if (fCompressionThreads < 1) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid number of compression threads (must be at least 1): '" << fCompressionThreads << "'";
+        throw ChannelConfigurationError(tools::ToString("invalid number of compression threads (must be at least 1): '", fCompressionThreads, "'"));
+    }
+
+    // validate traffic shaping
+    if (fMaxBytesPerSec < 0) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid bandwidth limit (cannot be negative): '" << fMaxBytesPerSec << "'";
+        throw ChannelConfigurationError(tools::ToString("invalid bandwidth limit (cannot be negative): '", fMaxBytesPerSec, "'"));
+    }
+    if (fMaxMsgsPerSec < 0) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid message rate limit (cannot be negative): '" << fMaxMsgsPerSec << "'";
+        throw ChannelConfigurationError(tools::ToString("invalid message rate limit (cannot be negative): '", fMaxMsgsPerSec, "'"));
+    }
+    if (fShapingBurstMs < 0) {
+        ss << "INVALID";
+        LOG(debug) << ss.str();
+        LOG(error) << "invalid shaping burst allowance (cannot be negative): '" << fShapingBurstMs << "'";
+        throw ChannelConfigurationError(tools::ToString("invalid shaping burst allowance (cannot be negative): '", fShapingBurstMs, "'"));
+    }
+
     fValid = true;
     ss << "VALID";
     LOG(debug) << ss.str();
@@ -335,6 +421,90 @@ void Channel::Init()
     if (fRcvKernelSize != 0) {
         fSocket->SetRcvKernelSize(fRcvKernelSize);
     }
+
+    if (fCompression != "none") {
+        fSocket->SetCompression(fCompression, fCompressionLevel, fCompressionThreshold, fCompressionThreads);
+    }
+
+    fShaper.reset();
+    if (fMaxBytesPerSec > 0 || fMaxMsgsPerSec > 0) {
+        fShaper = make_unique<Shaper>();
+        const chrono::milliseconds burst(fShapingBurstMs);
+        if (fMaxBytesPerSec > 0) {
+            fShaper->fBytes = make_unique<tools::TokenBucket>(static_cast<double>(fMaxBytesPerSec), burst);
+        }
+        if (fMaxMsgsPerSec > 0) {
+            fShaper->fMsgs = make_unique<tools::TokenBucket>(static_cast<double>(fMaxMsgsPerSec), burst);
+        }
+    }
+}
+
+int64_t Channel::Shape(uint64_t bytes, int& timeoutMs)
+{
+    const chrono::nanoseconds maxWait = timeoutMs < 0 ? chrono::nanoseconds(-1) : chrono::nanoseconds(chrono::milliseconds(timeoutMs));
+
+    chrono::nanoseconds wait(0);
+    if (fShaper->fBytes) {
+        wait = fShaper->fBytes->Reserve(bytes, maxWait);
+        if (wait.count() < 0) {
+            ++fShaper->fTimeouts;
+            return static_cast<int64_t>(TransferCode::timeout);
+        }
+    }
+    if (fShaper->fMsgs) {
+        auto msgWait = fShaper->fMsgs->Reserve(1, maxWait);
+        if (msgWait.count() < 0) {
+            if (fShaper->fBytes) {
+                fShaper->fBytes->Release(bytes);
+            }
+            ++fShaper->fTimeouts;
+            return static_cast<int64_t>(TransferCode::timeout);
+        }
+        wait = max(wait, msgWait);
+    }
+
+    if (wait.count() == 0) {
+        return 0;
+    }
+
+    ++fShaper->fDelayedSends;
+    fShaper->fDelayNs += wait.count();
+
+    // wait in slices to react to an interruption (e.g. state change) like a blocked send would
+    const auto deadline = chrono::steady_clock::now() + wait;
+    for (auto now = chrono::steady_clock::now(); now < deadline; now = chrono::steady_clock::now()) {
+        if (fTransportFactory->Interrupted()) {
+            Unshape(bytes);
+            return static_cast<int64_t>(TransferCode::interrupted);
+        }
+        this_thread::sleep_for(min<chrono::steady_clock::duration>(deadline - now, chrono::milliseconds(100)));
+    }
+
+    if (timeoutMs > 0) {
+        timeoutMs = max(0, timeoutMs - static_cast<int>(chrono::duration_cast<chrono::milliseconds>(wait).count()));
+    }
+    return 0;
+}
+
+void Channel::Unshape(uint64_t bytes)
+{
+    if (fShaper->fBytes) {
+        fShaper->fBytes->Release(bytes);
+    }
+    if (fShaper->fMsgs) {
+        fShaper->fMsgs->Release(1);
+    }
+}
+
+Channel::ShapingStats Channel::GetShapingStats() const
+{
+    ShapingStats stats;
+    if (fShaper) {
+        stats.delayedSends = fShaper->fDelayedSends.load();
+        stats.delay = chrono::nanoseconds(fShaper->fDelayNs.load());
+        stats.timeouts = fShaper->fTimeouts.load();
+    }
+    return stats;
 }
 
 bool Channel::ConnectEndpoint(const string& endpoint)
@@ -9,6 +9,7 @@
 #ifndef FAIR_MQ_CHANNEL_H
 #define FAIR_MQ_CHANNEL_H
 
+#include <fairmq/Gather.h>
 #include <fairmq/Message.h>
 #include <fairmq/Parts.h>
 #include <fairmq/Properties.h>
@@ -16,12 +17,16 @@
 #include <fairmq/TransportFactory.h>
 #include <fairmq/TransportEnum.h>
 #include <fairmq/UnmanagedRegion.h>
+#include <fairmq/tools/TokenBucket.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>   // int64_t
 #include <memory>   // unique_ptr, shared_ptr
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>   // std::move
 #include <vector>
 
@@ -191,6 +196,34 @@ class Channel
     /// @return end of the port range
     int GetPortRangeMax() const { return fPortRangeMax; }
 
+    /// Get compression codec
+    /// @return Returns compression codec ("none", "lz4" or "zstd")
+    std::string GetCompression() const { return fCompression; }
+
+    /// Get compression level
+    /// @return Returns compression level (0 - codec default)
+    int GetCompressionLevel() const { return fCompressionLevel; }
+
+    /// Get compression threshold (in bytes)
+    /// @return Returns compression threshold (in bytes), smaller parts are sent uncompressed
+    int GetCompressionThreshold() const { return fCompressionThreshold; }
+
+    /// Get number of compression threads
+    /// @return Returns number of threads compressing/decompressing large parts
+    int GetCompressionThreads() const { return fCompressionThreads; }
+
+    /// Get the bandwidth limit of the channel (in bytes per second)
+    /// @return Returns maximum number of bytes sent per second (0 - unlimited)
+    int64_t GetMaxBytesPerSec() const { return fMaxBytesPerSec; }
+
+    /// Get the message rate limit of the channel
+    /// @return Returns maximum number of messages (single or multipart) sent per second (0 - unlimited)
+    int64_t GetMaxMsgsPerSec() const { return fMaxMsgsPerSec; }
+
+    /// Get the burst allowance of the traffic shaping (in ms)
+    /// @return Returns the time at the full rate that can be sent in a burst after a pause
+    int GetShapingBurstMs() const { return fShapingBurstMs; }
+
     /// Set automatic binding (pick random port if bind fails)
     /// @return true/false, true if automatic binding is enabled
     bool GetAutoBind() const { return fAutoBind; }
@@ -263,6 +296,34 @@ class Channel
     /// @param maxPort end of the port range
     void UpdatePortRangeMax(int maxPort) { fPortRangeMax = maxPort; Invalidate(); }
 
+    /// Set compression codec (zeromq transport only, the peer has to use compression too)
+    /// @param compression compression codec ("none", "lz4" or "zstd")
+    void UpdateCompression(const std::string& compression) { fCompression = compression; Invalidate(); }
+
+    /// Set compression level
+    /// @param level compression level (0 - codec default)
+    void UpdateCompressionLevel(int level) { fCompressionLevel = level; Invalidate(); }
+
+    /// Set compression threshold (in bytes)
+    /// @param threshold compression threshold (in bytes), smaller parts are sent uncompressed
+    void UpdateCompressionThreshold(int threshold) { fCompressionThreshold = threshold; Invalidate(); }
+
+    /// Set number of compression threads
+    /// @param threads number of threads compressing/decompressing large parts
+    void UpdateCompressionThreads(int threads) { fCompressionThreads = threads; Invalidate(); }
+
+    /// Set the bandwidth limit of the channel, enforced in Send()
+    /// @param maxBytesPerSec maximum number of bytes sent per second (0 - unlimited)
+    void UpdateMaxBytesPerSec(int64_t maxBytesPerSec) { fMaxBytesPerSec = maxBytesPerSec; Invalidate(); }
+
+    /// Set the message rate limit of the channel, enforced in Send()
+    /// @param maxMsgsPerSec maximum number of messages (single or multipart) sent per second (0 - unlimited)
+    void UpdateMaxMsgsPerSec(int64_t maxMsgsPerSec) { fMaxMsgsPerSec = maxMsgsPerSec; Invalidate(); }
+
+    /// Set the burst allowance of the traffic shaping
+    /// @param burstMs time at the full rate that can be sent in a burst after a pause (in ms)
+    void UpdateShapingBurstMs(int burstMs) { fShapingBurstMs = burstMs; Invalidate(); }
+
     /// Set automatic binding (pick random port if bind fails)
     /// @param autobind true/false, true to enable automatic binding
     void UpdateAutoBind(bool autobind) { fAutoBind = autobind; Invalidate(); }
@@ -285,6 +346,9 @@ class Channel
     void Invalidate() { fValid = false; }
 
     /// Send message(s) to the socket queue.
+    /// If the channel has a bandwidth or message rate limit (maxBytesPerSec/maxMsgsPerSec), Send() waits until
+    /// the message fits into the limit. The wait counts towards the send timeout. Messages that are not sent do not
+    /// count towards the limit.
     /// @param m reference to MessagePtr/Parts/vector<MessagePtr>
     /// @param sndTimeoutMs send timeout in ms.
     /// -1 will wait forever (or until interrupt (e.g. via state change)),
@@ -305,6 +369,17 @@ class Channel
         if constexpr (sizeof...(sndTimeoutMs) == 1) {
             t = {sndTimeoutMs...};
         }
+        if (fShaper) {
+            const uint64_t size = TransferSize(m);
+            if (int64_t code = Shape(size, t); code < 0) {
+                return code;
+            }
+            int64_t nbytes = fSocket->Send(m, t);
+            if (nbytes < 0) {
+                Unshape(size);
+            }
+            return nbytes;
+        }
         return fSocket->Send(m, t);
     }
 
@@ -332,17 +407,107 @@ class Channel
         return fSocket->Receive(m, t);
     }
 
+    /// Gather several buffers into a single message and send it to the socket queue.
+    /// The buffers are copied into one allocation of the channel transport (for shmem in the managed segment),
+    /// avoiding the per-part overhead of sending them as separate parts. Receive as a MessagePtr and
+    /// access the individual buffers via fair::mq::GatherView.
+    /// @param buffers buffers to gather
+    /// @param count number of buffers
+    /// @param sndTimeoutMs send timeout in ms (see Send())
+    /// @return Number of bytes that have been queued (including the gather header), or a TransferCode (see Send())
+    template<typename... Timeout>
+    int64_t SendGather(const GatherBuffer* buffers, size_t count, Timeout&&... sndTimeoutMs)
+    {
+        MessagePtr msg = gather::Pack(*Transport(), buffers, count);
+        return Send(msg, std::forward<Timeout>(sndTimeoutMs)...);
+    }
+
+    template<typename... Timeout>
+    int64_t SendGather(const std::vector<GatherBuffer>& buffers, Timeout&&... sndTimeoutMs)
+    {
+        return SendGather(buffers.data(), buffers.size(), std::forward<Timeout>(sndTimeoutMs)...);
+    }
+
+    /// Send blocks of an unmanaged region as one multipart message.
+    /// With the shmem transport the blocks are described on the wire by the region id and an offset/size/hint
+    /// array, without constructing a message object per block on the sending side. The receiver gets them as
+    /// regular region messages in a Parts. Other transports send the blocks as individual region messages.
+    /// If sending fails (timeout, interruption, transport error), the blocks are released via the region callback,
+    /// as if they had been sent as region messages that went out of scope unsent. Invalid arguments (region of
+    /// another transport, blocks outside of the region) are rejected without releasing the blocks.
+    /// @param region region containing the blocks (created with the transport of this channel)
+    /// @param blocks blocks to send
+    /// @param sndTimeoutMs send timeout in ms (see Send())
+    /// @return Number of bytes that have been queued, or a TransferCode (see Send())
+    template<typename... Timeout>
+    int64_t SendRegionBlocks(UnmanagedRegionPtr& region, const std::vector<RegionBlock>& blocks, Timeout&&... sndTimeoutMs)
+    {
+        static_assert(sizeof...(sndTimeoutMs) <= 1, "SendRegionBlocks called with too many arguments");
+
+        int t = fSndTimeoutMs;
+        if constexpr (sizeof...(sndTimeoutMs) == 1) {
+            t = {sndTimeoutMs...};
+        }
+        if (fTransportType == Transport::SHM) {
+            if (fShaper) {
+                uint64_t size = 0;
+                for (const auto& block : blocks) {
+                    size += block.size;
+                }
+                if (int64_t code = Shape(size, t); code < 0) {
+                    // release the blocks like a failed send, via region messages going out of scope unsent
+                    for (const auto& block : blocks) {
+                        NewMessage(region, block.ptr, block.size, block.hint);
+                    }
+                    return code;
+                }
+                int64_t nbytes = fSocket->SendRegionBlocks(region, blocks.data(), blocks.size(), t);
+                if (nbytes < 0) {
+                    Unshape(size);
+                }
+                return nbytes;
+            }
+            return fSocket->SendRegionBlocks(region, blocks.data(), blocks.size(), t);
+        }
+        Parts parts;
+        parts.Reserve(blocks.size());
+        for (const auto& block : blocks) {
+            parts.AddPart(NewMessage(region, block.ptr, block.size, block.hint));
+        }
+        return Send(parts, t);
+    }
+
     unsigned long GetBytesTx() const { return fSocket->GetBytesTx(); }
     unsigned long GetBytesRx() const { return fSocket->GetBytesRx(); }
+    unsigned long GetBytesTxUncompressed() const { return fSocket->GetBytesTxUncompressed(); }
+    unsigned long GetBytesRxUncompressed() const { return fSocket->GetBytesRxUncompressed(); }
     unsigned long GetMessagesTx() const { return fSocket->GetMessagesTx(); }
     unsigned long GetMessagesRx() const { return fSocket->GetMessagesRx(); }
+    unsigned long GetMessagesDropped() const { return fSocket->GetMessagesDropped(); }
+
+    /// Traffic shaping statistics of the channel (counted since the channel was initialized)
+    struct ShapingStats
+    {
+        unsigned long delayedSends = 0;         ///< sends that had to wait for the rate limit
+        std::chrono::nanoseconds delay{0};      ///< total time sends waited for the rate limit
+        unsigned long timeouts = 0;             ///< sends that failed, because the wait would exceed the send timeout
+    };
+
+    /// @return true if the channel has a bandwidth or message rate limit
+    bool IsShaped() const { return fShaper != nullptr; }
+    ShapingStats GetShapingStats() const;
 
     auto Transport() -> TransportFactory* { return fTransportFactory.get(); };
 
     template<typename... Args>
     MessagePtr NewMessage(Args&&... args)
     {
-        return Transport()->CreateMessage(std::forward<Args>(args)...);
+        // sized messages are created for this channel (counted against its allocation budget, if the transport has any)
+        if constexpr (IsSizedMessage<std::decay_t<Args>...>::value) {
+            return SizedMessage(std::forward<Args>(args)...);
+        } else {
+            return Transport()->CreateMessage(std::forward<Args>(args)...);
+        }
     }
 
     template<typename T>
@@ -379,6 +544,13 @@ class Channel
     static constexpr int DefaultRateLogging = 1;
     static constexpr int DefaultPortRangeMin = 22000;
     static constexpr int DefaultPortRangeMax = 23000;
+    static constexpr const char* DefaultCompression = "none";
+    static constexpr int DefaultCompressionLevel = 0;
+    static constexpr int DefaultCompressionThreshold = 4096;
+    static constexpr int DefaultCompressionThreads = 1;
+    static constexpr int64_t DefaultMaxBytesPerSec = 0;
+    static constexpr int64_t DefaultMaxMsgsPerSec = 0;
+    static constexpr int DefaultShapingBurstMs = 10;
 #ifdef FAIRMQ_CHANNEL_DEFAULT_AUTOBIND
     static constexpr bool DefaultAutoBind = FAIRMQ_CHANNEL_DEFAULT_AUTOBIND;
 #else
@@ -394,6 +566,19 @@ class Channel
     }
 
   private:
+    // arguments of NewMessage() creating a buffer of a given size: (size) or (size, alignment)
+    template<typename... T>
+    struct IsSizedMessage : std::false_type {};
+    template<typename S>
+    struct IsSizedMessage<S> : std::is_integral<S> {};
+    template<typename S>
+    struct IsSizedMessage<S, Alignment> : std::is_integral<S> {};
+
+    MessagePtr SizedMessage(size_t size, Alignment alignment = Alignment{0})
+    {
+        return Transport()->CreateChannelMessage(fName, size, alignment);
+    }
+
     std::shared_ptr<TransportFactory> fTransportFactory;
     mq::Transport fTransportType;
     std::unique_ptr<Socket> fSocket;
@@ -412,12 +597,51 @@ class Channel
     int fRateLogging;
     int fPortRangeMin;
     int fPortRangeMax;
+    std::string fCompression;
+    int fCompressionLevel;
+    int fCompressionThreshold;
+    int fCompressionThreads;
+    int64_t fMaxBytesPerSec;
+    int64_t fMaxMsgsPerSec;
+    int fShapingBurstMs;
     bool fAutoBind;
 
     bool fValid;
 
     bool fMultipart;
 
+    // token buckets of the bandwidth/message rate limits (created by Init()), shared by all senders of the channel
+    struct Shaper
+    {
+        std::unique_ptr<tools::TokenBucket> fBytes; // nullptr - no bandwidth limit
+        std::unique_ptr<tools::TokenBucket> fMsgs; // nullptr - no message rate limit
+        std::atomic<unsigned long> fDelayedSends{0};
+        std::atomic<int64_t> fDelayNs{0};
+        std::atomic<unsigned long> fTimeouts{0};
+    };
+    std::unique_ptr<Shaper> fShaper;
+
+    /// waits until a message of the given size fits into the limits of the channel
+    /// @param timeoutMs send timeout, reduced by the time waited
+    /// @return 0 - proceed with sending, TransferCode::timeout/interrupted otherwise
+    int64_t Shape(uint64_t bytes, int& timeoutMs);
+    /// gives back the limits reserved by Shape() for a message that has not been sent
+    void Unshape(uint64_t bytes);
+
+    static uint64_t TransferSize(const MessagePtr& msg) { return msg->GetSize(); }
+    static uint64_t TransferSize(const Parts& parts) { return TransferSize(parts.fParts); }
+    static uint64_t TransferSize(const Parts::container& msgVec)
+    {
+        uint64_t size = 0;
+        for (const auto& msg : msgVec) {
+            size += msg->GetSize();
+        }
+        return size;
+    }
+
+    // Wraps a message of a foreign transport into a message of the channel transport.
+    // shmem -> zeromq is zero-copy (zmq_msg_init_data), zeromq -> shmem copies the payload into the managed segment,
+    // since ZeroMQ offers no way to receive into externally provided (shared memory) buffers.
     void CheckSendCompatibility(MessagePtr& msg)
     {
         if (fTransportType != msg->GetType()) {
@@ -9,6 +9,7 @@
 // FairMQ
 #include <fairmq/Device.h>
 #include <fairmq/Tools.h>
+#include <fairmq/tools/Trace.h>
 #include <fairmq/Transports.h>
 
 // boost
@@ -17,6 +18,8 @@
 // std
 #include <algorithm>   // std::max, std::any_of
 #include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <iomanip>
 #include <list>
 #include <memory>   // std::make_unique
@@ -33,7 +36,11 @@ constexpr const char* Device::DefaultTransportName;
 constexpr mq::Transport Device::DefaultTransportType;
 constexpr const char* Device::DefaultNetworkInterface;
 constexpr int Device::DefaultInitTimeout;
+constexpr int Device::DefaultInitThreads;
 constexpr float Device::DefaultRate;
+constexpr const char* Device::DefaultRatePacing;
+constexpr int Device::DefaultRateSpin;
+constexpr int Device::DefaultRateBurst;
 constexpr const char* Device::DefaultSession;
 
 struct StateSubscription
@@ -92,9 +99,11 @@ Device::Device(ProgOptions* config, tools::Version version)
     , fVersion(version)
     , fRate(DefaultRate)
     , fInitializationTimeoutInS(DefaultInitTimeout)
+    , fInitThreads(DefaultInitThreads)
 {
     SubscribeToNewTransition("device", [&](Transition transition) {
         LOG(trace) << "device notified on new transition: " << transition;
+        tools::Trace::Instance().Instant(GetTransitionName(transition), "transition");
         InterruptTransports();
     });
 
@@ -108,6 +117,8 @@ Device::Device(ProgOptions* config, tools::Version version)
 
         fStateQueue.Push(state);
 
+        tools::TraceSpan span(GetStateName(state), "state");
+
         switch (state) {
             case State::InitializingDevice:
                 InitWrapper();
@@ -146,14 +157,31 @@ Device::Device(ProgOptions* config, tools::Version version)
 void Device::InitWrapper()
 {
     // run initialization once CompleteInit transition is requested
-    fStateMachine.WaitForPendingState();
+    {
+        tools::TraceSpan span("wait for CompleteInit", "device");
+        fStateMachine.WaitForPendingState();
+    }
 
     fId = fConfig->GetProperty<string>("id", DefaultId);
 
-    Init();
+    {
+        tools::TraceSpan span("Init", "device");
+        Init();
+    }
+
+    tools::TraceSpan span("channel setup", "device");
+    auto start = chrono::steady_clock::now();
 
     fRate = fConfig->GetProperty<float>("rate", DefaultRate);
+    const string ratePacing = fConfig->GetProperty<string>("rate-pacing", DefaultRatePacing);
+    if (ratePacing != "adaptive" && ratePacing != "precise") {
+        throw runtime_error(tools::ToString("invalid rate-pacing '", ratePacing, "', expected adaptive or precise"));
+    }
+    fRatePacing.precise = (ratePacing == "precise");
+    fRatePacing.spin = chrono::microseconds(max(0, fConfig->GetProperty<int>("rate-spin", DefaultRateSpin)));
+    fRatePacing.burst = static_cast<unsigned int>(max(1, fConfig->GetProperty<int>("rate-burst", DefaultRateBurst)));
     fInitializationTimeoutInS = fConfig->GetProperty<int>("init-timeout", DefaultInitTimeout);
+    fInitThreads = fConfig->GetProperty<int>("init-threads", DefaultInitThreads);
 
     try {
         fDefaultTransportType = TransportTypes.at(fConfig->GetProperty<string>("transport", DefaultTransportName));
@@ -211,21 +239,35 @@ void Device::InitWrapper()
         }
     }
 
+    LOG(debug) << "Channel setup: " << fUninitializedBindingChannels.size() + fUninitializedConnectingChannels.size()
+               << " sub-channels in " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms";
+
     // ChangeStateOrThrow(Transition::Auto);
 }
 
 void Device::BindWrapper()
 {
+    auto start = chrono::steady_clock::now();
+    size_t numChannels = fUninitializedBindingChannels.size();
+
     // Bind channels. Here one run is enough, because bind settings should be available locally
     // If necessary this could be handled in the same way as the connecting channels
-    AttachChannels(fUninitializedBindingChannels);
+    {
+        tools::TraceSpan span("bind channels", "device");
+        AttachChannels(fUninitializedBindingChannels);
+    }
 
     if (!fUninitializedBindingChannels.empty()) {
         LOG(error) << fUninitializedBindingChannels.size() << " of the binding channels could not initialize. Initial configuration incomplete.";
         throw runtime_error(tools::ToString(fUninitializedBindingChannels.size(), " of the binding channels could not initialize. Initial configuration incomplete."));
     }
 
-    Bind();
+    LOG(debug) << "Bind: " << numChannels << " sub-channels in " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms";
+
+    {
+        tools::TraceSpan span("Bind", "device");
+        Bind();
+    }
 
     if (!NewStatePending()) {
         ChangeStateOrThrow(Transition::Auto);
@@ -234,15 +276,44 @@ void Device::BindWrapper()
 
 void Device::ConnectWrapper()
 {
-    // go over the list of channels until all are initialized (and removed from the uninitialized list)
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + chrono::seconds(fInitializationTimeoutInS);
+    size_t numChannels = fUninitializedConnectingChannels.size();
     int numAttempts = 1;
-    auto sleepTimeInMS = 50;
-    auto maxAttempts = fInitializationTimeoutInS * 1000 / sleepTimeInMS;
+
+    // Instead of polling the config at a fixed interval, wait for address updates (e.g. from a control plugin).
+    // Retries without an address update (e.g. for host names that do not resolve yet) back off up to maxRetryInterval.
+    mutex addressMtx;
+    condition_variable addressCV;
+    bool addressUpdated = false;
+    const string subscriber("device-connect");
+    fConfig->SubscribeAsString(subscriber, [&](const string& key, string) {
+        if (key.compare(0, 6, "chans.") == 0 && key.size() > 8 && key.compare(key.size() - 8, 8, ".address") == 0) {
+            {
+                lock_guard<mutex> lock(addressMtx);
+                addressUpdated = true;
+            }
+            addressCV.notify_one();
+        }
+    });
+    tools::CallOnDestruction unsubscribe([&]() { fConfig->UnsubscribeAsString(subscriber); });
+
+    auto retryInterval = chrono::milliseconds(10);
+    const auto maxRetryInterval = chrono::milliseconds(200); // also bounds the reaction time to a pending state
+
     // first attempt
     AttachChannels(fUninitializedConnectingChannels);
     // if not all channels could be connected, update their address values from config and retry
     while (!fUninitializedConnectingChannels.empty() && !NewStatePending()) {
-        this_thread::sleep_for(chrono::milliseconds(sleepTimeInMS));
+        {
+            unique_lock<mutex> lock(addressMtx);
+            if (addressCV.wait_for(lock, retryInterval, [&] { return addressUpdated; })) {
+                retryInterval = chrono::milliseconds(10);
+            } else {
+                retryInterval = min(retryInterval * 2, maxRetryInterval);
+            }
+            addressUpdated = false;
+        }
 
         for (auto& chan : fUninitializedConnectingChannels) {
             string key{"chans." + chan->GetPrefix() + "." + chan->GetIndex() + ".address"};
@@ -252,23 +323,31 @@ void Device::ConnectWrapper()
             }
         }
 
-        if (numAttempts++ > maxAttempts) {
-            LOG(error) << "could not connect all channels after " << fInitializationTimeoutInS << " attempts";
+        if (chrono::steady_clock::now() > deadline) {
+            LOG(error) << "could not connect all channels within " << fInitializationTimeoutInS << " s (" << numAttempts << " attempts)";
             LOG(error) << "following channels are still invalid:";
             for (auto& chan : fUninitializedConnectingChannels) {
                 LOG(error) << "channel: " << *chan;
             }
-            throw runtime_error(tools::ToString("could not connect all channels after ", fInitializationTimeoutInS, " attempts"));
+            throw runtime_error(tools::ToString("could not connect all channels within ", fInitializationTimeoutInS, " s"));
         }
 
+        ++numAttempts;
         AttachChannels(fUninitializedConnectingChannels);
     }
 
+    LOG(debug) << "Connect: " << numChannels - fUninitializedConnectingChannels.size() << " sub-channels in "
+               << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms (" << numAttempts << " attempts)";
+    tools::Trace::Instance().Complete("connect channels", "device", start);
+
     if (GetChannels().empty()) {
         LOG(warn) << "No channels created after finishing initialization";
     }
 
-    Connect();
+    {
+        tools::TraceSpan span("Connect", "device");
+        Connect();
+    }
 
     if (!NewStatePending()) {
         ChangeStateOrThrow(Transition::Auto);
@@ -277,22 +356,63 @@ void Device::ConnectWrapper()
 
 void Device::AttachChannels(vector<Channel*>& chans)
 {
-    auto itr = chans.begin();
-
-    while (itr != chans.end()) {
-        if ((*itr)->Validate()) {
-            (*itr)->Init();
-            if (AttachChannel(**itr)) {
-                // remove the channel from the uninitialized container
-                itr = chans.erase(itr);
-            } else {
-                LOG(error) << "failed to attach channel " << (*itr)->fName << " (" << (*itr)->fMethod << " on " << (*itr)->fAddress << ")";
-                ++itr;
+    // Validation, socket creation, address resolution and bind/connect are independent per channel,
+    // so they are done in parallel. Sockets are handed over to the device thread when the workers are joined.
+    vector<char> attached(chans.size(), 0);
+    atomic<size_t> next(0);
+    exception_ptr error;
+    mutex errorMtx;
+
+    auto attach = [&]() {
+        for (size_t i = next++; i < chans.size(); i = next++) {
+            Channel& chan = *chans[i];
+            try {
+                if (chan.Validate()) {
+                    chan.Init();
+                    if (AttachChannel(chan)) {
+                        attached[i] = 1;
+                    } else {
+                        LOG(error) << "failed to attach channel " << chan.fName << " (" << chan.fMethod << " on " << chan.fAddress << ")";
+                    }
+                }
+            } catch (...) {
+                lock_guard<mutex> lock(errorMtx);
+                if (!error) {
+                    error = current_exception();
+                }
+                next = chans.size();
             }
-        } else {
-            ++itr;
+        }
+    };
+
+    size_t numThreads = (fInitThreads > 0) ? fInitThreads : max(thread::hardware_concurrency(), 1U);
+    numThreads = min(numThreads, chans.size());
+    if (numThreads <= 1) {
+        attach();
+    } else {
+        vector<thread> workers;
+        workers.reserve(numThreads - 1);
+        for (size_t i = 0; i < numThreads - 1; ++i) {
+            workers.emplace_back(attach);
+        }
+        attach();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+
+    // remove the attached channels from the uninitialized container, keeping the order of the rest
+    size_t remaining = 0;
+    for (size_t i = 0; i < chans.size(); ++i) {
+        if (!attached[i]) {
+            chans[remaining++] = chans[i];
         }
     }
+    chans.resize(remaining);
 }
 
 bool Device::AttachChannel(Channel& chan)
@@ -410,7 +530,7 @@ void Device::RunWrapper()
             HandleMultipleChannelInput();
         }
     } else {
-        tools::RateLimiter rateLimiter(fRate);
+        tools::RateLimiter rateLimiter(fRate, fRatePacing);
 
         while (!NewStatePending() && ConditionalRun()) {
             if (fRate > 0.001) {
@@ -512,8 +632,13 @@ void Device::HandleMultipleTransportInput()
 
     fMultitransportProceed = true;
 
+    const tools::ThreadPlacement placement = tools::GetThreadPlacement(fConfig, "device");
+
     for (const auto& i : fMultitransportInputs) {
-        threads.emplace_back(thread(&Device::PollForTransport, this, fTransports.at(i.first).get(), i.second));
+        threads.emplace_back(thread([this, &placement, &i]() {
+            tools::ApplyThreadPlacement("fmq-input-" + TransportName(i.first), placement);
+            PollForTransport(fTransports.at(i.first).get(), i.second);
+        }));
     }
 
     for (thread& t : threads) {
@@ -573,13 +698,23 @@ bool Device::HandleMsgInput(const string& chName, const InputMsgCallback& callba
 
 bool Device::HandleMultipartInput(const string& chName, const InputMultipartCallback& callback, int i)
 {
-    Parts input;
+    // reused across receives of this thread, so that only the transport buffers are allocated per message
+    thread_local Parts input;
+    if (input.Capacity() == 0) {
+        input.Reserve(8);
+    }
+    // release the messages on every exit, also if the callback throws: they must not be kept until the next receive
+    // or until the thread exits (possibly after their transport is gone)
+    struct ClearOnExit
+    {
+        Parts& fParts;
+        ~ClearOnExit() { fParts.Clear(); }
+    } clearOnExit{input};
 
     if (Receive(input, chName, i) >= 0) {
         return callback(input, i);
-    } else {
-        return false;
     }
+    return false;
 }
 
 shared_ptr<TransportFactory> Device::AddTransport(mq::Transport transport)
@@ -611,6 +746,8 @@ void Device::SetConfig(ProgOptions& config)
 
 void Device::LogSocketRates()
 {
+    tools::ApplyThreadPlacement("fmq-ratelog", tools::GetThreadPlacement(fConfig, "housekeeping"));
+
     vector<Channel*> filteredChannels;
     vector<string> filteredChannelNames;
     vector<int> logIntervals;
@@ -636,6 +773,11 @@ void Device::LogSocketRates()
     vector<unsigned long> msgIn(filteredChannels.size());
     vector<unsigned long> bytesOut(filteredChannels.size());
     vector<unsigned long> msgOut(filteredChannels.size());
+    // bytes before compression, only reported for compressing channels
+    vector<unsigned long> bytesInUncompressed(filteredChannels.size());
+    vector<unsigned long> bytesOutUncompressed(filteredChannels.size());
+    // traffic shaping, only reported for shaped channels
+    vector<Channel::ShapingStats> shaping(filteredChannels.size());
 
     vector<unsigned long> bytesInNew(filteredChannels.size());
     vector<unsigned long> msgInNew(filteredChannels.size());
@@ -653,6 +795,9 @@ void Device::LogSocketRates()
         bytesOut.at(i) = channel->GetBytesTx();
         msgIn.at(i) = channel->GetMessagesRx();
         msgOut.at(i) = channel->GetMessagesTx();
+        bytesInUncompressed.at(i) = channel->GetBytesRxUncompressed();
+        bytesOutUncompressed.at(i) = channel->GetBytesTxUncompressed();
+        shaping.at(i) = channel->GetShapingStats();
         ++i;
     }
 
@@ -690,9 +835,31 @@ void Device::LogSocketRates()
                     bytesOut.at(i) = bytesOutNew.at(i);
                     msgOut.at(i) = msgOutNew.at(i);
 
-                    LOG(info) << setw(static_cast<int>(chanNameLen)) << filteredChannelNames.at(i) << ": "
-                              << "in: " << msgPerSecIn.at(i) << " (" << mbPerSecIn.at(i) << " MB) "
-                              << "out: " << msgPerSecOut.at(i) << " (" << mbPerSecOut.at(i) << " MB)";
+                    if (channel->GetCompression() == "none") {
+                        LOG(info) << setw(static_cast<int>(chanNameLen)) << filteredChannelNames.at(i) << ": "
+                                  << "in: " << msgPerSecIn.at(i) << " (" << mbPerSecIn.at(i) << " MB) "
+                                  << "out: " << msgPerSecOut.at(i) << " (" << mbPerSecOut.at(i) << " MB)";
+                    } else {
+                        unsigned long rawIn = channel->GetBytesRxUncompressed();
+                        unsigned long rawOut = channel->GetBytesTxUncompressed();
+                        double mbPerSecRawIn = (static_cast<double>(rawIn - bytesInUncompressed.at(i)) / (1000. * 1000.)) / static_cast<double>(msSinceLastLog) * 1000.;
+                        double mbPerSecRawOut = (static_cast<double>(rawOut - bytesOutUncompressed.at(i)) / (1000. * 1000.)) / static_cast<double>(msSinceLastLog) * 1000.;
+                        bytesInUncompressed.at(i) = rawIn;
+                        bytesOutUncompressed.at(i) = rawOut;
+
+                        LOG(info) << setw(static_cast<int>(chanNameLen)) << filteredChannelNames.at(i) << ": "
+                                  << "in: " << msgPerSecIn.at(i) << " (" << mbPerSecIn.at(i) << " MB, " << mbPerSecRawIn << " MB uncompressed) "
+                                  << "out: " << msgPerSecOut.at(i) << " (" << mbPerSecOut.at(i) << " MB, " << mbPerSecRawOut << " MB uncompressed)";
+                    }
+
+                    if (channel->IsShaped()) {
+                        Channel::ShapingStats stats = channel->GetShapingStats();
+                        LOG(info) << setw(static_cast<int>(chanNameLen)) << filteredChannelNames.at(i) << ": "
+                                  << "shaping: " << (stats.delayedSends - shaping.at(i).delayedSends) << " sends delayed by "
+                                  << chrono::duration<double, milli>(stats.delay - shaping.at(i).delay).count() << " ms, "
+                                  << (stats.timeouts - shaping.at(i).timeouts) << " timed out";
+                        shaping.at(i) = stats;
+                    }
                 }
             }
 
@@ -376,6 +376,9 @@ class Device
 
     const tools::Version GetVersion() const { return fVersion; }
 
+    /// @brief pacing configured via rate-pacing/rate-spin/rate-burst, for rate limited loops of the device
+    tools::RateLimiter::Pacing GetRatePacing() const { return fRatePacing; }
+
     void SetNumIoThreads(int numIoThreads) { fConfig->SetProperty("io-threads", numIoThreads); }
     int GetNumIoThreads() const
     {
@@ -421,7 +424,16 @@ class Device
     void SetRawCmdLineArgs(const std::vector<std::string>& args) { fRawCmdLineArgs = args; }
     std::vector<std::string> GetRawCmdLineArgs() const { return fRawCmdLineArgs; }
 
-    void RunStateMachine() { fStateMachine.ProcessWork(); };
+    void RunStateMachine()
+    {
+        // runs on the thread of the caller (usually the main thread), which is placed but not renamed
+        const tools::ThreadPlacement placement = tools::GetThreadPlacement(fConfig, "device");
+        if (!placement.Empty()) {
+            tools::SetThreadAffinity(placement.cpus);
+            tools::SetThreadScheduling(placement.policy, placement.priority);
+        }
+        fStateMachine.ProcessWork();
+    };
 
     /// Wait for the supplied amount of time or for interruption.
     /// If interrupted, returns false, otherwise true.
@@ -613,7 +625,11 @@ class Device
     static constexpr mq::Transport DefaultTransportType = mq::Transport::ZMQ;
     static constexpr const char* DefaultNetworkInterface = "default";
     static constexpr int DefaultInitTimeout = 120;
+    static constexpr int DefaultInitThreads = 1;
     static constexpr float DefaultRate = 0.;
+    static constexpr const char* DefaultRatePacing = "adaptive";
+    static constexpr int DefaultRateSpin = 0;
+    static constexpr int DefaultRateBurst = 1;
     static constexpr const char* DefaultSession = "default";
 
   private:
@@ -644,7 +660,8 @@ class Device
     /// Shuts down the transports and the device
     void Exit() {}
 
-    /// Attach (bind/connect) channels in the list
+    /// Attach (bind/connect) channels in the list, in parallel on up to fInitThreads threads.
+    /// Attached channels are removed from the list.
     void AttachChannels(std::vector<Channel*>& chans);
     bool AttachChannel(Channel& ch);
 
@@ -673,7 +690,9 @@ class Device
 
     const tools::Version fVersion;
     float fRate;                  ///< Rate limiting for ConditionalRun
+    tools::RateLimiter::Pacing fRatePacing; ///< Pacing of the rate limiting
     int fInitializationTimeoutInS;
+    int fInitThreads;             ///< Number of threads to validate/attach channels with, 1 - serial (default), 0 - number of cores
     std::vector<std::string> fRawCmdLineArgs;
 
     StateQueue fStateQueue;
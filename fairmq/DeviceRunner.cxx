@@ -9,11 +9,13 @@
 #include "DeviceRunner.h"
 
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Trace.h>
 #include <fairmq/tools/Version.h>
 #include <fairmq/Version.h>
 
 #include <fairlogger/Logger.h>
 
+#include <algorithm> // any_of
 #include <exception>
 
 using namespace std;
@@ -76,6 +78,15 @@ bool DeviceRunner::HandleGeneralOptions(const fair::mq::ProgOptions& config, boo
     return true;
 }
 
+void DeviceRunner::WriteTrace(const string& filename)
+{
+    if (tools::Trace::Instance().Write(filename)) {
+        LOG(debug) << "Wrote trace timeline to " << filename;
+    } else {
+        LOG(error) << "Could not write trace timeline to " << filename;
+    }
+}
+
 void DeviceRunner::SubscribeForConfigChange()
 {
     fConfig.Subscribe<bool>("device-runner", [](const std::string& key, const bool val) {
@@ -104,6 +115,17 @@ void DeviceRunner::UnsubscribeFromConfigChange()
 
 auto DeviceRunner::Run() -> int
 {
+    // tracing is disabled by default, start it before the configuration is parsed if a trace file is requested on
+    // the command line, so that plugin loading and option parsing are captured as well
+    const bool traceRequested = any_of(fRawCmdLineArgs.cbegin(), fRawCmdLineArgs.cend(), [](const string& arg) {
+        return arg.rfind("--trace-file", 0) == 0;
+    });
+    if (traceRequested) {
+        tools::Trace::Instance().Enable();
+    }
+
+    auto pluginsBegin = tools::Trace::Clock::now();
+
     fPluginManager.LoadPlugin("s:config");
 
     ////// CALL HOOK ///////
@@ -122,24 +144,39 @@ auto DeviceRunner::Run() -> int
     });
     fConfig.AddToCmdLineOptions(PluginManager::ProgramOptions());
 
+    tools::Trace::Instance().Complete("load plugins", "startup", pluginsBegin);
+
     ////// CALL HOOK ///////
     fEvents.Emit<hooks::ModifyRawCmdLineArgs>(*this);
     ////////////////////////
 
-    fConfig.ParseAll(fRawCmdLineArgs, true);
+    {
+        tools::TraceSpan span("parse options", "startup");
+        fConfig.ParseAll(fRawCmdLineArgs, true);
+    }
 
     if (!HandleGeneralOptions(fConfig, fPrintLogo)) {
         return 0;
     }
 
+    const string traceFile = fConfig.GetProperty<string>("trace-file", "");
+    if (!traceFile.empty()) {
+        tools::Trace::Instance().Enable();
+    } else if (traceRequested) {
+        tools::Trace::Instance().Disable(); // empty --trace-file, drop what was recorded above
+    }
+
     fConfig.Notify();
 
     // handle configuration updates (for general options)
     SubscribeForConfigChange();
 
-    ////// CALL HOOK ///////
-    fEvents.Emit<hooks::InstantiateDevice>(*this);
-    ////////////////////////
+    {
+        tools::TraceSpan span("instantiate device", "startup");
+        ////// CALL HOOK ///////
+        fEvents.Emit<hooks::InstantiateDevice>(*this);
+        ////////////////////////
+    }
 
     if (!fDevice) {
         LOG(error) << "getDevice(): no valid device provided. Exiting.";
@@ -178,9 +215,23 @@ auto DeviceRunner::Run() -> int
     // Log IDLE configuration
     fConfig.PrintOptions();
 
+    // Write the startup timeline once the device is running (and the complete one at exit)
+    if (!traceFile.empty()) {
+        fDevice->SubscribeToStateChange("trace", [traceFile](State state) {
+            if (state == State::Running) {
+                WriteTrace(traceFile);
+            }
+        });
+    }
+
     // Run the device
     fDevice->RunStateMachine();
 
+    if (!traceFile.empty()) {
+        fDevice->UnsubscribeFromStateChange("trace");
+        WriteTrace(traceFile);
+    }
+
     // Wait for control plugin to release device control
     fPluginManager.WaitForPluginsToReleaseDeviceControl();
 
@@ -60,6 +60,9 @@ class DeviceRunner
     void SubscribeForConfigChange();
     void UnsubscribeFromConfigChange();
 
+    /// @brief write the process trace timeline (see fair::mq::tools::Trace) to the given file
+    static void WriteTrace(const std::string& filename);
+
     template<typename H>
     auto AddHook(std::function<void(DeviceRunner&)> hook) -> void
     {
@@ -9,17 +9,19 @@
 #ifndef FAIR_MQ_EVENTMANAGER_H
 #define FAIR_MQ_EVENTMANAGER_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <typeindex>
-#include <unordered_map>
 #include <utility>
 #include <functional>
-
-#include <boost/any.hpp>
-#include <boost/functional/hash.hpp>
-#include <boost/signals2.hpp>
+#include <vector>
 
 namespace fair::mq
 {
@@ -44,7 +46,10 @@ struct Event
  *
  * Events can be emitted based on event type and callback signature.
  *
- * The event manager is thread-safe.
+ * The event manager is thread-safe. Emitting is lock-free: subscriber lists are immutable
+ * snapshots, replaced (copy-on-write) by Subscribe/Unsubscribe. Unsubscribe waits for the emissions
+ * that may still call the removed callback to finish, unless it is called from a callback of this
+ * event manager on the same thread (the removed callback may then still be called by emissions in flight).
  */
 class EventManager
 {
@@ -54,84 +59,227 @@ class EventManager
     // template<typename E, typename ...Args>
     // using Callback = std::function<void(typename E::KeyType, Args...)>;
 
-    template<typename E, typename ...Args>
-    using Signal = boost::signals2::signal<void(typename E::KeyType, Args...)>;
+    EventManager() = default;
+    EventManager(const EventManager&) = delete;
+    EventManager(EventManager&&) = delete;
+    EventManager& operator=(const EventManager&) = delete;
+    EventManager& operator=(EventManager&&) = delete;
+    ~EventManager() = default;
 
     template<typename E, typename ...Args>
     auto Subscribe(const std::string& subscriber, std::function<void(typename E::KeyType, Args...)> callback) -> void
     {
-        const std::type_index event_type_index{typeid(E)};
-        const std::type_index callback_type_index{typeid(std::function<void(typename E::KeyType, Args...)>)};
-        const auto signalsKey = std::make_pair(event_type_index, callback_type_index);
-        const auto connectionsKey = std::make_pair(subscriber, signalsKey);
+        std::lock_guard<std::mutex> lock{fMutex};
 
-        const auto connection = GetSignal<E, Args...>(signalsKey)->connect(callback);
+        auto& slots = GetSlots<E, Args...>();
+        auto current = slots.fSubscribers.load();
+        auto subscribers = current ? std::make_shared<Subscribers<E, Args...>>(*current) : std::make_shared<Subscribers<E, Args...>>();
+        // double subscription replaces the previous callback
+        subscribers->erase(std::remove_if(subscribers->begin(), subscribers->end(), [&](const auto& s) { return s.first == subscriber; }), subscribers->end());
+        subscribers->emplace_back(subscriber, std::move(callback));
+        Publish(slots, std::move(subscribers));
+    }
 
+    /// @brief remove the callback of the subscriber for the event and callback signature
+    /// @throws std::out_of_range if there is no such subscription
+    ///
+    /// Blocks until the emissions that may still call the removed callback (on other threads) have
+    /// returned, so that the callback and what it captures can be destroyed afterwards. Warning: do not
+    /// call it while holding a lock that a callback of this event manager takes, this deadlocks.
+    /// Called from within a callback of this event manager it does not wait (see class description).
+    template<typename E, typename ...Args>
+    auto Unsubscribe(const std::string& subscriber) -> void
+    {
+        uint64_t retiredEpoch = 0;
         {
             std::lock_guard<std::mutex> lock{fMutex};
 
-            if (fConnections.find(connectionsKey) != fConnections.end())
-            {
-                fConnections.at(connectionsKey).disconnect();
-                fConnections.erase(connectionsKey);
+            auto slots = FindSlots<E, Args...>(fSlotsMap.load());
+            auto current = slots ? slots->fSubscribers.load() : nullptr;
+            auto found = [&](const auto& s) { return s.first == subscriber; };
+            if (!current || std::none_of(current->cbegin(), current->cend(), found)) {
+                throw std::out_of_range("EventManager::Unsubscribe: no subscription of '" + subscriber + "' for this event and callback signature");
             }
-            fConnections.insert({connectionsKey, connection});
+            auto subscribers = std::make_shared<Subscribers<E, Args...>>(*current);
+            subscribers->erase(std::remove_if(subscribers->begin(), subscribers->end(), found), subscribers->end());
+            retiredEpoch = fEpoch.load();
+            Publish(*slots, std::move(subscribers));
+        }
+
+        // an emission of this thread would wait for itself
+        const auto& emitting = Emitting();
+        if (std::find(emitting.cbegin(), emitting.cend(), this) == emitting.cend()) {
+            WaitForReclaim(retiredEpoch);
         }
     }
 
     template<typename E, typename ...Args>
-    auto Unsubscribe(const std::string& subscriber) -> void
+    auto Emit(typename E::KeyType key, Args... args) const -> void
     {
-        const std::type_index event_type_index{typeid(E)};
-        const std::type_index callback_type_index{typeid(std::function<void(typename E::KeyType, Args...)>)};
-        const auto signalsKey = std::make_pair(event_type_index, callback_type_index);
-        const auto connectionsKey = std::make_pair(subscriber, signalsKey);
+        EmitGuard guard(*this);
 
-        std::lock_guard<std::mutex> lock{fMutex};
-
-        fConnections.at(connectionsKey).disconnect();
-        fConnections.erase(connectionsKey);
+        auto slots = FindSlots<E, Args...>(fSlotsMap.load());
+        if (auto subscribers = slots ? slots->fSubscribers.load() : nullptr) {
+            for (const auto& subscriber : *subscribers) {
+                subscriber.second(key, args...);
+            }
+        }
     }
 
+    /// @brief check if any callback is subscribed, e.g. to skip preparing the arguments of an Emit
     template<typename E, typename ...Args>
-    auto Emit(typename E::KeyType key, Args... args) const -> void
+    auto HasSubscribers() const -> bool
     {
-        const std::type_index event_type_index{typeid(E)};
-        const std::type_index callback_type_index{typeid(std::function<void(typename E::KeyType, Args...)>)};
-        const auto signalsKey = std::make_pair(event_type_index, callback_type_index);
+        EmitGuard guard(*this);
 
-        (*GetSignal<E, Args...>(signalsKey))(key, std::forward<Args>(args)...);
+        auto slots = FindSlots<E, Args...>(fSlotsMap.load());
+        auto subscribers = slots ? slots->fSubscribers.load() : nullptr;
+        return subscribers && !subscribers->empty();
     }
 
   private:
-    using SignalsKey   = std::pair<std::type_index, std::type_index>;
-                                // event          , callback
-    using SignalsValue = boost::any;
-    using SignalsMap   = std::unordered_map<SignalsKey, SignalsValue, boost::hash<SignalsKey>>;
-    mutable SignalsMap fSignals;
-
-    using ConnectionsKey   = std::pair<std::string, SignalsKey>;
-                                    // subscriber , event/callback
-    using ConnectionsValue = boost::signals2::connection;
-    using ConnectionsMap   = std::unordered_map<ConnectionsKey, ConnectionsValue, boost::hash<ConnectionsKey>>;
-    ConnectionsMap fConnections;
+    using SlotsKey = std::pair<std::type_index, std::type_index>;
+                            // event          , callback
+    template<typename E, typename ...Args>
+    using Subscribers = std::vector<std::pair<std::string, std::function<void(typename E::KeyType, Args...)>>>;
 
-    mutable std::mutex fMutex;
+    struct SlotsBase
+    {
+        virtual ~SlotsBase() = default;
+    };
 
+    // subscribers of one event/callback signature, fSubscribers points to the snapshot held by fOwner
     template<typename E, typename ...Args>
-    auto GetSignal(const SignalsKey& key) const -> std::shared_ptr<Signal<E, Args...>>
+    struct Slots : SlotsBase
     {
-        std::lock_guard<std::mutex> lock{fMutex};
+        std::atomic<const Subscribers<E, Args...>*> fSubscribers{nullptr};
+        std::shared_ptr<const Subscribers<E, Args...>> fOwner;
+    };
+
+    using SlotsMap = std::vector<std::pair<SlotsKey, std::shared_ptr<SlotsBase>>>; // few entries, linear search
 
-        if (fSignals.find(key) == fSignals.end())
+    // Snapshots (of fSlotsMap and of the subscriber lists) are only written under fMutex. Replaced
+    // snapshots are retired with the current epoch and freed two epochs later (epoch based reclamation):
+    // an emission increments the counter of the epoch it observed before loading a snapshot, the epoch
+    // only advances from e to e + 1 once the emissions counted for e - 1 (same counter as e + 1) have
+    // finished. So at epoch e + 2 no emission can still be reading a snapshot retired at epoch e
+    // (sequentially consistent ordering), and continuous emissions do not hold back the reclamation.
+    std::atomic<const SlotsMap*> fSlotsMap{nullptr};
+    std::shared_ptr<const SlotsMap> fSlotsMapOwner;
+    std::vector<std::pair<uint64_t, std::shared_ptr<const void>>> fRetired; // epoch of retirement, snapshot
+    std::atomic<uint64_t> fEpoch{0};
+    mutable std::array<std::atomic<int>, 2> fEmitters{}; // emissions in flight, by epoch parity
+    std::mutex fMutex;
+
+    struct EmitGuard
+    {
+        explicit EmitGuard(const EventManager& manager)
+            : fEmitters(manager.fEmitters[manager.fEpoch.load() & 1])
         {
-            // wrapper is needed because boost::signals2::signal is neither copyable nor movable
-            // and I don't know how else to insert it into the map
-            auto signal = std::make_shared<Signal<E, Args...>>();
-            fSignals.insert(std::make_pair(key, signal));
+            fEmitters.fetch_add(1);
+            Emitting().push_back(&manager);
+        }
+        EmitGuard(const EmitGuard&) = delete;
+        EmitGuard& operator=(const EmitGuard&) = delete;
+        ~EmitGuard()
+        {
+            Emitting().pop_back();
+            fEmitters.fetch_sub(1);
+        }
+        std::atomic<int>& fEmitters;
+    };
+
+    // event managers the calling thread is currently emitting on
+    static auto Emitting() -> std::vector<const EventManager*>&
+    {
+        thread_local std::vector<const EventManager*> emitting;
+        return emitting;
+    }
+
+    template<typename E, typename ...Args>
+    static auto Key() -> SlotsKey
+    {
+        return {std::type_index{typeid(E)}, std::type_index{typeid(std::function<void(typename E::KeyType, Args...)>)}};
+    }
+
+    template<typename E, typename ...Args>
+    static auto FindSlots(const SlotsMap* map) -> Slots<E, Args...>*
+    {
+        if (map) {
+            const auto key = Key<E, Args...>();
+            for (const auto& entry : *map) {
+                if (entry.first == key) {
+                    return static_cast<Slots<E, Args...>*>(entry.second.get());
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    // must be called under locked fMutex
+    template<typename E, typename ...Args>
+    auto GetSlots() -> Slots<E, Args...>&
+    {
+        if (auto slots = FindSlots<E, Args...>(fSlotsMap.load())) {
+            return *slots;
         }
+        auto slots = std::make_shared<Slots<E, Args...>>();
+        auto map = fSlotsMapOwner ? std::make_shared<SlotsMap>(*fSlotsMapOwner) : std::make_shared<SlotsMap>();
+        map->emplace_back(Key<E, Args...>(), slots);
+        fSlotsMap.store(map.get());
+        if (fSlotsMapOwner) {
+            Retire(std::move(fSlotsMapOwner));
+        }
+        fSlotsMapOwner = std::move(map);
+        return *slots;
+    }
 
-        return boost::any_cast<std::shared_ptr<Signal<E, Args...>>>(fSignals.at(key));
+    // must be called under locked fMutex
+    template<typename E, typename ...Args>
+    auto Publish(Slots<E, Args...>& slots, std::shared_ptr<Subscribers<E, Args...>> subscribers) -> void
+    {
+        slots.fSubscribers.store(subscribers.get());
+        if (slots.fOwner) {
+            Retire(std::move(slots.fOwner));
+        }
+        slots.fOwner = std::move(subscribers);
+        Reclaim();
+    }
+
+    // must be called under locked fMutex
+    auto Retire(std::shared_ptr<const void> snapshot) -> void
+    {
+        fRetired.emplace_back(fEpoch.load(), std::move(snapshot));
+    }
+
+    // must be called under locked fMutex, advances the epoch as far as the emissions in flight allow and
+    // frees the snapshots retired at least two epochs ago
+    auto Reclaim() -> uint64_t
+    {
+        for (int i = 0; i < 2; ++i) {
+            const uint64_t epoch = fEpoch.load();
+            if (fEmitters[(epoch + 1) & 1].load() != 0) {
+                break;
+            }
+            fEpoch.store(epoch + 1);
+        }
+        const uint64_t epoch = fEpoch.load();
+        fRetired.erase(std::remove_if(fRetired.begin(), fRetired.end(), [&](const auto& r) { return r.first + 2 <= epoch; }), fRetired.end());
+        return epoch;
+    }
+
+    // wait until the snapshots retired at the given epoch are freed (no emission can still be reading them)
+    auto WaitForReclaim(uint64_t retiredEpoch) -> void
+    {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock{fMutex};
+                if (Reclaim() >= retiredEpoch + 2) {
+                    return;
+                }
+            }
+            std::this_thread::yield();
+        }
     }
 }; /* class EventManager */
 
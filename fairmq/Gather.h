@@ -0,0 +1,134 @@
+/********************************************************************************
+ * Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH       *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_GATHER_H
+#define FAIR_MQ_GATHER_H
+
+#include <fairmq/Message.h>
+#include <fairmq/TransportFactory.h>
+
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <cstring>   // std::memcpy
+#include <stdexcept>
+#include <vector>
+
+namespace fair::mq {
+
+/// a contiguous piece of memory to be gathered into (or viewed in) a gather message
+struct GatherBuffer
+{
+    const void* data;
+    size_t size;
+};
+
+/// Gather message layout (all integers in host byte order, the receiver is expected to share it):
+/// | n (uint64_t) | end offset of segment 0 ... end offset of segment n-1 (uint64_t each) | segment data, packed |
+/// The segment data is packed without padding, segments do not keep any alignment beyond the one of their offset.
+namespace gather {
+
+inline size_t HeaderSize(size_t count) { return (count + 1) * sizeof(uint64_t); }
+
+/// @brief copy the given buffers into a single message of the given transport (one allocation)
+inline MessagePtr Pack(TransportFactory& factory, const GatherBuffer* buffers, size_t count)
+{
+    size_t payload = 0;
+    for (size_t i = 0; i < count; ++i) {
+        payload += buffers[i].size;
+    }
+    const size_t headerSize = HeaderSize(count);
+    MessagePtr msg = factory.CreateMessage(headerSize + payload, Alignment{alignof(uint64_t)});
+
+    auto header = static_cast<uint64_t*>(msg->GetData());
+    char* out = static_cast<char*>(msg->GetData()) + headerSize;
+    header[0] = count;
+    uint64_t end = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(out + end, buffers[i].data, buffers[i].size);
+        end += buffers[i].size;
+        header[i + 1] = end;
+    }
+    return msg;
+}
+
+} // namespace gather
+
+/// fair::mq::GatherView exposes the segments of a message sent with Channel::SendGather() without copying.
+/// The view does not own the message, it must outlive the view.
+class GatherView
+{
+  public:
+    /// @throws std::runtime_error if the message is not a valid gather message (checks the segment count and
+    /// that the end offsets are ascending and within the message)
+    explicit GatherView(const Message& msg)
+    {
+        const size_t size = msg.GetSize();
+        const auto data = static_cast<const char*>(msg.GetData());
+        if (size < sizeof(uint64_t)) {
+            throw std::runtime_error("GatherView: message too small for a gather header");
+        }
+        uint64_t count = 0;
+        std::memcpy(&count, data, sizeof(uint64_t));
+        if (count > (size / sizeof(uint64_t)) - 1) {
+            throw std::runtime_error("GatherView: invalid segment count");
+        }
+        fCount = count;
+        fEnds = data + sizeof(uint64_t);
+        fData = data + gather::HeaderSize(fCount);
+        const uint64_t payload = size - gather::HeaderSize(fCount);
+        uint64_t previous = 0;
+        for (size_t i = 0; i < fCount; ++i) {
+            const uint64_t end = End(i);
+            if (end < previous) {
+                throw std::runtime_error("GatherView: segment end offsets are not ascending");
+            }
+            previous = end;
+        }
+        if (previous > payload) {
+            throw std::runtime_error("GatherView: segments exceed the message size");
+        }
+    }
+
+    /// @brief number of segments
+    size_t Size() const { return fCount; }
+    bool Empty() const { return fCount == 0; }
+
+    /// @brief segment at the given index (unchecked)
+    GatherBuffer operator[](size_t index) const
+    {
+        const uint64_t begin = (index == 0) ? 0 : End(index - 1);
+        return GatherBuffer{fData + begin, static_cast<size_t>(End(index) - begin)};
+    }
+
+    /// @brief segment at the given index
+    /// @throws std::out_of_range if index >= Size()
+    GatherBuffer At(size_t index) const
+    {
+        if (index >= fCount) {
+            throw std::out_of_range("GatherView: segment index out of range");
+        }
+        return (*this)[index];
+    }
+
+  private:
+    // the message data need not be aligned for uint64_t (e.g. a received zeromq frame)
+    uint64_t End(size_t index) const
+    {
+        uint64_t end = 0;
+        std::memcpy(&end, fEnds + index * sizeof(uint64_t), sizeof(uint64_t));
+        return end;
+    }
+
+    size_t fCount = 0;
+    const char* fEnds = nullptr; // end offsets of the segments, uint64_t each
+    const char* fData = nullptr;
+};
+
+}   // namespace fair::mq
+
+#endif /* FAIR_MQ_GATHER_H */
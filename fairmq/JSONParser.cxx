@@ -26,6 +26,7 @@
 #include <fairmq/JSONParser.h>
 #include <fairmq/PropertyOutput.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Trace.h>
 #include <iomanip>
 
 using namespace std;
@@ -49,6 +50,7 @@ Properties PtreeParser(const ptree& pt, const string& id)
 
 Properties JSONParser(const string& filename, const string& deviceId)
 {
+    TraceSpan span("JSONParser", "startup");
     ptree pt;
     LOG(debug) << "Parsing JSON from " << filename << " ...";
     read_json(filename, pt);
@@ -102,6 +104,13 @@ void ChannelParser(const ptree& tree, Properties& properties)
                 commonProperties.emplace("rateLogging", cn.second.get<int>("rateLogging", Channel::DefaultRateLogging));
                 commonProperties.emplace("portRangeMin", cn.second.get<int>("portRangeMin", Channel::DefaultPortRangeMin));
                 commonProperties.emplace("portRangeMax", cn.second.get<int>("portRangeMax", Channel::DefaultPortRangeMax));
+                commonProperties.emplace("compression", cn.second.get<string>("compression", Channel::DefaultCompression));
+                commonProperties.emplace("compressionLevel", cn.second.get<int>("compressionLevel", Channel::DefaultCompressionLevel));
+                commonProperties.emplace("compressionThreshold", cn.second.get<int>("compressionThreshold", Channel::DefaultCompressionThreshold));
+                commonProperties.emplace("compressionThreads", cn.second.get<int>("compressionThreads", Channel::DefaultCompressionThreads));
+                commonProperties.emplace("maxBytesPerSec", cn.second.get<int64_t>("maxBytesPerSec", Channel::DefaultMaxBytesPerSec));
+                commonProperties.emplace("maxMsgsPerSec", cn.second.get<int64_t>("maxMsgsPerSec", Channel::DefaultMaxMsgsPerSec));
+                commonProperties.emplace("shapingBurstMs", cn.second.get<int>("shapingBurstMs", Channel::DefaultShapingBurstMs));
                 commonProperties.emplace("autoBind", cn.second.get<bool>("autoBind", Channel::DefaultAutoBind));
 
                 string name = cn.second.get<string>("name");
@@ -154,6 +163,13 @@ void SubChannelParser(const ptree& channelTree, Properties& properties, const st
                 newProperties["rateLogging"] = sn.second.get<int>("rateLogging", boost::any_cast<int>(commonProperties.at("rateLogging")));
                 newProperties["portRangeMin"] = sn.second.get<int>("portRangeMin", boost::any_cast<int>(commonProperties.at("portRangeMin")));
                 newProperties["portRangeMax"] = sn.second.get<int>("portRangeMax", boost::any_cast<int>(commonProperties.at("portRangeMax")));
+                newProperties["compression"] = sn.second.get<string>("compression", boost::any_cast<string>(commonProperties.at("compression")));
+                newProperties["compressionLevel"] = sn.second.get<int>("compressionLevel", boost::any_cast<int>(commonProperties.at("compressionLevel")));
+                newProperties["compressionThreshold"] = sn.second.get<int>("compressionThreshold", boost::any_cast<int>(commonProperties.at("compressionThreshold")));
+                newProperties["compressionThreads"] = sn.second.get<int>("compressionThreads", boost::any_cast<int>(commonProperties.at("compressionThreads")));
+                newProperties["maxBytesPerSec"] = sn.second.get<int64_t>("maxBytesPerSec", boost::any_cast<int64_t>(commonProperties.at("maxBytesPerSec")));
+                newProperties["maxMsgsPerSec"] = sn.second.get<int64_t>("maxMsgsPerSec", boost::any_cast<int64_t>(commonProperties.at("maxMsgsPerSec")));
+                newProperties["shapingBurstMs"] = sn.second.get<int>("shapingBurstMs", boost::any_cast<int>(commonProperties.at("shapingBurstMs")));
                 newProperties["autoBind"] = sn.second.get<bool>("autoBind", boost::any_cast<bool>(commonProperties.at("autoBind")));
 
                 LOG(trace) << "" << channelName << "[" << i << "]:";
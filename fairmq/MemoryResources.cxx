@@ -15,7 +15,65 @@
 #include <fairmq/TransportFactory.h>
 #include <fairmq/MemoryResources.h>
 
+#include <algorithm>   // std::max
+#include <cstdint>     // std::uintptr_t
+#include <cstring>     // std::memcpy
+#include <new>         // std::bad_alloc
+
 void *fair::mq::ChannelResource::do_allocate(std::size_t bytes, std::size_t alignment)
 {
     return setMessage(factory->CreateMessage(bytes, fair::mq::Alignment{alignment}));
 }
+
+void* fair::mq::ArenaResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    alignment = std::max(alignment, std::size_t{1});
+    if (!fChunks.empty()) {
+        Chunk& chunk = fChunks.back();
+        auto base = reinterpret_cast<std::uintptr_t>(chunk.msg->GetData());
+        std::size_t offset = ((base + chunk.used + alignment - 1) & ~(alignment - 1)) - base;
+        if (offset + bytes <= chunk.msg->GetSize()) {
+            chunk.used = offset + bytes;
+            return reinterpret_cast<void*>(base + offset);
+        }
+    }
+
+    // start a new chunk, aligned to the requested alignment
+    MessagePtr msg(factory->CreateMessage(std::max(fChunkSize, bytes), fair::mq::Alignment{alignment}));
+    if (bytes > 0 && !msg->GetData()) {
+        throw std::bad_alloc();
+    }
+    void* addr = msg->GetData();
+    fChunks.push_back({std::move(msg), bytes});
+    return addr;
+}
+
+fair::mq::MessagePtr fair::mq::ArenaResource::finalize()
+{
+    if (fChunks.size() == 1) {
+        MessagePtr msg(std::move(fChunks.front().msg));
+        msg->SetUsedSize(fChunks.front().used);
+        fChunks.clear();
+        return msg;
+    }
+
+    MessagePtr msg(factory->CreateMessage(getUsedSize()));
+    auto out = static_cast<char*>(msg->GetData());
+    for (const auto& chunk : fChunks) {
+        std::memcpy(out, chunk.msg->GetData(), chunk.used);
+        out += chunk.used;
+    }
+    fChunks.clear();
+    return msg;
+}
+
+fair::mq::Parts fair::mq::ArenaResource::finalizeParts()
+{
+    Parts parts;
+    for (auto& chunk : fChunks) {
+        chunk.msg->SetUsedSize(chunk.used);
+        parts.AddPart(std::move(chunk.msg));
+    }
+    fChunks.clear();
+    return parts;
+}
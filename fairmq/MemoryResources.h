@@ -20,8 +20,10 @@
 #include <boost/container/pmr/memory_resource.hpp>
 #include <cstring>
 #include <fairmq/Message.h>
+#include <fairmq/Parts.h>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace fair::mq {
 
@@ -103,6 +105,82 @@ class ChannelResource : public MemoryResource
     };
 };
 
+/// Monotonic (bump pointer) resource carving allocations out of large transport messages ("chunks").
+/// Building many small objects costs one transport allocation per chunk instead of one per object.
+/// Deallocation is a no-op, memory is reclaimed when the chunks are finalized or the resource is destroyed.
+/// The used ranges of the chunks are handed out with finalize() (single message) or finalizeParts().
+class ArenaResource : public MemoryResource
+{
+  public:
+    ArenaResource() = delete;
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    /// @param factory transport to allocate the chunks with
+    /// @param chunkSize size of the chunks (larger allocations get a chunk of their own size)
+    ArenaResource(TransportFactory* _factory, size_t chunkSize = 1 << 20)
+        : factory(_factory)
+        , fChunkSize(chunkSize)
+    {
+        if (!_factory) {
+            throw std::runtime_error("Tried to construct from a nullptr fair::mq::TransportFactory");
+        }
+    }
+
+    /// arena allocations do not map to individual messages, containers are copied by getMessage(container)
+    MessagePtr getMessage(void* /*p*/) override { return nullptr; }
+    /// adopt the message as a (fully used) chunk
+    void* setMessage(MessagePtr message) override
+    {
+        void* addr = message->GetData();
+        fChunks.push_back({std::move(message), 0});
+        fChunks.back().used = fChunks.back().msg->GetSize();
+        return addr;
+    }
+
+    TransportFactory* getTransportFactory() noexcept override { return factory; }
+
+    size_t getNumberOfMessages() const noexcept override { return fChunks.size(); }
+
+    /// @brief number of bytes in use, including alignment padding
+    size_t getUsedSize() const noexcept
+    {
+        size_t used = 0;
+        for (const auto& c : fChunks) {
+            used += c.used;
+        }
+        return used;
+    }
+
+    /// @brief hand out the used range of all chunks as one message and reset the arena.
+    /// With more than one chunk, the used ranges are copied into a single message (pointers into the arena are not preserved).
+    MessagePtr finalize();
+
+    /// @brief hand out the used range of every chunk as a message part (zero-copy) and reset the arena
+    Parts finalizeParts();
+
+  protected:
+    TransportFactory* factory{nullptr};
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override {}
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    };
+
+  private:
+    struct Chunk
+    {
+        MessagePtr msg;
+        size_t used;
+    };
+
+    size_t fChunkSize;
+    std::vector<Chunk> fChunks;
+};
+
 using FairMQMemoryResource [[deprecated("Use fair::mq::MemoryResource")]] = MemoryResource;
 
 }   // namespace fair::mq
@@ -48,6 +48,16 @@ struct Message
 
     virtual bool SetUsedSize(size_t size, Alignment alignment = Alignment{0}) = 0;
 
+    /// Resize the message buffer, keeping its content (up to the smaller of the old and new size).
+    /// Shrinking is equivalent to SetUsedSize(). Growing is done in place where the transport allows it,
+    /// otherwise the content is copied to a new buffer, so GetData() has to be called again after a successful call.
+    /// @param size new size of the buffer
+    /// @param alignment alignment of the buffer, if it has to be reallocated (0 keeps the current alignment)
+    /// The default implementation does not support resizing and always returns false, so that
+    /// transports implemented outside of FairMQ keep compiling.
+    /// @return true on success, false otherwise (the message is unchanged)
+    virtual bool Resize(size_t /* size */, Alignment /* alignment */ = Alignment{0}) { return false; }
+
     virtual Transport GetType() const = 0;
     TransportFactory* GetTransport() { return fTransport; }
     void SetTransport(TransportFactory* transport) { fTransport = transport; }
@@ -0,0 +1,104 @@
+/********************************************************************************
+ * Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH       *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_MESSAGEBUILDER_H
+#define FAIR_MQ_MESSAGEBUILDER_H
+
+#include <fairmq/Message.h>
+#include <fairmq/TransportFactory.h>
+
+#include <algorithm>   // std::max
+#include <cstddef>     // size_t
+#include <cstring>     // std::memcpy
+#include <string>      // std::to_string
+#include <utility>     // std::move
+
+namespace fair::mq {
+
+/// fair::mq::MessageBuilder streams variable-size output into a message of the given transport,
+/// growing it with Message::Resize() (in place where possible, for shmem in the managed segment) instead of
+/// allocating the worst case size up front.
+///
+/// @code
+/// MessageBuilder builder(*factory, 4096);
+/// builder.Append(header, sizeof(header));
+/// char* out = builder.Reserve(maxChunkSize);
+/// builder.Commit(Encode(out, maxChunkSize));
+/// channel.Send(builder.Finalize());
+/// @endcode
+class MessageBuilder
+{
+  public:
+    /// @param factory transport to create the message with
+    /// @param initialCapacity initial buffer size
+    /// @param alignment alignment of the buffer
+    MessageBuilder(TransportFactory& factory, size_t initialCapacity, Alignment alignment = Alignment{0})
+        : fMsg(factory.CreateMessage(initialCapacity, alignment))
+        , fAlignment(alignment)
+    {}
+
+    /// @param msg message to build into, its current size is the initial capacity, its content is overwritten
+    explicit MessageBuilder(MessagePtr msg, Alignment alignment = Alignment{0})
+        : fMsg(std::move(msg))
+        , fAlignment(alignment)
+    {}
+
+    MessageBuilder(const MessageBuilder&) = delete;
+    MessageBuilder& operator=(const MessageBuilder&) = delete;
+    MessageBuilder(MessageBuilder&&) = default;
+    MessageBuilder& operator=(MessageBuilder&&) = default;
+    ~MessageBuilder() = default;
+
+    /// @brief number of bytes written so far
+    size_t GetSize() const { return fSize; }
+    /// @brief current buffer size
+    size_t GetCapacity() const { return fMsg->GetSize(); }
+    /// @brief pointer to the written data, invalidated by any call that grows the buffer
+    char* GetData() const { return static_cast<char*>(fMsg->GetData()); }
+
+    /// @brief append size bytes, growing the buffer if necessary
+    void Append(const void* data, size_t size)
+    {
+        std::memcpy(Reserve(size), data, size);
+        fSize += size;
+    }
+
+    /// @brief make room for at least size more bytes, to be written directly and then confirmed with Commit()
+    /// @return pointer to the first free byte, valid until the buffer grows
+    char* Reserve(size_t size)
+    {
+        if (fSize + size > GetCapacity()) {
+            // grow geometrically to keep the number of reallocations logarithmic
+            size_t newCapacity = std::max(fSize + size, GetCapacity() * 2);
+            if (!fMsg->Resize(newCapacity, fAlignment)) {
+                throw MessageBadAlloc("MessageBuilder: could not grow message to " + std::to_string(newCapacity) + " bytes");
+            }
+        }
+        return GetData() + fSize;
+    }
+
+    /// @brief confirm size bytes written to the memory returned by Reserve()
+    void Commit(size_t size) { fSize += size; }
+
+    /// @brief finish building, the returned message has exactly the written size
+    MessagePtr Finalize()
+    {
+        fMsg->SetUsedSize(fSize);
+        fSize = 0;
+        return std::move(fMsg);
+    }
+
+  private:
+    MessagePtr fMsg;
+    size_t fSize = 0;
+    Alignment fAlignment;
+};
+
+}   // namespace fair::mq
+
+#endif   // FAIR_MQ_MESSAGEBUILDER_H
@@ -19,6 +19,9 @@ namespace fair::mq {
 
 /// fair::mq::Parts is a lightweight move-only convenience wrapper around a vector of unique pointers to
 /// Message, used for sending multi-part messages
+///
+/// Clear() keeps the allocated capacity, so a Parts object that is reused for subsequent receives
+/// (as done by the OnData multipart callbacks) does not reallocate its storage per message.
 struct Parts
 {
     using container = std::vector<MessagePtr>;
@@ -55,7 +58,7 @@ struct Parts
 
     void AddPart(Parts parts)
     {
-        if (fParts.empty()) {
+        if (fParts.empty() && fParts.capacity() < parts.Size()) {
             fParts = std::move(parts.fParts);
         } else {
             fParts.reserve(parts.Size() + fParts.size());
@@ -77,7 +80,11 @@ struct Parts
 
     size_type Size() const noexcept { return fParts.size(); }
     bool Empty() const noexcept { return fParts.empty(); }
+    /// destroys all parts, keeps the capacity
     void Clear() noexcept { fParts.clear(); }
+    /// preallocate storage for the given number of parts
+    void Reserve(size_type capacity) { fParts.reserve(capacity); }
+    size_type Capacity() const noexcept { return fParts.capacity(); }
 
     // range access
     iterator begin() noexcept { return fParts.begin(); }
@@ -12,6 +12,7 @@
 #include <fairmq/PluginManager.h>
 #include <fairmq/plugins/Builtin.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Trace.h>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -137,6 +138,8 @@ auto fair::mq::PluginManager::ProgramOptions() -> po::options_description
 
 auto fair::mq::PluginManager::LoadPlugin(const string& pluginName) -> void
 {
+    tools::TraceSpan span("LoadPlugin " + pluginName, "startup");
+
     if (pluginName.substr(0, 2) == "p:") {
         // Mechanism A: prelinked dynamic
         LoadPluginPrelinkedDynamic(pluginName.substr(2));
@@ -264,6 +267,8 @@ auto fair::mq::PluginManager::LoadPluginStatic(const string& pluginName) -> void
 
 auto fair::mq::PluginManager::InstantiatePlugin(const string& pluginName) -> void
 {
+    tools::TraceSpan span("InstantiatePlugin " + pluginName, "startup");
+
     if (fPlugins.find(pluginName) == fPlugins.end()) {
         if ("control" == pluginName) {
             fPlugins[pluginName] = plugins::Make_control_Plugin(fPluginServices.get());
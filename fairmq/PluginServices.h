@@ -246,6 +246,8 @@ class PluginServices
 
     /// @brief Unsubscribe from property updates of type T
     /// @param subscriber
+    ///
+    /// Blocks until callbacks in flight on other threads have returned, do not call it while holding a lock that the callback takes.
     template<typename T>
     auto UnsubscribeFromPropertyChange(const std::string& subscriber) -> void { fConfig.Unsubscribe<T>(subscriber); }
 
@@ -261,6 +263,8 @@ class PluginServices
 
     /// @brief Unsubscribe from property updates that convert to string
     /// @param subscriber
+    ///
+    /// Blocks like UnsubscribeFromPropertyChange().
     auto UnsubscribeFromPropertyChangeAsString(const std::string& subscriber) -> void { fConfig.UnsubscribeAsString(subscriber); }
 
     /// @brief Increases console logging severity, or sets it to lowest if it is already highest
@@ -129,12 +129,39 @@ void ProgOptions::ParseAll(const int argc, char const* const* argv, bool allowUn
     fUnregisteredOptions = po::collect_unrecognized(parsed.options, po::include_positional);
 
     po::store(parsed, fVarMap);
+    PublishToAllHandles();
 }
 
 void ProgOptions::Notify()
 {
     lock_guard<mutex> lock(fMtx);
     po::notify(fVarMap);
+    PublishToAllHandles();
+}
+
+void ProgOptions::PublishToHandles(const string& key)
+{
+    if (fPropertySlots.empty()) {
+        return;
+    }
+    auto range = fPropertySlots.equal_range(key);
+    if (range.first == range.second || fVarMap.count(key) == 0) {
+        return;
+    }
+    for (auto it = range.first; it != range.second; ++it) {
+        try {
+            it->second->Publish(fVarMap[key].value());
+        } catch (const boost::bad_any_cast&) {
+            LOG(warn) << "Property '" << key << "' changed its type, the property handles of the previous type keep the previous value";
+        }
+    }
+}
+
+void ProgOptions::PublishToAllHandles()
+{
+    for (auto it = fPropertySlots.begin(); it != fPropertySlots.end(); it = fPropertySlots.equal_range(it->first).second) {
+        PublishToHandles(it->first);
+    }
 }
 
 void ProgOptions::AddToCmdLineOptions(const po::options_description optDesc, bool /* visible */)
@@ -306,13 +333,17 @@ void ProgOptions::SetProperties(const Properties& input)
     map<string, boost::program_options::variable_value>& vm = fVarMap;
     for (const auto& m : input) {
         vm[m.first].value() = m.second;
+        PublishToHandles(m.first);
     }
 
     lock.unlock();
 
+    const bool asString = fEvents.HasSubscribers<PropertyChangeAsString, string>();
     for (const auto& m : input) {
         PropertyHelper::fEventEmitters.at(m.second.type())(fEvents, m.first, m.second);
-        fEvents.Emit<PropertyChangeAsString, string>(m.first, PropertyHelper::ConvertPropertyToString(m.second));
+        if (asString) {
+            fEvents.Emit<PropertyChangeAsString, string>(m.first, PropertyHelper::ConvertPropertyToString(m.second));
+        }
     }
 }
 
@@ -330,13 +361,17 @@ bool ProgOptions::UpdateProperties(const Properties& input)
     map<string, boost::program_options::variable_value>& vm = fVarMap;
     for (const auto& m : input) {
         vm[m.first].value() = m.second;
+        PublishToHandles(m.first);
     }
 
     lock.unlock();
 
+    const bool asString = fEvents.HasSubscribers<PropertyChangeAsString, string>();
     for (const auto& m : input) {
         PropertyHelper::fEventEmitters.at(m.second.type())(fEvents, m.first, m.second);
-        fEvents.Emit<PropertyChangeAsString, string>(m.first, PropertyHelper::ConvertPropertyToString(m.second));
+        if (asString) {
+            fEvents.Emit<PropertyChangeAsString, string>(m.first, PropertyHelper::ConvertPropertyToString(m.second));
+        }
     }
 
     return true;
@@ -373,6 +408,13 @@ void ProgOptions::AddChannel(const string& name, const Channel& channel)
     SetVarMapValue<int>(string(prefix + "rateLogging"), channel.GetRateLogging());
     SetVarMapValue<int>(string(prefix + "portRangeMin"), channel.GetPortRangeMin());
     SetVarMapValue<int>(string(prefix + "portRangeMax"), channel.GetPortRangeMax());
+    SetVarMapValue<string>(string(prefix + "compression"), channel.GetCompression());
+    SetVarMapValue<int>(string(prefix + "compressionLevel"), channel.GetCompressionLevel());
+    SetVarMapValue<int>(string(prefix + "compressionThreshold"), channel.GetCompressionThreshold());
+    SetVarMapValue<int>(string(prefix + "compressionThreads"), channel.GetCompressionThreads());
+    SetVarMapValue<int64_t>(string(prefix + "maxBytesPerSec"), channel.GetMaxBytesPerSec());
+    SetVarMapValue<int64_t>(string(prefix + "maxMsgsPerSec"), channel.GetMaxMsgsPerSec());
+    SetVarMapValue<int>(string(prefix + "shapingBurstMs"), channel.GetShapingBurstMs());
     SetVarMapValue<bool>(string(prefix + "autoBind"), channel.GetAutoBind());
 }
 
@@ -15,9 +15,11 @@
 #include <fairmq/EventManager.h>
 #include <fairmq/ProgOptionsFwd.h>
 #include <fairmq/Properties.h>
+#include <fairmq/PropertyHandle.h>
 #include <fairmq/tools/Strings.h>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <string>
@@ -86,6 +88,29 @@ class ProgOptions
         return ifNotFound;
     }
 
+    /// @brief Get a typed handle to a config property, for lock-free reads (e.g. per message), throw if no property with this key exists
+    /// @param key
+    /// @return handle, following all subsequent updates of the property
+    ///
+    /// Throws boost::bad_any_cast if the property is not of type T.
+    template<typename T>
+    PropertyHandle<T> GetPropertyHandle(const std::string& key) const
+    {
+        std::lock_guard<std::mutex> lock(fMtx);
+        if (!fVarMap.count(key)) {
+            throw PropertyNotFoundError(fair::mq::tools::ToString("Config has no key: ", key));
+        }
+        auto range = fPropertySlots.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (auto slot = std::dynamic_pointer_cast<const detail::PropertySlot<T>>(it->second)) {
+                return PropertyHandle<T>(slot);
+            }
+        }
+        auto slot = std::make_shared<detail::PropertySlot<T>>(fVarMap[key].as<T>());
+        fPropertySlots.emplace(key, slot);
+        return PropertyHandle<T>(slot);
+    }
+
     /// @brief Read config property as string, throw if no property with this key exists
     /// @param key
     /// @return config property converted to string
@@ -145,7 +170,9 @@ class ProgOptions
             lock.unlock();
 
             fEvents.Emit<fair::mq::PropertyChange, typename std::decay<T>::type>(key, val);
-            fEvents.Emit<fair::mq::PropertyChangeAsString, std::string>(key, GetPropertyAsString(key));
+            if (fEvents.HasSubscribers<fair::mq::PropertyChangeAsString, std::string>()) {
+                fEvents.Emit<fair::mq::PropertyChangeAsString, std::string>(key, GetPropertyAsString(key));
+            }
             return true;
         } else {
             LOG(debug) << "UpdateProperty failed, no property found with key '" << key << "'";
@@ -184,10 +211,13 @@ class ProgOptions
 
     /// @brief Unsubscribe from property updates of type T
     /// @param subscriber
+    ///
+    /// Blocks until property change callbacks in flight on other threads have returned (see EventManager::Unsubscribe),
+    /// do not call it while holding a lock that the callback takes.
     template<typename T>
     void Unsubscribe(const std::string& subscriber) const
     {
-        std::lock_guard<std::mutex> lock(fMtx);
+        // not under fMtx: waits for emissions in flight, whose callbacks may access the properties
         fEvents.Unsubscribe<fair::mq::PropertyChange, T>(subscriber);
     }
 
@@ -204,9 +234,11 @@ class ProgOptions
 
     /// @brief Unsubscribe from property updates that convert to string
     /// @param subscriber
+    ///
+    /// Blocks like Unsubscribe(), do not call it while holding a lock that the callback takes.
     void UnsubscribeAsString(const std::string& subscriber) const
     {
-        std::lock_guard<std::mutex> lock(fMtx);
+        // not under fMtx: waits for emissions in flight, whose callbacks may access the properties
         fEvents.Unsubscribe<fair::mq::PropertyChangeAsString, std::string>(subscriber);
     }
 
@@ -254,14 +286,21 @@ class ProgOptions
     {
         std::map<std::string, boost::program_options::variable_value>& vm = fVarMap;
         vm[key].value() = boost::any(val);
+        PublishToHandles(key);
     }
 
+    /// publish the current value of the property to its handles (call with fMtx held)
+    void PublishToHandles(const std::string& key);
+    /// publish the current values of all properties with handles (call with fMtx held)
+    void PublishToAllHandles();
+
     boost::program_options::variables_map fVarMap; ///< options container
     boost::program_options::options_description fAllOptions; ///< all options descriptions
     std::vector<std::string> fUnregisteredOptions; ///< container with unregistered options
 
     mutable fair::mq::EventManager fEvents;
     mutable std::mutex fMtx;
+    mutable std::unordered_multimap<std::string, std::shared_ptr<detail::PropertySlotBase>> fPropertySlots; ///< slots backing the property handles
 };
 
 } // namespace fair::mq
@@ -275,7 +314,10 @@ void fair::mq::ProgOptions::SetProperty(const std::string& key, T val)
     lock.unlock();
 
     fEvents.Emit<fair::mq::PropertyChange, typename std::decay<T>::type>(key, val);
-    fEvents.Emit<fair::mq::PropertyChangeAsString, std::string>(key, GetPropertyAsString(key));
+    // the string conversion is only done for string subscribers
+    if (fEvents.HasSubscribers<fair::mq::PropertyChangeAsString, std::string>()) {
+        fEvents.Emit<fair::mq::PropertyChangeAsString, std::string>(key, GetPropertyAsString(key));
+    }
 }
 
 extern template void fair::mq::ProgOptions::SetProperty<int>(const std::string& key, int val);
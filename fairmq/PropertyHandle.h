@@ -0,0 +1,169 @@
+/********************************************************************************
+ * Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH       *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_PROPERTYHANDLE_H
+#define FAIR_MQ_PROPERTYHANDLE_H
+
+#include <boost/any.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fair::mq
+{
+
+class ProgOptions;
+
+namespace detail
+{
+
+struct PropertySlotBase
+{
+    virtual ~PropertySlotBase() = default;
+    /// called by ProgOptions (under its lock) whenever the property is modified
+    virtual void Publish(const boost::any& value) = 0;
+};
+
+template<typename T, typename = void>
+constexpr bool kAtomicPropertySlot = false;
+// lock-free std::atomic<T> only, for some sizes it would fall back to a lock (libatomic)
+template<typename T>
+constexpr bool kAtomicPropertySlot<T, std::enable_if_t<std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*)>> = std::atomic<T>::is_always_lock_free;
+
+template<typename T, bool Atomic = kAtomicPropertySlot<T>>
+struct PropertySlot;
+
+// small trivially copyable types (numbers, bools, enums): the value itself is published atomically
+template<typename T>
+struct PropertySlot<T, true> : PropertySlotBase
+{
+    explicit PropertySlot(const T& value)
+        : fValue(value)
+    {}
+
+    void Publish(const boost::any& value) override { fValue.store(boost::any_cast<T>(value), std::memory_order_release); }
+    T Get() const { return fValue.load(std::memory_order_acquire); }
+
+  private:
+    std::atomic<T> fValue;
+};
+
+// other types (strings, vectors): every update publishes a new immutable copy (RCU-style), readers load the current
+// copy via an atomic pointer. Superseded copies are freed by epoch based reclamation (as the subscriber lists of the
+// EventManager): a reader increments the counter of the epoch it observed before loading the pointer, the epoch only
+// advances from e to e + 1 once the readers counted for e - 1 (same counter as e + 1) have finished. So at epoch e + 2
+// no reader can still access a copy retired at epoch e. The copies are held by shared_ptrs, Snapshot() shares them.
+template<typename T>
+struct PropertySlot<T, false> : PropertySlotBase
+{
+    explicit PropertySlot(const T& value)
+        : fOwner(std::make_unique<const std::shared_ptr<const T>>(std::make_shared<const T>(value)))
+        , fCurrent(fOwner.get())
+    {}
+
+    void Publish(const boost::any& value) override
+    {
+        auto next = std::make_unique<const std::shared_ptr<const T>>(std::make_shared<const T>(boost::any_cast<const T&>(value)));
+        fCurrent.store(next.get());
+        fRetired.emplace_back(fEpoch.load(), std::move(fOwner));
+        fOwner = std::move(next);
+        Reclaim();
+    }
+    std::shared_ptr<const T> Snapshot() const
+    {
+        ReadGuard guard(*this);
+        return *fCurrent.load();
+    }
+    T Get() const
+    {
+        ReadGuard guard(*this);
+        return **fCurrent.load();
+    }
+
+  private:
+    struct ReadGuard
+    {
+        explicit ReadGuard(const PropertySlot& slot)
+            : fReaders(slot.fReaders[slot.fEpoch.load() & 1])
+        {
+            fReaders.fetch_add(1);
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard() { fReaders.fetch_sub(1); }
+        std::atomic<int>& fReaders;
+    };
+
+    // called from Publish() (under the ProgOptions lock), advances the epoch as far as the readers in flight allow
+    // and frees the copies retired at least two epochs ago
+    void Reclaim()
+    {
+        for (int i = 0; i < 2; ++i) {
+            const uint64_t epoch = fEpoch.load();
+            if (fReaders[(epoch + 1) & 1].load() != 0) {
+                break;
+            }
+            fEpoch.store(epoch + 1);
+        }
+        const uint64_t epoch = fEpoch.load();
+        fRetired.erase(std::remove_if(fRetired.begin(), fRetired.end(), [&](const auto& r) { return r.first + 2 <= epoch; }), fRetired.end());
+    }
+
+    std::unique_ptr<const std::shared_ptr<const T>> fOwner;
+    std::atomic<const std::shared_ptr<const T>*> fCurrent;
+    std::vector<std::pair<uint64_t, std::unique_ptr<const std::shared_ptr<const T>>>> fRetired; // epoch of retirement, copy
+    std::atomic<uint64_t> fEpoch{0};
+    mutable std::array<std::atomic<int>, 2> fReaders{}; // reads in flight, by epoch parity
+};
+
+} // namespace detail
+
+/**
+ * @class PropertyHandle PropertyHandle.h <fairmq/PropertyHandle.h>
+ * @brief Pre-resolved, typed handle to a config property, for reading it from hot loops
+ *
+ * Obtained via ProgOptions::GetPropertyHandle<T>(key). Reading is lock-free and does not look up the key or cast,
+ * it returns the last value published by SetProperty/UpdateProperty/SetProperties/UpdateProperties/ParseAll.
+ * Small trivially copyable types are read from a lock-free std::atomic. Other types are returned as a copy by Get(),
+ * Snapshot() returns a shared_ptr to the current immutable value instead, which stays valid for as long as it is held.
+ * Reads of such types only touch atomic counters (an epoch counter and, for Snapshot(), the shared_ptr reference count).
+ * The handle may outlive the ProgOptions instance.
+ * Deleting the property keeps the last value in the handle.
+ */
+template<typename T>
+class PropertyHandle
+{
+  public:
+    PropertyHandle() = default;
+
+    /// @brief current value of the property
+    decltype(auto) Get() const { return fSlot->Get(); }
+    decltype(auto) operator*() const { return fSlot->Get(); }
+    /// @brief current value of the property, without copying it (only for types that are not read atomically)
+    std::shared_ptr<const T> Snapshot() const { return fSlot->Snapshot(); }
+
+    bool Valid() const { return fSlot != nullptr; }
+
+  private:
+    friend class ProgOptions;
+    explicit PropertyHandle(std::shared_ptr<const detail::PropertySlot<T>> slot)
+        : fSlot(std::move(slot))
+    {}
+
+    std::shared_ptr<const detail::PropertySlot<T>> fSlot;
+};
+
+} // namespace fair::mq
+
+#endif /* FAIR_MQ_PROPERTYHANDLE_H */
@@ -11,6 +11,7 @@
 
 #include <fairmq/Message.h>
 #include <fairmq/Parts.h>
+#include <fairmq/UnmanagedRegion.h>
 
 #include <memory>
 #include <stdexcept>
@@ -56,6 +57,20 @@ struct Socket
     virtual int64_t Receive(Parts::container & msgVec, int timeout = -1) = 0;
     virtual int64_t Send(Parts& parts, int timeout = -1) { return Send(parts.fParts, timeout); }
     virtual int64_t Receive(Parts& parts, int timeout = -1) { return Receive(parts.fParts, timeout); }
+    /// Send blocks of an unmanaged region as one multipart message with a compact descriptor.
+    /// Only implemented by transports with region support on the wire, use Channel::SendRegionBlocks().
+    virtual int64_t SendRegionBlocks(UnmanagedRegionPtr& /* region */, const RegionBlock* /* blocks */, size_t /* count */, int /* timeout */ = -1)
+    {
+        throw std::runtime_error("SendRegionBlocks is not supported by this transport");
+    }
+    /// Compress the parts sent through this socket with the given codec ("none", "lz4", "zstd").
+    /// Only implemented by transports that copy the data over the wire, the peer has to compress too.
+    virtual void SetCompression(const std::string& codec, int /* level */, size_t /* threshold */, int /* threads */)
+    {
+        if (codec != "none") {
+            throw std::runtime_error("compression is not supported by this transport");
+        }
+    }
 
     [[deprecated("Use Socket::~Socket() instead.")]]
     virtual void Close() = 0;
@@ -82,6 +97,11 @@ struct Socket
     virtual unsigned long GetBytesRx() const = 0;
     virtual unsigned long GetMessagesTx() const = 0;
     virtual unsigned long GetMessagesRx() const = 0;
+    /// Bytes before compression, equal to GetBytesTx()/GetBytesRx() without compression
+    virtual unsigned long GetBytesTxUncompressed() const { return GetBytesTx(); }
+    virtual unsigned long GetBytesRxUncompressed() const { return GetBytesRx(); }
+    /// Messages discarded instead of sent (shmem quota policy drop), not included in GetMessagesTx()/GetBytesTx()
+    virtual unsigned long GetMessagesDropped() const { return 0; }
 
     virtual unsigned long GetNumberOfConnectedPeers() const = 0;
 
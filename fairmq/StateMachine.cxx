@@ -8,6 +8,7 @@
 
 #include <fairmq/StateMachine.h>
 #include <fairmq/tools/Exceptions.h>
+#include <fairmq/tools/Futex.h>
 
 #include <fairlogger/Logger.h>
 
@@ -25,8 +26,8 @@
 #include <boost/signals2.hpp> // signal/slot for onStateChange callbacks
 
 #include <atomic>
-#include <condition_variable>
 #include <chrono>
+#include <cstdint>
 #include <unordered_map>
 #include <mutex>
 
@@ -41,6 +42,63 @@ namespace fair::mq
 namespace fsm
 {
 
+// Current state, pending new state and a version counter packed into one futex word: checking for a
+// pending state is a single relaxed load and waiting for a state change takes no lock.
+// Writes are serialized by the caller (fStateMtx).
+class StateWord
+{
+  public:
+    struct Value
+    {
+        State fState;
+        State fNewState;
+        bool fPending;
+    };
+
+    explicit StateWord(State state) : fWord(Pack({state, state, false}, 0)) {}
+
+    Value Load() const { return Unpack(fWord.load(memory_order_acquire)); }
+    State GetState() const { return Load().fState; }
+    State GetNewState() const { return Load().fNewState; }
+    bool Pending() const { return (fWord.load(memory_order_relaxed) & kPendingBit) != 0; }
+    const atomic<uint32_t>& Word() const { return fWord; }
+
+    void Store(Value value)
+    {
+        uint32_t version = (fWord.load(memory_order_relaxed) >> kVersionShift) + 1;
+        fWord.store(Pack(value, version), memory_order_release);
+        tools::FutexWakeAll(fWord);
+    }
+    void SetState(State state) { Value v = Load(); v.fState = state; Store(v); }
+    void SetPending(State newState) { Store({Load().fState, newState, true}); }
+    /// make the pending state current
+    State Commit() { Value v = Load(); Store({v.fNewState, v.fNewState, false}); return v.fNewState; }
+
+    /// @param timeout negative - wait indefinitely
+    /// @return true if a new state is pending, false on timeout
+    bool WaitForPending(chrono::nanoseconds timeout = chrono::nanoseconds(-1)) const
+    {
+        return tools::FutexWaitUntil(fWord, [](uint32_t word) { return (word & kPendingBit) != 0; }, timeout);
+    }
+
+  private:
+    static constexpr uint32_t kStateMask = 0xFF;
+    static constexpr uint32_t kNewStateShift = 8;
+    static constexpr uint32_t kPendingBit = StateMachine::kPendingBit;
+    static constexpr uint32_t kVersionShift = 17;
+
+    static uint32_t Pack(Value v, uint32_t version)
+    {
+        return static_cast<uint32_t>(v.fState) | (static_cast<uint32_t>(v.fNewState) << kNewStateShift) | (v.fPending ? kPendingBit : 0) | (version << kVersionShift);
+    }
+    static Value Unpack(uint32_t word)
+    {
+        return {static_cast<State>(word & kStateMask), static_cast<State>((word >> kNewStateShift) & kStateMask), (word & kPendingBit) != 0};
+    }
+
+    atomic<uint32_t> fWord;
+};
+
 // list of FSM states
 struct OK_S                  : public state<> { static string Name() { return "OK"; }                  static State Type() { return State::Ok; } };
 
@@ -79,10 +137,8 @@ struct Machine_ : public state_machine_def<Machine_>
 {
   public:
     Machine_()
-        : fState(State::Ok)
-        , fNewState(State::Ok)
+        : fStateWord(State::Ok)
         , fLastTransitionResult(true)
-        , fNewStatePending(false)
     {}
 
     // initial states
@@ -92,7 +148,7 @@ struct Machine_ : public state_machine_def<Machine_>
     void on_entry(Transition const&, FSM& /* fsm */)
     {
         LOG(state) << "Starting FairMQ state machine --> IDLE";
-        fState = State::Idle;
+        fStateWord.SetState(State::Idle);
     }
 
     template<typename Transition, typename FSM>
@@ -106,11 +162,9 @@ struct Machine_ : public state_machine_def<Machine_>
         template<typename EVT, typename FSM, typename SourceState, typename TargetState>
         void operator()(EVT const& e, FSM& fsm, SourceState& /* ss */, TargetState& ts)
         {
-            fsm.fNewState = ts.Type();
             fsm.fLastTransitionResult = true;
             fsm.CallNewTransitionCallbacks(e.Type());
-            fsm.fNewStatePending = true;
-            fsm.fNewStatePendingCV.notify_all();
+            fsm.fStateWord.SetPending(ts.Type());
         }
     };
 
@@ -172,14 +226,11 @@ struct Machine_ : public state_machine_def<Machine_>
     }
 
 
-    atomic<State> fState;
-    atomic<State> fNewState;
+    StateWord fStateWord;
     atomic<bool> fLastTransitionResult;
 
-    mutex fStateMtx;
+    mutex fStateMtx; // serializes transitions and writes to fStateWord
     mutex fSubscriptionsMtx;
-    atomic<bool> fNewStatePending;
-    condition_variable fNewStatePendingCV;
 
     boost::signals2::signal<void(const State)> fStateChangeSignal;
     boost::signals2::signal<void(const State)> fStateHandleSignal;
@@ -191,28 +242,27 @@ struct Machine_ : public state_machine_def<Machine_>
     void ProcessWork()
     {
         bool stop = false;
+        State state = State::Ok;
 
         while (!stop) {
+            fStateWord.WaitForPending();
             {
-                unique_lock<mutex> lock(fStateMtx);
-
-                fNewStatePendingCV.wait(lock, [this]{ return fNewStatePending.load(); });
+                lock_guard<mutex> lock(fStateMtx);
 
-                LOG(state) << fState << " ---> " << fNewState;
-                fState = static_cast<State>(fNewState);
-                fNewStatePending = false;
+                LOG(state) << fStateWord.GetState() << " ---> " << fStateWord.GetNewState();
+                state = fStateWord.Commit();
 
-                if (fState == State::Exiting || fState == State::Error) {
+                if (state == State::Exiting || state == State::Error) {
                     stop = true;
                 }
             }
 
-            CallStatePrep(fState);
-            CallStateChangeCallbacks(fState);
-            CallStateHandler(fState);
+            CallStatePrep(state);
+            CallStateChangeCallbacks(state);
+            CallStateHandler(state);
         }
 
-        if (fState == State::Error) {
+        if (state == State::Error) {
             LOG(trace) << "Device transitioned to error state";
             throw StateMachine::ErrorStateException("Device transitioned to error state");
         }
@@ -250,7 +300,10 @@ using FairMQFSM = state_machine<Machine_>;
 using namespace fair::mq::fsm;
 using namespace fair::mq;
 
-StateMachine::StateMachine() : fFsm(new FairMQFSM) {}
+StateMachine::StateMachine()
+    : fFsm(new FairMQFSM)
+    , fStateWord(&static_cast<FairMQFSM*>(fFsm.get())->fStateWord.Word())
+{}
 void StateMachine::Start() { static_pointer_cast<FairMQFSM>(fFsm)->start(); }
 StateMachine::~StateMachine() { static_pointer_cast<FairMQFSM>(fFsm)->stop(); }
 
@@ -258,7 +311,7 @@ bool StateMachine::ChangeState(Transition transition)
 try {
     auto fsm = static_pointer_cast<FairMQFSM>(fFsm);
     lock_guard<mutex> lock(fsm->fStateMtx);
-    if (!static_cast<bool>(fsm->fNewStatePending) || transition == Transition::ErrorFound) {
+    if (!fsm->fStateWord.Pending() || transition == Transition::ErrorFound) {
         switch (transition) {
             case Transition::Auto:
                 fsm->process_event(AUTO_E());
@@ -376,21 +429,16 @@ void StateMachine::UnsubscribeFromNewTransition(const string& key)
     }
 }
 
-State StateMachine::GetCurrentState() const { return static_pointer_cast<FairMQFSM>(fFsm)->fState; }
-string StateMachine::GetCurrentStateName() const { return GetStateName(static_pointer_cast<FairMQFSM>(fFsm)->fState); }
+State StateMachine::GetCurrentState() const { return static_cast<FairMQFSM*>(fFsm.get())->fStateWord.GetState(); }
+string StateMachine::GetCurrentStateName() const { return GetStateName(GetCurrentState()); }
 
-bool StateMachine::NewStatePending() const { return static_cast<bool>(static_pointer_cast<FairMQFSM>(fFsm)->fNewStatePending); }
 void StateMachine::WaitForPendingState() const
 {
-    auto fsm = static_pointer_cast<FairMQFSM>(fFsm);
-    unique_lock<mutex> lock(fsm->fStateMtx);
-    fsm->fNewStatePendingCV.wait(lock, [&]{ return static_cast<bool>(fsm->fNewStatePending); });
+    static_cast<FairMQFSM*>(fFsm.get())->fStateWord.WaitForPending();
 }
 bool StateMachine::WaitForPendingStateFor(int durationInMs) const
 {
-    auto fsm = static_pointer_cast<FairMQFSM>(fFsm);
-    unique_lock<mutex> lock(fsm->fStateMtx);
-    return fsm->fNewStatePendingCV.wait_for(lock, std::chrono::milliseconds(durationInMs), [&]{ return static_cast<bool>(fsm->fNewStatePending); });
+    return static_cast<FairMQFSM*>(fFsm.get())->fStateWord.WaitForPending(std::chrono::milliseconds(durationInMs));
 }
 
 void StateMachine::ProcessWork()
@@ -401,7 +449,7 @@ void StateMachine::ProcessWork()
         LOG(debug) << "Exception caught in ProcessWork(), going to Error state";
         {
             lock_guard<mutex> lock(fsm->fStateMtx);
-            fsm->fState = State::Error;
+            fsm->fStateWord.SetState(State::Error);
             fsm->CallStateChangeCallbacks(State::Error);
         }
         ChangeState(Transition::ErrorFound);
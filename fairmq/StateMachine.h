@@ -11,6 +11,8 @@
 
 #include <fairmq/States.h>
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <functional>
@@ -42,7 +44,8 @@ class StateMachine
     void SubscribeToNewTransition(const std::string& key, std::function<void(const Transition)> callback);
     void UnsubscribeFromNewTransition(const std::string& key);
 
-    bool NewStatePending() const;
+    /// single relaxed load, suitable for checks in every iteration of a processing loop
+    bool NewStatePending() const { return (fStateWord->load(std::memory_order_relaxed) & kPendingBit) != 0; }
     void WaitForPendingState() const;
     bool WaitForPendingStateFor(int durationInMs) const;
 
@@ -55,8 +58,12 @@ class StateMachine
 
     struct ErrorStateException : std::runtime_error { using std::runtime_error::runtime_error; };
 
+    /// bit of the state word (see StateMachine.cxx), set while a new state is pending
+    static constexpr uint32_t kPendingBit = 1U << 16;
+
   private:
     std::shared_ptr<void> fFsm;
+    const std::atomic<uint32_t>* fStateWord; // owned by fFsm
 };
 
 } // namespace fair::mq
@@ -9,19 +9,40 @@
 #ifndef FAIRMQSTATEQUEUE_H_
 #define FAIRMQSTATEQUEUE_H_
 
-#include <chrono>
-#include <condition_variable>
 #include <fairmq/States.h>
+#include <fairmq/tools/Futex.h>
+#include <fairlogger/Logger.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
-#include <queue>
 #include <utility>   // pair
 
 namespace fair::mq {
 
+/**
+ * @class StateQueue StateQueue.h <fairmq/StateQueue.h>
+ * @brief Queue of state changes, consumed by a controlling thread
+ *
+ * Pushing and popping are lock-free (bounded ring of kCapacity states, the oldest state is dropped
+ * when a consumer falls that far behind, except for an Error state). Waiters block on a futex, which is woken on every push
+ * or notification, so that pushers never contend with waiters on a lock. Only the custom signals and predicates
+ * are run under a mutex, so that they stay mutually exclusive.
+ */
 class StateQueue
 {
   public:
-    StateQueue() = default;
+    static constexpr std::size_t kCapacity = 256;
+
+    StateQueue()
+    {
+        for (std::size_t i = 0; i < kCapacity; ++i) {
+            fCells[i].fSeq.store(i, std::memory_order_relaxed);
+        }
+    }
     StateQueue(const StateQueue&) = delete;
     StateQueue(StateQueue&&) = delete;
     StateQueue& operator=(const StateQueue&) = delete;
@@ -30,69 +51,78 @@ class StateQueue
 
     fair::mq::State WaitForNext()
     {
-        std::unique_lock<std::mutex> lock(fMtx);
-        fCV.wait(lock, [this] { return Predicate(); });
-        return PopFrontUnsafe();
+        fair::mq::State state = fair::mq::State::Ok;
+        tools::FutexWaitUntil(fVersion, [&](uint32_t) { return TryPop(state); });
+        return state;
     }
 
     template<typename Timeout>
     std::pair<bool, fair::mq::State> WaitForNext(Timeout&& duration)
     {
-        std::unique_lock<std::mutex> lock(fMtx);
-        fCV.wait_for(lock, std::forward<Timeout>(duration), [this] { return Predicate(); });
-        return ReturnPairUnsafe();
+        fair::mq::State state = fair::mq::State::Ok;
+        bool popped = tools::FutexWaitUntil(fVersion, [&](uint32_t) { return TryPop(state); },
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+        return {popped, state};
     }
 
     template<typename CustomPredicate>
     std::pair<bool, fair::mq::State> WaitForNextOrCustom(CustomPredicate&& customPredicate)
     {
-        std::unique_lock<std::mutex> lock(fMtx);
-        fCV.wait(lock, [this, cp = std::move(customPredicate)] { return Predicate() || cp(); });
-        return ReturnPairUnsafe();
+        fair::mq::State state = fair::mq::State::Ok;
+        bool popped = false;
+        tools::FutexWaitUntil(fVersion, [&](uint32_t) { return (popped = TryPop(state)) || Evaluate(customPredicate); });
+        return {popped, state};
     }
 
     template<typename CustomPredicate>
     std::pair<bool, fair::mq::State> WaitForCustom(CustomPredicate&& customPredicate)
     {
-        std::unique_lock<std::mutex> lock(fMtx);
-        fCV.wait(lock, [cp = std::move(customPredicate)] { return cp(); });
-        return ReturnPairUnsafe();
+        tools::FutexWaitUntil(fVersion, [&](uint32_t) { return Evaluate(customPredicate); });
+        fair::mq::State state = fair::mq::State::Ok;
+        bool popped = TryPop(state);
+        return {popped, state};
     }
 
+    /// consume states until the given one, which counts as consumed if it was dropped from a full queue
     void WaitForState(fair::mq::State state)
     {
-        while (WaitForNext() != state) {}
+        fair::mq::State next = fair::mq::State::Ok;
+        uint32_t dropped = 0;
+        do {
+            tools::FutexWaitUntil(fVersion, [&](uint32_t) { return TryPop(next, dropped); });
+        } while (next != state && (dropped & Bit(state)) == 0);
     }
 
     template<typename CustomPredicate>
     void WaitForStateOrCustom(fair::mq::State state, CustomPredicate customPredicate)
     {
-        auto next = WaitForNextOrCustom(customPredicate);
-        while (!customPredicate() && (next.first && next.second != state)) {
-            next = WaitForNextOrCustom(customPredicate);
-        }
+        fair::mq::State next = fair::mq::State::Ok;
+        uint32_t dropped = 0;
+        bool popped = false;
+        do {
+            tools::FutexWaitUntil(fVersion, [&](uint32_t) { return (popped = TryPop(next, dropped)) || Evaluate(customPredicate); });
+        } while (!Evaluate(customPredicate) && popped && next != state && (dropped & Bit(state)) == 0);
     }
 
     void Push(fair::mq::State state)
     {
-        {
-            std::lock_guard<std::mutex> lock(fMtx);
-            fStates.push(state);
-        }
-        fCV.notify_one();
+        Enqueue(state);
+        Wake();
     }
 
+    /// push a state and set a custom flag (checked by the predicates of the waiters) before waking them
     template<typename CustomSignal>
     void Push(fair::mq::State state, CustomSignal&& signal)
     {
+        Enqueue(state);
         {
             std::lock_guard<std::mutex> lock(fMtx);
-            fStates.push(state);
             signal();
         }
-        fCV.notify_one();
+        Wake();
     }
 
+    /// set a custom flag (checked by the predicates of the waiters) and wake them
     template<typename CustomSignal>
     void Notify(CustomSignal&& signal)
     {
@@ -100,47 +130,150 @@ class StateQueue
             std::lock_guard<std::mutex> lock(fMtx);
             signal();
         }
-        fCV.notify_one();
+        Wake();
     }
 
+    /// run signal exclusively with the other signals and the custom predicates of the waiters,
+    /// waiters re-evaluate their predicates afterwards
     template<typename CustomSignal>
     void Locked(CustomSignal&& signal)
     {
-        std::lock_guard<std::mutex> lock(fMtx);
-        signal();
+        {
+            std::lock_guard<std::mutex> lock(fMtx);
+            signal();
+        }
+        Wake();
     }
 
     void Clear()
     {
-        std::lock_guard<std::mutex> lock(fMtx);
-        fStates = std::queue<fair::mq::State>();
+        fair::mq::State state;
+        while (Dequeue(state, ErrorAtFront::pop)) {}
+        fDropped.store(0, std::memory_order_relaxed);
     }
 
   private:
-    std::queue<fair::mq::State> fStates;
-    std::mutex fMtx;
-    std::condition_variable fCV;
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+    // bounded MPMC ring after D. Vyukov, a cell is writable when fSeq == position, readable when fSeq == position + 1
+    struct Cell
+    {
+        std::atomic<std::size_t> fSeq;
+        std::atomic<fair::mq::State> fState;
+    };
+
+    std::array<Cell, kCapacity> fCells;
+    alignas(64) std::atomic<std::size_t> fEnqueuePos{0};
+    alignas(64) std::atomic<std::size_t> fDequeuePos{0};
+    alignas(64) std::atomic<uint32_t> fVersion{0}; // futex word, bumped on every push/notification
+    std::atomic<uint32_t> fDropped{0}; // states dropped from the full queue since the last pop, one bit per state
+    std::mutex fMtx; // serializes the custom signals and predicates
+
+    static_assert(static_cast<int>(fair::mq::State::Exiting) < 32, "one bit per state in fDropped");
+    static constexpr uint32_t Bit(fair::mq::State state) { return 1U << static_cast<int>(state); }
 
-    // must be called under locked fMtx
-    fair::mq::State PopFrontUnsafe()
+    template<typename CustomPredicate>
+    bool Evaluate(CustomPredicate& customPredicate)
+    {
+        std::lock_guard<std::mutex> lock(fMtx);
+        return customPredicate();
+    }
+
+    void Wake()
     {
-        fair::mq::State state = fStates.front();
-        if (state == fair::mq::State::Error) {
-            throw DeviceErrorState("Controlled device transitioned to error state.");
+        fVersion.fetch_add(1, std::memory_order_release);
+        tools::FutexWakeAll(fVersion);
+    }
+
+    // what Dequeue does with an Error state at the front of the queue
+    enum class ErrorAtFront
+    {
+        pop,   // pop it like any other state
+        raise, // leave it and throw DeviceErrorState
+        keep   // leave it and return false, with state set to Error
+    };
+
+    void Enqueue(fair::mq::State state)
+    {
+        while (!TryEnqueue(state)) {
+            // full, drop the oldest state. An Error state is never dropped, the new state is dropped instead
+            // (an Error state ends the consumption of the queue anyway).
+            fair::mq::State dropped = fair::mq::State::Ok;
+            if (Dequeue(dropped, ErrorAtFront::keep)) {
+                fDropped.fetch_or(Bit(dropped), std::memory_order_acq_rel);
+                LOG(warn) << "State queue full (" << kCapacity << " states), dropping the oldest state: " << dropped;
+            } else if (dropped == fair::mq::State::Error) {
+                LOG(warn) << "State queue full (" << kCapacity << " states) with a pending Error state, dropping the new state: " << state;
+                return;
+            }
         }
-        fStates.pop();
-        return state;
     }
 
-    // must be called under locked fMtx
-    std::pair<bool, fair::mq::State> ReturnPairUnsafe()
+    bool TryEnqueue(fair::mq::State state)
     {
-        auto const pred = Predicate();
-        return {pred, pred ? PopFrontUnsafe() : fair::mq::State::Ok};
+        std::size_t pos = fEnqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = fCells[pos & (kCapacity - 1)];
+            std::size_t seq = cell.fSeq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (fEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.fState.store(state, std::memory_order_relaxed);
+                    cell.fSeq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = fEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool Dequeue(fair::mq::State& state, ErrorAtFront onError)
+    {
+        std::size_t pos = fDequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = fCells[pos & (kCapacity - 1)];
+            std::size_t seq = cell.fSeq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                fair::mq::State value = cell.fState.load(std::memory_order_relaxed);
+                if (onError != ErrorAtFront::pop && value == fair::mq::State::Error) {
+                    if (onError == ErrorAtFront::keep) {
+                        state = value;
+                        return false;
+                    }
+                    throw DeviceErrorState("Controlled device transitioned to error state.");
+                }
+                if (fDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    state = value;
+                    cell.fSeq.store(pos + kCapacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = fDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
     }
 
-    // must be called under locked fMtx
-    bool Predicate() { return !fStates.empty(); }
+    bool TryPop(fair::mq::State& state)
+    {
+        uint32_t dropped = 0;
+        return TryPop(state, dropped);
+    }
+
+    // the dropped states are older than the popped one, a successful pop passes them
+    bool TryPop(fair::mq::State& state, uint32_t& dropped)
+    {
+        if (!Dequeue(state, ErrorAtFront::raise)) {
+            return false;
+        }
+        dropped = fDropped.exchange(0, std::memory_order_acq_rel);
+        return true;
+    }
 };
 
 }   // namespace fair::mq
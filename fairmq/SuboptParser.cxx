@@ -44,6 +44,13 @@ enum channelOptionKeyIds
     RATELOGGING,    // logging rate
     PORTRANGEMIN,
     PORTRANGEMAX,
+    COMPRESSION,
+    COMPRESSIONLEVEL,
+    COMPRESSIONTHRESHOLD,
+    COMPRESSIONTHREADS,
+    MAXBYTESPERSEC,
+    MAXMSGSPERSEC,
+    SHAPINGBURSTMS,
     AUTOBIND,
     NUMSOCKETS,
     lastsocketkey
@@ -65,6 +72,13 @@ constexpr static const char* channelOptionKeys[] = {
     /*[RATELOGGING]   = */ "rateLogging",
     /*[PORTRANGEMIN]  = */ "portRangeMin",
     /*[PORTRANGEMAX]  = */ "portRangeMax",
+    /*[COMPRESSION]   = */ "compression",
+    /*[COMPRESSIONLEVEL]     = */ "compressionLevel",
+    /*[COMPRESSIONTHRESHOLD] = */ "compressionThreshold",
+    /*[COMPRESSIONTHREADS]   = */ "compressionThreads",
+    /*[MAXBYTESPERSEC] = */ "maxBytesPerSec",
+    /*[MAXMSGSPERSEC]  = */ "maxMsgsPerSec",
+    /*[SHAPINGBURSTMS] = */ "shapingBurstMs",
     /*[AUTOBIND]      = */ "autoBind",
     /*[NUMSOCKETS]    = */ "numSockets",
     nullptr
@@ -13,12 +13,16 @@
 #include <fairmq/tools/Compiler.h>
 #include <fairmq/tools/CppSTL.h>
 #include <fairmq/tools/Exceptions.h>
+#include <fairmq/tools/Futex.h>
 #include <fairmq/tools/InstanceLimit.h>
 #include <fairmq/tools/Network.h>
 #include <fairmq/tools/Process.h>
 #include <fairmq/tools/RateLimit.h>
 #include <fairmq/tools/Semaphore.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
+#include <fairmq/tools/TokenBucket.h>
+#include <fairmq/tools/Trace.h>
 #include <fairmq/tools/Unique.h>
 #include <fairmq/tools/Version.h>
 // IWYU pragma: end_exports
@@ -24,6 +24,7 @@ auto TransportFactory::CreateTransportFactory(const string& type,
                                               const ProgOptions* config)
     -> shared_ptr<TransportFactory>
 {
+    tools::TraceSpan span("CreateTransportFactory " + type, "startup");
     auto finalId = id;
 
     // Generate uuid if empty
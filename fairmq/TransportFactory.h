@@ -70,6 +70,16 @@ class TransportFactory
     /// @param alignment message alignment
     /// @return pointer to Message
     virtual MessagePtr CreateMessage(size_t size, Alignment alignment) = 0;
+    /// @brief Create new Message of specified size and alignment for sending on the given channel
+    /// (transports with per-channel allocation budgets charge it to the budget of the channel)
+    /// @param channel channel name, e.g. "data[0]"
+    /// @param size message size
+    /// @param alignment message alignment
+    /// @return pointer to Message
+    virtual MessagePtr CreateChannelMessage(const std::string& /* channel */, size_t size, Alignment alignment)
+    {
+        return CreateMessage(size, alignment);
+    }
     /// @brief Create new Message with user provided buffer and size
     /// @param data pointer to user provided buffer
     /// @param size size of the user provided buffer
@@ -176,6 +186,8 @@ class TransportFactory
     virtual void Interrupt() = 0;
     virtual void Resume() = 0;
     virtual void Reset() = 0;
+    /// @brief check if the transport has been interrupted (see Interrupt()), e.g. to abort waiting outside of a transfer
+    virtual bool Interrupted() { return false; }
 
     virtual ~TransportFactory() = default;
 
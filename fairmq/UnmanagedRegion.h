@@ -130,6 +130,7 @@ struct RegionConfig
 
     bool lock = false; /// mlock region after creation
     bool zero = false; /// zero region content after creation
+    bool prefault = false; /// fault in the region pages after creation, without modifying the content (implied by lock and zero)
     bool removeOnDestruction = true; /// remove the region on object destruction
     int creationFlags = 0; /// flags passed to the underlying transport on region creation
     int64_t userFlags = 0; /// custom flags that have no effect on the transport, but can be retrieved from the region by the user
@@ -49,7 +49,7 @@ class BenchmarkSampler : public Device
         LOG(info) << "Starting the benchmark with message size of " << fMsgSize << " and " << fMaxIterations << " iterations.";
         auto tStart = std::chrono::high_resolution_clock::now();
 
-        fair::mq::tools::RateLimiter rateLimiter(fMsgRate);
+        fair::mq::tools::RateLimiter rateLimiter(fMsgRate, GetRatePacing());
 
         while (!NewStatePending()) {
             if (fMultipart) {
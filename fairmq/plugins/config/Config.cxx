@@ -60,25 +60,40 @@ Plugin::ProgOptions ConfigPluginProgramOptions()
     pluginOptions.add_options()
         ("id",                            po::value<string        >()->default_value(""),                "Device ID.")
         ("io-threads",                    po::value<int           >()->default_value(1),                 "Number of I/O threads.")
+        ("thread-affinity",               po::value<vector<string>>()->multitoken()->composing(),        "CPU affinity per thread class: <class>:<cpu list>, e.g. 'io:2-3' 'housekeeping:0'. Classes: device (state machine & input threads), housekeeping (rate logging, heartbeats, region acks/events), io (ZeroMQ I/O threads).")
+        ("thread-sched",                  po::value<vector<string>>()->multitoken()->composing(),        "Scheduling policy per thread class: <class>:<policy>[:<priority>], policy: other/batch/idle/fifo/rr, priority: within the range of the policy (default: its minimum), e.g. 'io:fifo:10'.")
         ("transport",                     po::value<string        >()->default_value("zeromq"),          "Transport ('zeromq'/'shmem').")
         ("network-interface",             po::value<string        >()->default_value("default"),         "Network interface to bind on (e.g. eth0, ib0..., default will try to detect the interface of the default route).")
         ("init-timeout",                  po::value<int           >()->default_value(120),               "Timeout for the initialization in seconds (when expecting dynamic initialization).")
+        ("init-threads",                  po::value<int           >()->default_value(1),                 "Number of threads to validate and bind/connect channels with (1 - serial, 0 - number of cores).")
+        ("trace-file",                    po::value<string        >()->default_value(""),                "Write a timeline of the startup phases and state transitions in Chrome trace format (JSON) to the given file, when reaching RUNNING and at exit.")
         ("print-channels",                po::value<bool          >()->implicit_value(true),             "Print registered channel endpoints in a machine-readable format (<channel name>:<min num subchannels>:<max num subchannels>)")
         ("shm-segment-size",              po::value<size_t        >()->default_value(2ULL << 30),        "Shared memory: size of the shared memory segment (in bytes).")
-        ("shm-allocation",                po::value<string        >()->default_value("rbtree_best_fit"), "Shared memory allocation algorithm: rbtree_best_fit/simple_seq_fit.")
+        ("shm-allocation",                po::value<string        >()->default_value("rbtree_best_fit"), "Shared memory allocation algorithm: rbtree_best_fit/simple_seq_fit/segregated_fit.")
         ("shm-segment-id",                po::value<uint16_t      >()->default_value(0),                 "EXPERIMENTAL: Shared memory segment id for message creation.")
         ("shmid",                         po::value<uint64_t      >(),                                   "EXPERIMENTAL: Fixed shmid to use instead of deriving it from the session name.")
         ("shm-mlock-segment",             po::value<bool          >()->default_value(false),             "Shared memory: mlock the shared memory segment after initialization (opened or created).")
         ("shm-mlock-segment-on-creation", po::value<bool          >()->default_value(false),             "Shared memory: mlock the shared memory segment only once when created.")
         ("shm-zero-segment",              po::value<bool          >()->default_value(false),             "Shared memory: zero the shared memory segment memory after initialization (opened or created).")
         ("shm-zero-segment-on-creation",  po::value<bool          >()->default_value(false),             "Shared memory: zero the shared memory segment memory only once when created.")
+        ("shm-prefault-segment",          po::value<bool          >()->default_value(false),             "Shared memory: fault in the pages of the shared memory segment after initialization, without modifying its content (implied by shm-mlock-segment).")
+        ("shm-prefault-threads",          po::value<int           >()->default_value(0),                 "Shared memory: number of threads to zero/mlock/prefault segments and regions with (0 - one per cpu of the NUMA node of the memory, 1 - single threaded).")
+        ("shm-prefault-numa-node",        po::value<int           >()->default_value(-1),                "Shared memory: NUMA node to pin the zero/mlock/prefault threads to (-1 - node of the memory, -2 - no pinning).")
+        ("shm-prefault-populate",         po::value<bool          >()->default_value(false),             "Shared memory: fault in pages with madvise(MADV_POPULATE_WRITE) (Linux >= 5.14) instead of touching them.")
         ("shm-throw-bad-alloc",           po::value<bool          >()->default_value(true),              "Shared memory: throw fair::mq::MessageBadAlloc if cannot allocate a message (retry if false).")
+        ("shm-quota",                     po::value<size_t        >()->default_value(0),                 "Shared memory: maximum bytes of managed segment buffers held by this device (0 - unlimited).")
+        ("shm-channel-quota",             po::value<vector<string>>()->multitoken()->composing(),        "Shared memory: maximum bytes of managed segment buffers allocated via a channel (and its sub-channels) and held by this device: <channel>=<bytes>, e.g. 'data=100000000'.")
+        ("shm-quota-policy",              po::value<string        >()->default_value("block"),           "Shared memory: allocation exceeding a quota: block (wait for the quota to be freed), fail (throw fair::mq::MessageBadAlloc), drop (create the message in local memory, discarded on send).")
+        ("shm-mng-segment-size",          po::value<size_t        >()->default_value(6553600),           "Shared memory: size of the management segment (in bytes), holding the session metadata. Increase for sessions with many segments/regions/devices. Only applied by the session creator.")
         ("shm-metadata-msg-size",         po::value<std::size_t   >()->default_value(0),                 "Shared memory: size of the zmq metadata message (values smaller than minimum are clamped to the minimum).")
         ("bad-alloc-max-attempts",        po::value<int           >(),                                   "Maximum number of allocation attempts before throwing fair::mq::MessageBadAlloc. -1 is infinite. There is always at least one attempt, so 0 has safe effect as 1.")
-        ("bad-alloc-attempt-interval",    po::value<int           >()->default_value(50),                "Interval between attempts if cannot allocate a message (in ms).")
+        ("bad-alloc-attempt-interval",    po::value<int           >()->default_value(50),                "Interval between attempts if cannot allocate a message (in ms). Waiting allocations are woken up as soon as memory is freed, the interval bounds the total waiting time ((attempts - 1) * interval).")
         ("shm-monitor",                   po::value<bool          >()->default_value(false),             "Shared memory: run monitor daemon.")
         ("shm-no-cleanup",                po::value<bool          >()->default_value(false),             "Shared memory: do not cleanup the memory when last device leaves.")
         ("rate",                          po::value<float         >()->default_value(0.),                "Rate for conditional run loop (Hz).")
+        ("rate-pacing",                   po::value<string        >()->default_value("adaptive"),        "Pacing of the rate limited loops: adaptive (sleep in steps of at least ~5ms, cheap but bursty at high rates), precise (sleep until the deadline of each iteration/burst, for smooth traffic at high rates).")
+        ("rate-spin",                     po::value<int           >()->default_value(0),                 "Precise pacing: busy-wait for the last microseconds before each deadline instead of sleeping (costs CPU, improves precision below the timer slack of the system).")
+        ("rate-burst",                    po::value<int           >()->default_value(1),                 "Precise pacing: number of loop iterations released together per deadline.")
         ("session",                       po::value<string        >()->default_value("default"),         "Session name.")
         ("config-key",                    po::value<string        >(),                                   "Use provided value instead of device id for fetching the configuration from JSON file.")
         ("mq-config",                     po::value<string        >(),                                   "JSON input as file.")
@@ -8,10 +8,17 @@
 #ifndef FAIR_MQ_SHMEM_COMMON_H_
 #define FAIR_MQ_SHMEM_COMMON_H_
 
+#include <algorithm> // std::min
 #include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <functional> // std::equal_to
+#include <limits> // std::numeric_limits
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/functional/hash.hpp>
 // #include <boost/interprocess/allocators/adaptive_pool.hpp>
 #include <boost/interprocess/allocators/node_allocator.hpp>
@@ -22,17 +29,24 @@
 #include <boost/interprocess/indexes/null_index.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/mem_algo/simple_seq_fit.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/unordered_map.hpp>
 #include <variant>
+#include <vector>
 
+#include <signal.h> // kill
+#include <sys/stat.h> // stat
 #include <sys/types.h>
 
+#include <fairmq/tools/Futex.h>
 #include <fairmq/tools/Strings.h>
 
 namespace fair::mq::shmem
 {
 
-static constexpr uint64_t kManagementSegmentSize = 6553600;
+static constexpr uint64_t kManagementSegmentSize = 6553600; // default, configurable via shm-mng-segment-size
 
 struct SharedMemoryError : std::runtime_error { using std::runtime_error::runtime_error; };
 
@@ -82,16 +96,31 @@ using Str            = boost::interprocess::basic_string<char, std::char_traits<
 using StrAlloc       = boost::interprocess::allocator<Str, SegmentManager>;
 using StrVector      = boost::interprocess::vector<Str, StrAlloc>;
 
-// ShmHeader stores user buffer alignment and the reference count in the following structure:
+// ShmHeader stores user buffer alignment, the reference count and the accounting info in the following structure:
 // [HdrOffset(uint16_t)][Hdr alignment][Hdr][user buffer alignment][user buffer]
 // The alignment of Hdr depends on the alignment of std::atomic and is stored in the first entry
 struct ShmHeader
 {
+    static constexpr size_t kSizeUnit = 16; // granularity of the stored full size
+    static constexpr size_t kMaxFullSize = size_t(std::numeric_limits<uint32_t>::max()) * kSizeUnit;
+    static constexpr uint16_t kBudgetBits = 11;
+    static constexpr uint16_t kBudgetMask = (1 << kBudgetBits) - 1; // also the stored value for "no budget"
+
     struct Hdr
     {
         uint16_t userOffset;
         std::atomic<uint16_t> refCount;
+        std::atomic<uint16_t> owner; // ShmAccounting slot of the holding process (ShmAccounting::kShared if held by several, kInFlight while sent, kReclaimed if reclaimed)
+        uint16_t classAndBudget; // ShmAccounting size class (upper 5 bits), ShmBudgets index charged for the buffer (lower 11 bits)
+        uint32_t creationTime; // seconds since epoch (system clock)
+        uint32_t size; // full size of the allocation, in units of kSizeUnit
+
+        uint8_t SizeClass() const { return static_cast<uint8_t>(classAndBudget >> kBudgetBits); }
+        uint16_t Budget() const { return (classAndBudget & kBudgetMask) == kBudgetMask ? 0xFFFF : (classAndBudget & kBudgetMask); }
+        size_t Size() const { return size_t(size) * kSizeUnit; }
+        void SetSize(size_t fullSize) { size = static_cast<uint32_t>(fullSize / kSizeUnit); }
     };
+    static_assert(sizeof(Hdr) == 16, "the ShmHeader is part of every allocation");
 
     static Hdr* HdrPtr(char* ptr)
     {
@@ -125,18 +154,25 @@ struct ShmHeader
         return ptr + HdrPartSize() + HdrPtr(ptr)->userOffset;
     }
 
+    static Hdr& Header(char* ptr) { return *HdrPtr(ptr); }
+
     static uint16_t RefCount(char* ptr) { return RefCountPtr(ptr).load(); }
     static uint16_t IncrementRefCount(char* ptr) { return RefCountPtr(ptr).fetch_add(1); }
     static uint16_t DecrementRefCount(char* ptr) { return RefCountPtr(ptr).fetch_sub(1); }
 
+    /// @brief round a full size up to the granularity stored in the Hdr
+    static size_t RoundSize(size_t fullSize) { return (fullSize + kSizeUnit - 1) / kSizeUnit * kSizeUnit; }
+
     static size_t FullSize(size_t size, size_t alignment)
     {
         // [HdrOffset(uint16_t)][Hdr alignment][Hdr][user buffer alignment][user buffer]
         // <--------------------------------------------------------------------------->
-        return HdrPartSize() + alignment + size;
+        return RoundSize(HdrPartSize() + alignment + size);
     }
 
-    static void Construct(char* ptr, size_t alignment)
+    /// @param fullSize full size of the allocation, a multiple of kSizeUnit (see FullSize())
+    /// @param budget ShmBudgets index charged for the buffer, 0xFFFF for none
+    static void Construct(char* ptr, size_t alignment, size_t fullSize = 0, uint16_t owner = 0xFFFF, uint8_t sizeClass = 0, uint32_t creationTime = 0, uint16_t budget = 0xFFFF)
     {
         // place the Hdr in the aligned location, fill it and store its offset to HdrOffset
 
@@ -149,10 +185,36 @@ struct ShmHeader
 
         // offset to the beginning of the user buffer, store in Hdr together with the ref count
         uint16_t userOffset = alignment - ((reinterpret_cast<uintptr_t>(ptr) + HdrPartSize()) % alignment);
-        new(ptr + sizeof(uint16_t) + hdrOffset) Hdr{ userOffset, std::atomic<uint16_t>(1) };
+        uint16_t classAndBudget = static_cast<uint16_t>((sizeClass << kBudgetBits) | std::min<uint16_t>(budget, kBudgetMask));
+        new(ptr + sizeof(uint16_t) + hdrOffset) Hdr{ userOffset, std::atomic<uint16_t>(1), std::atomic<uint16_t>(owner), classAndBudget, creationTime, static_cast<uint32_t>(fullSize / kSizeUnit) };
+    }
+
+    static void Destruct(char* ptr)
+    {
+        // leave a header that Valid() rejects
+        RefCountPtr(ptr).store(0, std::memory_order_relaxed);
+        RefCountPtr(ptr).~atomic();
     }
 
-    static void Destruct(char* ptr) { RefCountPtr(ptr).~atomic(); }
+    /// @brief whether ptr (an allocation of capacity bytes found by walking a segment) holds a constructed ShmHeader
+    /// The header carries no magic word, buffers are recognized structurally: the offsets and the size fit the
+    /// allocation and the buffer is referenced. Allocators have to clear the first two bytes of blocks they hand
+    /// out without a ShmHeader (a zero HdrOffset is never valid), as Destruct() leaves a header that fails the check.
+    static bool Valid(char* ptr, size_t capacity)
+    {
+        if (capacity < HdrPartSize()) {
+            return false;
+        }
+        uint16_t hdrOffset = 0;
+        memcpy(&hdrOffset, ptr, sizeof(hdrOffset));
+        if (hdrOffset == 0 || hdrOffset > alignof(Hdr)) {
+            return false;
+        }
+        const Hdr& hdr = *HdrPtr(ptr);
+        return hdr.refCount.load(std::memory_order_relaxed) > 0
+            && HdrPartSize() + size_t(hdr.userOffset) <= hdr.Size()
+            && hdr.Size() <= RoundSize(capacity);
+    }
 };
 
 struct MetaHeader
@@ -166,10 +228,37 @@ struct MetaHeader
     bool fManaged; // true = managed segment, false = unmanaged region
 };
 
+// multipart meta msg flag (set in the part count): the parts are blocks of a single unmanaged region,
+// described by a RegionBlocksHeader followed by one RegionBlockMeta per part (see Socket::SendRegionBlocks)
+constexpr std::size_t kRegionBlocksFlag = std::size_t(1) << (8 * sizeof(std::size_t) - 1);
+
+struct RegionBlocksHeader
+{
+    uint16_t fRegionId;
+    uint16_t fSegmentId;
+    uint32_t fReserved;
+};
+
+struct RegionBlockMeta
+{
+    uint64_t fOffset; // offset of the block from the region start
+    uint64_t fSize;
+    uint64_t fHint;
+};
+
 enum class AllocationAlgorithm : int
 {
     rbtree_best_fit,
-    simple_seq_fit
+    simple_seq_fit,
+    segregated_fit // size class free lists on top of an rbtree_best_fit segment, see SegregatedFit.h
+};
+
+// what happens to an allocation that exceeds a budget (see ShmBudgets)
+enum class QuotaPolicy : int
+{
+    block, // wait for the budget to be freed (by any process)
+    fail, // throw MessageBadAlloc
+    drop // create the message in local memory, it is discarded when sent
 };
 
 struct RegionInfo
@@ -197,11 +286,13 @@ using Uint16RegionInfoHashMap = boost::unordered_map<uint16_t, RegionInfo, boost
 
 struct SegmentInfo
 {
-    SegmentInfo(AllocationAlgorithm aa)
+    SegmentInfo(AllocationAlgorithm aa, boost::interprocess::managed_shared_memory::handle_t poolHandle = -1)
         : fAllocationAlgorithm(aa)
+        , fPoolHandle(poolHandle)
     {}
 
     AllocationAlgorithm fAllocationAlgorithm;
+    boost::interprocess::managed_shared_memory::handle_t fPoolHandle; // handle to the SegregatedFitPool in the segment (segregated_fit only)
 };
 
 struct SessionInfo
@@ -246,6 +337,566 @@ struct Heartbeat
     std::atomic<uint64_t> fCount;
 };
 
+// Wakes up allocations waiting for free memory in the managed segments (all processes of the session).
+// Waiters block on a process-shared futex on fGeneration, which every notification increments. No lock is involved,
+// a process dying while waiting or notifying cannot block the others. Deallocations only notify if fWaiters is non-zero.
+// The waiters are also counted per accounting slot (ShmAccounting::Process::fWaiting), so that those of a process that
+// died while waiting are released again (ShmAccounting::ReleaseWaiters()).
+struct FreeMemoryNotifier
+{
+    FreeMemoryNotifier()
+        : fWaiters(0)
+        , fGeneration(0)
+    {}
+
+    void Notify()
+    {
+        fGeneration.fetch_add(1, std::memory_order_acq_rel);
+        tools::FutexWakeAll(fGeneration, true);
+    }
+
+    // block while the generation equals the given one, up to the timeout (spurious wake ups possible)
+    void Wait(uint32_t generation, std::chrono::microseconds timeout) const
+    {
+        tools::FutexWait(fGeneration, generation, timeout, true);
+    }
+
+    std::atomic<uint32_t> fWaiters;
+    std::atomic<uint32_t> fGeneration; // futex word, incremented with every notification
+};
+
+// Locks of the independently accessed parts of the management segment data.
+// The session mutex (the unique_instance interprocess_mutex) only guards the session lifetime
+// (session info, device counter, monitor start). Lock order: session mutex, fSegmentsMtx, fRegionsMtx, fDebugMtx.
+// The event counter, the RegionEventLog and the FreeMemoryNotifier synchronize themselves.
+struct ManagementLocks
+{
+    boost::interprocess::interprocess_mutex fSegmentsMtx; // Uint16SegmentInfoHashMap
+    boost::interprocess::interprocess_mutex fRegionsMtx; // Uint16RegionInfoHashMap, RegionCounter
+    boost::interprocess::interprocess_mutex fDebugMtx; // Uint16MsgDebugMapHashMap, Uint16MsgCounterHashMap
+};
+
+// Always-on accounting of the managed segment buffers, in the management segment.
+// Every process (per segment it allocates in) owns a slot with per size class counters, updated with relaxed atomics
+// by the allocating process, by a receiving process taking the buffer over and by whichever process frees the buffer
+// (the owner slot, size class and creation time are stored in the ShmHeader of each buffer). A sent buffer is
+// attributed to no process (kInFlight) from the send until the receiver takes it over. A buffer received while
+// other references to it exist (copies, PUB/SUB) becomes shared and is no longer attributed to any process.
+// Outstanding buffers are additionally counted per minute of their creation in a ring of kAgeSlots minutes, buffers
+// older than the ring are counted in fOlder. The age profile is approximate (a free racing with the recycling of a ring
+// entry may be attributed to a neighbouring age).
+// The slots double as liveness records: pid, start time (to detect pid reuse) and pid namespace of the process and the
+// time of the last heartbeat. Buffers held by dead processes can be reclaimed with Monitor::ReclaimDeadBuffers().
+// Liveness can only be checked within the own pid namespace: processes of other pid namespaces (e.g. other containers
+// sharing /dev/shm) are always considered alive, their slots and buffers are never reused or reclaimed.
+struct ShmAccounting
+{
+    static constexpr uint16_t kMaxProcesses = 256;
+    static constexpr uint16_t kInFlight = 0xFFFC; // owner of a sent buffer until the receiver takes it over, never reclaimed
+    static constexpr uint16_t kReclaimed = 0xFFFD; // owner of a buffer reclaimed by the monitor, must not be taken over
+    static constexpr uint16_t kShared = 0xFFFE;
+    static constexpr uint16_t kNoSlot = 0xFFFF;
+    static constexpr size_t kNumSizeClasses = 32; // class i: up to 2^(i+7) bytes, the last one is open ended
+    static constexpr size_t kAgeSlots = 64; // minutes
+
+    struct Process
+    {
+        std::atomic<int32_t> fPid; // 0 - unused slot
+        std::atomic<uint64_t> fStartTime; // process start time (clock ticks since boot), 0 if unknown
+        std::atomic<uint64_t> fPidNamespace; // see PidNamespace(), 0 if unknown
+        std::atomic<uint32_t> fHeartbeat; // seconds since epoch
+        std::atomic<uint16_t> fSegmentId;
+        std::atomic<uint64_t> fAllocations[kNumSizeClasses]; // cumulative
+        std::atomic<uint64_t> fDeallocations[kNumSizeClasses]; // cumulative, of buffers held by this process
+        std::atomic<uint64_t> fReceived[kNumSizeClasses]; // cumulative, buffers taken over from other processes
+        std::atomic<uint64_t> fHandedOver[kNumSizeClasses]; // cumulative, buffers taken over by other processes (or shared)
+        std::atomic<uint64_t> fBytes; // outstanding
+        std::atomic<uint64_t> fPeakBytes;
+        std::atomic<uint32_t> fAgeMinute[kAgeSlots]; // creation minute (since epoch) of the buffers in fAgeCount
+        std::atomic<int64_t> fAgeCount[kAgeSlots];
+        std::atomic<int64_t> fOlder; // outstanding buffers older than the age ring
+        std::atomic<uint32_t> fWaiting; // allocations waiting for free memory (registered in FreeMemoryNotifier::fWaiters)
+
+        uint64_t Outstanding(size_t sizeClass) const
+        {
+            uint64_t in = fAllocations[sizeClass].load(std::memory_order_relaxed) + fReceived[sizeClass].load(std::memory_order_relaxed);
+            uint64_t out = fDeallocations[sizeClass].load(std::memory_order_relaxed) + fHandedOver[sizeClass].load(std::memory_order_relaxed);
+            return in > out ? in - out : 0;
+        }
+
+        uint64_t Outstanding() const
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i < kNumSizeClasses; ++i) {
+                total += Outstanding(i);
+            }
+            return total;
+        }
+
+        void Reset(int32_t pid, uint16_t segmentId)
+        {
+            for (size_t i = 0; i < kNumSizeClasses; ++i) {
+                fAllocations[i].store(0, std::memory_order_relaxed);
+                fDeallocations[i].store(0, std::memory_order_relaxed);
+                fReceived[i].store(0, std::memory_order_relaxed);
+                fHandedOver[i].store(0, std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < kAgeSlots; ++i) {
+                fAgeMinute[i].store(0, std::memory_order_relaxed);
+                fAgeCount[i].store(0, std::memory_order_relaxed);
+            }
+            fBytes.store(0, std::memory_order_relaxed);
+            fPeakBytes.store(0, std::memory_order_relaxed);
+            fOlder.store(0, std::memory_order_relaxed);
+            fSegmentId.store(segmentId, std::memory_order_relaxed);
+            fStartTime.store(pid > 0 ? ProcessStartTime(pid) : 0, std::memory_order_relaxed);
+            fPidNamespace.store(pid > 0 ? PidNamespace() : 0, std::memory_order_relaxed);
+            fHeartbeat.store(pid > 0 ? Now() : 0, std::memory_order_relaxed);
+            fPid.store(pid, std::memory_order_release);
+        }
+    };
+
+    ShmAccounting()
+    {
+        for (auto& p : fProcesses) {
+            p.Reset(0, 0);
+            p.fWaiting.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief size class of an allocation of the given (full) size
+    static uint8_t SizeClass(size_t size)
+    {
+        if (size <= 128) {
+            return 0;
+        }
+        size_t log2 = 64 - __builtin_clzll(size - 1); // ceil(log2(size))
+        return static_cast<uint8_t>(std::min(log2 - 7, kNumSizeClasses - 1));
+    }
+
+    /// @brief upper bound of the given size class (in bytes), 0 for the last (open ended) class
+    static size_t SizeClassLimit(size_t sizeClass) { return sizeClass + 1 < kNumSizeClasses ? (size_t(1) << (sizeClass + 7)) : 0; }
+
+    static uint32_t Now() { return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()); }
+
+    static bool Alive(int32_t pid) { return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH); }
+
+    /// @brief identifier (inode of /proc/self/ns/pid) of the pid namespace of the calling process, 0 if unknown
+    static uint64_t PidNamespace()
+    {
+        static const uint64_t pidNamespace = [] {
+            struct stat st;
+            return ::stat("/proc/self/ns/pid", &st) == 0 ? static_cast<uint64_t>(st.st_ino) : uint64_t(0);
+        }();
+        return pidNamespace;
+    }
+
+    /// @brief start time of the given process in clock ticks since boot (from /proc), 0 if unknown
+    static uint64_t ProcessStartTime(int32_t pid)
+    {
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        std::string line;
+        if (!std::getline(stat, line)) {
+            return 0;
+        }
+        // the command name (field 2) may contain spaces, the fields after it are separated by single spaces
+        size_t pos = line.rfind(')');
+        if (pos == std::string::npos) {
+            return 0;
+        }
+        std::istringstream fields(line.substr(pos + 1));
+        std::string field;
+        for (int i = 3; i < 22 && fields >> field; ++i) {} // skip to field 22 (starttime)
+        uint64_t startTime = 0;
+        fields >> startTime;
+        return startTime;
+    }
+
+    /// @brief whether the process with the given pid, start time and pid namespace (0 if unknown) is alive, and is not
+    /// another process that reuses the pid. Processes of another pid namespace cannot be checked and are reported alive.
+    static bool Alive(int32_t pid, uint64_t startTime, uint64_t pidNamespace)
+    {
+        if (pidNamespace != 0 && pidNamespace != PidNamespace()) {
+            return true;
+        }
+        if (!Alive(pid)) {
+            return false;
+        }
+        if (startTime == 0) {
+            return true;
+        }
+        uint64_t current = ProcessStartTime(pid);
+        return current == 0 || current == startTime;
+    }
+
+    /// @brief whether the process of the given slot is alive (and is not another process that reuses the pid)
+    bool SlotAlive(uint16_t slot) const
+    {
+        const Process& p = fProcesses[slot];
+        return Alive(p.fPid.load(std::memory_order_acquire), p.fStartTime.load(std::memory_order_relaxed), p.fPidNamespace.load(std::memory_order_relaxed));
+    }
+
+    /// @brief find or claim the slot of the given process for allocations in the given segment
+    /// Slots of dead processes without outstanding buffers are reused, after releasing their waiters from the notifier.
+    /// @return slot index, kNoSlot if all slots are taken
+    uint16_t Register(int32_t pid, uint16_t segmentId, FreeMemoryNotifier& notifier)
+    {
+        const uint64_t startTime = ProcessStartTime(pid);
+        for (uint16_t i = 0; i < kMaxProcesses; ++i) {
+            if (fProcesses[i].fPid.load(std::memory_order_acquire) == pid
+             && fProcesses[i].fSegmentId.load(std::memory_order_relaxed) == segmentId
+             && fProcesses[i].fStartTime.load(std::memory_order_relaxed) == startTime // not a slot of a dead process with the same pid
+             && fProcesses[i].fPidNamespace.load(std::memory_order_relaxed) == PidNamespace()) { // nor of a process with the same pid in another namespace
+                return i;
+            }
+        }
+        for (uint16_t i = 0; i < kMaxProcesses; ++i) {
+            int32_t current = fProcesses[i].fPid.load(std::memory_order_acquire);
+            if (current == 0 || (current > 0 && !SlotAlive(i) && fProcesses[i].Outstanding() == 0)) {
+                // claim with a placeholder, so that no other process resets the slot concurrently
+                if (fProcesses[i].fPid.compare_exchange_strong(current, -1, std::memory_order_acq_rel)) {
+                    ReleaseWaiters(i, notifier);
+                    fProcesses[i].Reset(pid, segmentId);
+                    return i;
+                }
+            }
+        }
+        return kNoSlot;
+    }
+
+    /// @brief register an allocation of the given slot (kNoSlot: not accounted) waiting for free memory
+    void AddWaiter(uint16_t slot, FreeMemoryNotifier& notifier)
+    {
+        if (slot < kMaxProcesses) {
+            fProcesses[slot].fWaiting.fetch_add(1, std::memory_order_seq_cst);
+        }
+        notifier.fWaiters.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    void RemoveWaiter(uint16_t slot, FreeMemoryNotifier& notifier)
+    {
+        notifier.fWaiters.fetch_sub(1, std::memory_order_seq_cst);
+        if (slot < kMaxProcesses) {
+            fProcesses[slot].fWaiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief remove the waiters of the (dead) process of the given slot from the notifier
+    void ReleaseWaiters(uint16_t slot, FreeMemoryNotifier& notifier)
+    {
+        uint32_t waiting = fProcesses[slot].fWaiting.exchange(0, std::memory_order_relaxed);
+        uint32_t current = notifier.fWaiters.load(std::memory_order_relaxed);
+        // never below zero (the process may have died between the two increments of AddWaiter())
+        while (waiting > 0 && !notifier.fWaiters.compare_exchange_weak(current, current - std::min(current, waiting))) {}
+    }
+
+    void OnAllocate(uint16_t slot, uint8_t sizeClass, size_t size, uint32_t creationTime)
+    {
+        if (slot >= kMaxProcesses) {
+            return;
+        }
+        Process& p = fProcesses[slot];
+        p.fAllocations[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        Add(p, size, creationTime);
+    }
+
+    void OnDeallocate(uint16_t slot, uint8_t sizeClass, size_t size, uint32_t creationTime)
+    {
+        if (slot >= kMaxProcesses) {
+            return;
+        }
+        Process& p = fProcesses[slot];
+        p.fDeallocations[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        Remove(p, size, creationTime);
+    }
+
+    /// @brief move a buffer from one slot to another (either may be kShared/kInFlight/kNoSlot/kReclaimed, i.e. not accounted)
+    void OnTransfer(uint16_t from, uint16_t to, uint8_t sizeClass, size_t size, uint32_t creationTime)
+    {
+        if (from < kMaxProcesses) {
+            fProcesses[from].fHandedOver[sizeClass].fetch_add(1, std::memory_order_relaxed);
+            Remove(fProcesses[from], size, creationTime);
+        }
+        if (to < kMaxProcesses) {
+            fProcesses[to].fReceived[sizeClass].fetch_add(1, std::memory_order_relaxed);
+            Add(fProcesses[to], size, creationTime);
+        }
+    }
+
+    void Beat(uint16_t slot)
+    {
+        if (slot < kMaxProcesses) {
+            fProcesses[slot].fHeartbeat.store(Now(), std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief account for a buffer changing its size in place (Message::Resize)
+    void OnResize(uint16_t slot, size_t oldSize, size_t newSize)
+    {
+        if (slot >= kMaxProcesses) {
+            return;
+        }
+        if (newSize > oldSize) {
+            AddBytes(fProcesses[slot], newSize - oldSize);
+        } else {
+            fProcesses[slot].fBytes.fetch_sub(oldSize - newSize, std::memory_order_relaxed);
+        }
+    }
+
+    Process fProcesses[kMaxProcesses];
+
+  private:
+    static void AddBytes(Process& p, size_t size)
+    {
+        uint64_t bytes = p.fBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t peak = p.fPeakBytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !p.fPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+    }
+
+    static void Add(Process& p, size_t size, uint32_t creationTime)
+    {
+        AddBytes(p, size);
+
+        uint32_t minute = creationTime / 60;
+        auto& ageMinute = p.fAgeMinute[minute % kAgeSlots];
+        uint32_t current = ageMinute.load(std::memory_order_relaxed);
+        if (current < minute && ageMinute.compare_exchange_strong(current, minute, std::memory_order_relaxed)) {
+            // recycle the ring entry, its remaining buffers are older than the ring
+            p.fOlder.fetch_add(p.fAgeCount[minute % kAgeSlots].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        p.fAgeCount[minute % kAgeSlots].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void Remove(Process& p, size_t size, uint32_t creationTime)
+    {
+        p.fBytes.fetch_sub(size, std::memory_order_relaxed);
+
+        uint32_t minute = creationTime / 60;
+        if (p.fAgeMinute[minute % kAgeSlots].load(std::memory_order_relaxed) == minute) {
+            p.fAgeCount[minute % kAgeSlots].fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            p.fOlder.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Byte budgets (quotas) of the managed segment allocations, in the management segment.
+// A process can have a budget for all its allocations (the device budget) and budgets for the allocations made via
+// specific channels (by channel name, shared by its sub-channels). A buffer is charged to its channel budget (or the
+// device budget if the channel has none) when allocated, a channel budget charges its parent device budget along. The
+// budget index is stored in the ShmHeader, the buffer is discharged by whichever process frees it. Charging is an atomic add,
+// undone if the limit is exceeded, without locks: concurrent allocations may be rejected while another one is being
+// undone, but a budget never stays above its limit. Budgets of exited processes are reused once fully discharged.
+struct ShmBudgets
+{
+    static constexpr uint16_t kMaxBudgets = 1024;
+    static constexpr uint16_t kNoBudget = 0xFFFF;
+    static constexpr size_t kMaxNameLength = 64;
+    static_assert(kMaxBudgets < ShmHeader::kBudgetMask, "budget indices are stored in the ShmHeader");
+
+    struct Budget
+    {
+        std::atomic<int32_t> fPid; // 0 - unused, -1 - being claimed
+        std::atomic<uint64_t> fStartTime; // start time of the process (see ShmAccounting::ProcessStartTime), to detect pid reuse
+        std::atomic<uint64_t> fPidNamespace; // see ShmAccounting::PidNamespace()
+        std::atomic<uint16_t> fParent; // budget charged together with this one (the device budget of a channel budget), kNoBudget if none
+        char fName[kMaxNameLength]; // channel name, empty for the device budget
+        std::atomic<uint64_t> fLimit; // bytes
+        std::atomic<uint64_t> fBytes; // charged bytes
+        std::atomic<uint64_t> fPeakBytes;
+        std::atomic<uint64_t> fBlocked; // allocations that waited for the budget
+        std::atomic<uint64_t> fFailed; // allocations that failed because of the budget
+        std::atomic<uint64_t> fDropped; // messages dropped because of the budget
+    };
+
+    ShmBudgets()
+    {
+        for (auto& b : fBudgets) {
+            b.fPid.store(0, std::memory_order_relaxed);
+            b.fStartTime.store(0, std::memory_order_relaxed);
+            b.fPidNamespace.store(0, std::memory_order_relaxed);
+            b.fParent.store(kNoBudget, std::memory_order_relaxed);
+            b.fName[0] = '\0';
+            b.fLimit.store(0, std::memory_order_relaxed);
+            Reset(b);
+        }
+    }
+
+    /// @brief find or claim the budget of the given process and channel (empty: device budget) and set its limit
+    /// @param parent budget to charge along with this one (the device budget for a channel budget), kNoBudget if none
+    /// @return budget index, kNoBudget if all budgets are taken
+    uint16_t Register(int32_t pid, const std::string& name, uint64_t limit, uint16_t parent = kNoBudget)
+    {
+        const std::string truncated = name.substr(0, kMaxNameLength - 1);
+        const uint64_t startTime = ShmAccounting::ProcessStartTime(pid);
+        const uint64_t pidNamespace = ShmAccounting::PidNamespace();
+        for (uint16_t i = 0; i < kMaxBudgets; ++i) {
+            if (fBudgets[i].fPid.load(std::memory_order_acquire) == pid
+             && fBudgets[i].fStartTime.load(std::memory_order_relaxed) == startTime // not a budget of a dead process with the same pid
+             && fBudgets[i].fPidNamespace.load(std::memory_order_relaxed) == pidNamespace
+             && truncated == fBudgets[i].fName) {
+                fBudgets[i].fLimit.store(limit, std::memory_order_relaxed);
+                return i;
+            }
+        }
+        for (uint16_t i = 0; i < kMaxBudgets; ++i) {
+            Budget& b = fBudgets[i];
+            int32_t current = b.fPid.load(std::memory_order_acquire);
+            if (current == 0 || (current > 0 && !Alive(i) && b.fBytes.load(std::memory_order_relaxed) == 0)) {
+                if (b.fPid.compare_exchange_strong(current, -1, std::memory_order_acq_rel)) {
+                    truncated.copy(b.fName, kMaxNameLength - 1);
+                    b.fName[truncated.size()] = '\0';
+                    b.fLimit.store(limit, std::memory_order_relaxed);
+                    b.fStartTime.store(startTime, std::memory_order_relaxed);
+                    b.fPidNamespace.store(pidNamespace, std::memory_order_relaxed);
+                    b.fParent.store(parent, std::memory_order_relaxed);
+                    Reset(b);
+                    b.fPid.store(pid, std::memory_order_release);
+                    return i;
+                }
+            }
+        }
+        return kNoBudget;
+    }
+
+    /// @brief whether the process owning the given budget is alive (and is not another process that reuses the pid)
+    bool Alive(uint16_t budget) const
+    {
+        const Budget& b = fBudgets[budget];
+        return ShmAccounting::Alive(b.fPid.load(std::memory_order_acquire), b.fStartTime.load(std::memory_order_relaxed), b.fPidNamespace.load(std::memory_order_relaxed));
+    }
+
+    /// @brief charge size bytes to the budget and to its parent
+    /// @return the exceeded budget (nothing charged then), kNoBudget if charged
+    uint16_t Charge(uint16_t budget, size_t size)
+    {
+        if (budget >= kMaxBudgets) {
+            return kNoBudget;
+        }
+        const uint16_t parent = fBudgets[budget].fParent.load(std::memory_order_relaxed);
+        if (!TryCharge(parent, size)) {
+            return parent;
+        }
+        if (!TryCharge(budget, size)) {
+            DischargeOne(parent, size);
+            return budget;
+        }
+        return kNoBudget;
+    }
+
+    /// @brief discharge size bytes from the budget and from its parent
+    void Discharge(uint16_t budget, size_t size)
+    {
+        if (budget < kMaxBudgets) {
+            DischargeOne(fBudgets[budget].fParent.load(std::memory_order_relaxed), size);
+            DischargeOne(budget, size);
+        }
+    }
+
+    Budget fBudgets[kMaxBudgets];
+
+  private:
+    // charge size bytes to the budget only, false (and nothing charged) if its limit would be exceeded
+    bool TryCharge(uint16_t budget, size_t size)
+    {
+        if (budget >= kMaxBudgets) {
+            return true;
+        }
+        Budget& b = fBudgets[budget];
+        uint64_t bytes = b.fBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        if (bytes > b.fLimit.load(std::memory_order_relaxed)) {
+            b.fBytes.fetch_sub(size, std::memory_order_relaxed);
+            return false;
+        }
+        uint64_t peak = b.fPeakBytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !b.fPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+        return true;
+    }
+
+    void DischargeOne(uint16_t budget, size_t size)
+    {
+        if (budget < kMaxBudgets) {
+            fBudgets[budget].fBytes.fetch_sub(size, std::memory_order_relaxed);
+        }
+    }
+
+    static void Reset(Budget& b)
+    {
+        b.fBytes.store(0, std::memory_order_relaxed);
+        b.fPeakBytes.store(0, std::memory_order_relaxed);
+        b.fBlocked.store(0, std::memory_order_relaxed);
+        b.fFailed.store(0, std::memory_order_relaxed);
+        b.fDropped.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Append-only ring of region/segment creation and destruction events of the session, in the management segment.
+// Subscribers keep their own read position and wait on fCV, only touching fMtx (never the global management mutex)
+// and only processing new events. A subscriber falling behind by more than kCapacity events has to rescan.
+struct RegionEventLog
+{
+    static constexpr uint64_t kCapacity = 1024;
+
+    struct Entry
+    {
+        uint64_t fSeq;
+        uint16_t fId;
+        bool fManaged;
+        bool fDestroyed;
+    };
+
+    RegionEventLog()
+        : fNext(0)
+    {}
+
+    void Append(uint16_t id, bool managed, bool destroyed)
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fMtx);
+        fEntries[fNext % kCapacity] = Entry{ fNext, id, managed, destroyed };
+        ++fNext;
+        fCV.notify_all();
+    }
+
+    /// @brief sequence number of the next event
+    uint64_t Next()
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fMtx);
+        return fNext;
+    }
+
+    /// @brief wait until there are events at or after position, the deadline passes, or stop() returns true after Wake()
+    /// @param position in: first event to read, out: position after the last read event
+    /// @param out receives the new events
+    /// @return false if events have been overwritten before they could be read (subscriber needs to rescan)
+    template<typename Stop>
+    bool Read(uint64_t& position, std::vector<Entry>& out, const boost::posix_time::ptime& deadline, Stop&& stop)
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fMtx);
+        fCV.timed_wait(lock, deadline, [&] { return fNext != position || stop(); });
+        bool complete = true;
+        if (fNext - position > kCapacity) {
+            complete = false;
+            position = fNext - kCapacity;
+        }
+        for (; position < fNext; ++position) {
+            out.push_back(fEntries[position % kCapacity]);
+        }
+        return complete;
+    }
+
+    /// @brief wake up all waiting readers
+    void Wake()
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fMtx);
+        fCV.notify_all();
+    }
+
+    boost::interprocess::interprocess_mutex fMtx;
+    boost::interprocess::interprocess_condition fCV;
+    uint64_t fNext; // sequence number of the next event
+    Entry fEntries[kCapacity];
+};
+
 struct RegionCounter
 {
     RegionCounter(uint16_t c)
@@ -338,6 +989,25 @@ struct SegmentBufferShrink
     mutable char* local_ptr;
 };
 
+struct SegmentBufferExpand
+{
+    SegmentBufferExpand(const size_t _new_size, char* _local_ptr)
+        : new_size(_new_size)
+        , local_ptr(_local_ptr)
+    {}
+
+    // returns local_ptr if the buffer could be expanded forward in place to at least new_size, nullptr otherwise
+    template<typename S>
+    char* operator()(S& s) const
+    {
+        boost::interprocess::managed_shared_memory::size_type received_size = new_size;
+        return s.template allocation_command<char>(boost::interprocess::expand_fwd | boost::interprocess::nothrow_allocation, new_size, received_size, local_ptr);
+    }
+
+    const size_t new_size;
+    mutable char* local_ptr;
+};
+
 } // namespace fair::mq::shmem
 
 #endif /* FAIR_MQ_SHMEM_COMMON_H_ */
@@ -11,14 +11,19 @@
 
 #include "Common.h"
 #include "Monitor.h"
+#include "Prefault.h"
+#include "SegregatedFit.h"
 #include "UnmanagedRegion.h"
 #include <fairmq/Message.h>
 #include <fairmq/ProgOptions.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
+#include <fairmq/tools/Trace.h>
 #include <fairmq/Transports.h>
 
 #include <fairlogger/Logger.h>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_condition.hpp>
@@ -33,7 +38,10 @@
 #include <cstring> // memcpy
 #include <memory> // make_unique
 #include <mutex>
+#include <new> // std::nothrow
+#include <optional>
 #include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -53,15 +61,24 @@ namespace fair::mq::shmem
 
 class Manager
 {
+    using SegmentVariant = std::variant<RBTreeBestFitSegment, SimpleSeqFitSegment>;
+
   public:
     Manager(const std::string& sessionName, size_t size, const ProgOptions* config)
         : fShmId64(config ? config->GetProperty<uint64_t>("shmid", makeShmIdUint64(sessionName)) : makeShmIdUint64(sessionName))
         , fShmId(makeShmIdStr(fShmId64))
         , fSegmentId(config ? config->GetProperty<uint16_t>("shm-segment-id", 0) : 0)
-        , fManagementSegment(boost::interprocess::open_or_create, MakeShmName(fShmId, "mng").c_str(), kManagementSegmentSize)
+        , fManagementSegment(boost::interprocess::open_or_create, MakeShmName(fShmId, "mng").c_str(), config ? config->GetProperty<size_t>("shm-mng-segment-size", kManagementSegmentSize) : kManagementSegmentSize)
         , fShmVoidAlloc(fManagementSegment.get_segment_manager())
         , fShmMtx(fManagementSegment.find_or_construct<boost::interprocess::interprocess_mutex>(boost::interprocess::unique_instance)())
-        , fNumObservedEvents(0)
+        , fLocks(fManagementSegment.find_or_construct<ManagementLocks>(boost::interprocess::unique_instance)())
+        , fFreeMemoryNotifier(fManagementSegment.find_or_construct<FreeMemoryNotifier>(boost::interprocess::unique_instance)())
+        , fRegionEventLog(fManagementSegment.find_or_construct<RegionEventLog>(boost::interprocess::unique_instance)())
+        , fAccounting(fManagementSegment.find_or_construct<ShmAccounting>(boost::interprocess::unique_instance)())
+        , fAccountingSlot(ShmAccounting::kNoSlot)
+        , fBudgets(fManagementSegment.find_or_construct<ShmBudgets>(boost::interprocess::unique_instance)())
+        , fDeviceBudget(ShmBudgets::kNoBudget)
+        , fQuotaPolicy(ParseQuotaPolicy(config ? config->GetProperty<std::string>("shm-quota-policy", "block") : "block"))
         , fDeviceCounter(nullptr)
         , fEventCounter(nullptr)
         , fShmSegments(nullptr)
@@ -79,6 +96,8 @@ class Manager
         , fBadAllocAttemptIntervalInMs(config ? config->GetProperty<int>("bad-alloc-attempt-interval", 50) : 50)
         , fNoCleanup(config ? config->GetProperty<bool>("shm-no-cleanup", false) : false)
         , fMetadataMsgSize(config ? config->GetProperty<std::size_t>("shm-metadata-msg-size", 0) : 0)
+        , fHousekeepingPlacement(tools::GetThreadPlacement(config, "housekeeping"))
+        , fPrefaultConfig(GetPrefaultConfig(config))
     {
         using namespace boost::interprocess;
 
@@ -100,6 +119,7 @@ class Manager
         bool mlockSegmentOnCreation = false;
         bool zeroSegment = false;
         bool zeroSegmentOnCreation = false;
+        bool prefaultSegment = false;
         bool autolaunchMonitor = false;
         std::string allocationAlgorithm("rbtree_best_fit");
         if (config) {
@@ -107,6 +127,7 @@ class Manager
             mlockSegmentOnCreation = config->GetProperty<bool>("shm-mlock-segment-on-creation", mlockSegmentOnCreation);
             zeroSegment = config->GetProperty<bool>("shm-zero-segment", zeroSegment);
             zeroSegmentOnCreation = config->GetProperty<bool>("shm-zero-segment-on-creation", zeroSegmentOnCreation);
+            prefaultSegment = config->GetProperty<bool>("shm-prefault-segment", prefaultSegment);
             autolaunchMonitor = config->GetProperty<bool>("shm-monitor", autolaunchMonitor);
             allocationAlgorithm = config->GetProperty<std::string>("shm-allocation", allocationAlgorithm);
         } else {
@@ -158,34 +179,52 @@ class Manager
             bool createdSegment = false;
 
             try {
+                tools::TraceSpan span("shmem: create/open managed segment", "transport");
+                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> segmentsLock(fLocks->fSegmentsMtx);
                 std::string segmentName = MakeShmName(fShmId, "m", fSegmentId);
                 auto it = fShmSegments->find(fSegmentId);
                 if (it == fShmSegments->end()) {
                     // no segment with given id exists, creating
                     if (allocationAlgorithm == "rbtree_best_fit") {
-                        fSegments.emplace(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size));
+                        AddSegment(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size));
                         fShmSegments->emplace(fSegmentId, AllocationAlgorithm::rbtree_best_fit);
                     } else if (allocationAlgorithm == "simple_seq_fit") {
-                        fSegments.emplace(fSegmentId, SimpleSeqFitSegment(open_or_create, segmentName.c_str(), size));
+                        AddSegment(fSegmentId, SimpleSeqFitSegment(open_or_create, segmentName.c_str(), size));
                         fShmSegments->emplace(fSegmentId, AllocationAlgorithm::simple_seq_fit);
+                    } else if (allocationAlgorithm == "segregated_fit") {
+                        auto& segment = std::get<RBTreeBestFitSegment>(AddSegment(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size)));
+                        SegregatedFitPool* pool = SegregatedFitPool::Create(segment);
+                        AddPool(fSegmentId, pool);
+                        fShmSegments->emplace(fSegmentId, SegmentInfo(AllocationAlgorithm::segregated_fit, segment.get_handle_from_address(pool)));
                     }
                     if (mlockSegmentOnCreation) {
                         MlockSegment(fSegmentId);
                     }
                     if (zeroSegmentOnCreation) {
-                        ZeroSegment(fSegmentId);
+                        ZeroSegment(fSegmentId, true);
                     }
                     createdSegment = true;
                 } else {
                     // found segment with the given id, opening
                     if (it->second.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit) {
-                        fSegments.emplace(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size));
+                        AddSegment(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size));
                         if (allocationAlgorithm != "rbtree_best_fit") {
                             LOG(warn) << "Allocation algorithm of the opened segment is rbtree_best_fit, but requested is " << allocationAlgorithm << ". Ignoring requested setting.";
                             allocationAlgorithm = "rbtree_best_fit";
                         }
+                    } else if (it->second.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                        if (it->second.fPoolHandle == -1) {
+                            // registered, but the creator has not (yet) placed the pool into the segment, e.g. because it crashed while creating it
+                            throw TransportError(tools::ToString("Shared memory segment '", segmentName, "' uses segregated_fit, but has no pool (incompletely created segment)"));
+                        }
+                        auto& segment = std::get<RBTreeBestFitSegment>(AddSegment(fSegmentId, RBTreeBestFitSegment(open_or_create, segmentName.c_str(), size)));
+                        AddPool(fSegmentId, static_cast<SegregatedFitPool*>(segment.get_address_from_handle(it->second.fPoolHandle)));
+                        if (allocationAlgorithm != "segregated_fit") {
+                            LOG(warn) << "Allocation algorithm of the opened segment is segregated_fit, but requested is " << allocationAlgorithm << ". Ignoring requested setting.";
+                            allocationAlgorithm = "segregated_fit";
+                        }
                     } else {
-                        fSegments.emplace(fSegmentId, SimpleSeqFitSegment(open_or_create, segmentName.c_str(), size));
+                        AddSegment(fSegmentId, SimpleSeqFitSegment(open_or_create, segmentName.c_str(), size));
                         if (allocationAlgorithm != "simple_seq_fit") {
                             LOG(warn) << "Allocation algorithm of the opened segment is simple_seq_fit, but requested is " << allocationAlgorithm << ". Ignoring requested setting.";
                             allocationAlgorithm = "simple_seq_fit";
@@ -193,23 +232,37 @@ class Manager
                     }
                 }
                 LOG(debug) << (createdSegment ? "Created" : "Opened") << " managed shared memory segment " << "fmq_" << fShmId << "_m_" << fSegmentId
-                    << ". Size: " << std::visit([](auto& s) { return s.get_size(); }, fSegments.at(fSegmentId)) << " bytes."
-                    << " Available: " << std::visit([](auto& s) { return s.get_free_memory(); }, fSegments.at(fSegmentId)) << " bytes."
+                    << ". Size: " << std::visit([](auto& s) { return s.get_size(); }, SegmentAt(fSegmentId)) << " bytes."
+                    << " Available: " << std::visit([](auto& s) { return s.get_free_memory(); }, SegmentAt(fSegmentId)) << " bytes."
                     << " Allocation algorithm: " << allocationAlgorithm;
             } catch (interprocess_exception& bie) {
                 LOG(error) << "Failed to create/open shared memory segment '" << "fmq_" << fShmId << "_m_" << fSegmentId << "': " << bie.what();
                 throw TransportError(tools::ToString("Failed to create/open shared memory segment '", "fmq_", fShmId, "_m_", fSegmentId, "': ", bie.what()));
             }
 
+            fPool = FindPool(fSegmentId);
+
+            if (prefaultSegment && !mlockSegment) {
+                PrefaultSegment(fSegmentId);
+            }
             if (mlockSegment) {
                 MlockSegment(fSegmentId);
             }
             if (zeroSegment) {
-                ZeroSegment(fSegmentId);
+                ZeroSegment(fSegmentId, false);
+            }
+
+            fAccountingSlot = fAccounting->Register(getpid(), fSegmentId, *fFreeMemoryNotifier);
+            if (fAccountingSlot == ShmAccounting::kNoSlot) {
+                LOG(warn) << "shmem: accounting table is full (" << ShmAccounting::kMaxProcesses << " processes), allocations of this process will not be accounted for";
+            }
+            if (config) {
+                RegisterBudgets(*config);
             }
 
             if (createdSegment) {
                 (fEventCounter->fCount)++;
+                fRegionEventLog->Append(fSegmentId, true, false);
             }
 
 #ifdef FAIRMQ_DEBUG_MODE
@@ -229,19 +282,58 @@ class Manager
     Manager& operator=(const Manager&) = delete;
     Manager& operator=(Manager&&) = delete;
 
-    void ZeroSegment(uint16_t id)
+    // zero the free memory of the segment
+    // unused: the segment has just been created and is not used by other processes yet (still under fSegmentsMtx). Its free memory is then
+    // allocated (largest blocks first, down to a page), zeroed in parallel and freed again, leaving only the allocator
+    // block headers. Otherwise the allocator zeroes it under its lock (zero_free_memory(), single threaded), so that the
+    // allocations of other processes do not fail meanwhile.
+    void ZeroSegment(uint16_t id, bool unused)
     {
+        tools::TraceSpan span("shmem: zero managed segment", "transport");
         LOG(debug) << "Zeroing the managed segment free memory...";
-        std::visit([](auto& s) { return s.zero_free_memory(); }, fSegments.at(id));
+        std::visit([&](auto& s) {
+            if (!unused) {
+                s.zero_free_memory();
+                return;
+            }
+            std::vector<prefault::Range> ranges;
+            for (size_t size = s.get_free_memory(); size >= 4096;) {
+                if (void* ptr = s.allocate(size, std::nothrow); ptr) {
+                    ranges.push_back(prefault::Range{static_cast<char*>(ptr), size});
+                    size = std::min(size, s.get_free_memory());
+                } else {
+                    size /= 2;
+                }
+            }
+            ZeroMemory(ranges, WithProgressLog(fPrefaultConfig, "Zeroing the managed segment"));
+            for (const auto& range : ranges) {
+                s.deallocate(range.fData);
+            }
+        }, SegmentAt(id));
         LOG(debug) << "Successfully zeroed the managed segment free memory.";
     }
 
+    void PrefaultSegment(uint16_t id)
+    {
+        tools::TraceSpan span("shmem: prefault managed segment", "transport");
+        LOG(debug) << "Prefaulting the managed segment memory pages...";
+        PrefaultMemory(std::visit([](auto& s) { return s.get_address(); }, SegmentAt(id)),
+                       std::visit([](auto& s) { return s.get_size(); }, SegmentAt(id)),
+                       WithProgressLog(fPrefaultConfig, "Prefaulting the managed segment"));
+        LOG(debug) << "Successfully prefaulted the managed segment memory pages.";
+    }
+
     void MlockSegment(uint16_t id)
     {
+        tools::TraceSpan span("shmem: mlock managed segment", "transport");
+        if (fPrefaultConfig.threads != 1) {
+            // mlock faults the pages in sequentially, prefault them in parallel first
+            PrefaultSegment(id);
+        }
         LOG(debug) << "Locking the managed segment memory pages...";
         if (mlock(
-                std::visit([](auto& s) { return s.get_address(); }, fSegments.at(id)),
-                std::visit([](auto& s) { return s.get_size(); }, fSegments.at(id))) == -1) {
+                std::visit([](auto& s) { return s.get_address(); }, SegmentAt(id)),
+                std::visit([](auto& s) { return s.get_size(); }, SegmentAt(id))) == -1) {
             LOG(error) << "Could not lock the managed segment memory. Code: " << errno << ", reason: " << strerror(errno);
             throw TransportError(tools::ToString("Could not lock the managed segment memory: ", strerror(errno)));
         }
@@ -280,7 +372,12 @@ class Manager
         }
     }
 
-    void Interrupt() { fInterrupted.store(true); }
+    void Interrupt()
+    {
+        fInterrupted.store(true);
+        // wake up allocations waiting for free memory
+        fFreeMemoryNotifier->Notify();
+    }
     void Resume() { fInterrupted.store(false); }
     void Reset()
     {
@@ -304,7 +401,7 @@ class Manager
             std::pair<UnmanagedRegion*, uint16_t> result;
 
             {
-                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> shmLock(*fShmMtx);
+                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> regionsLock(fLocks->fRegionsMtx);
 
                 if (!cfg.id.has_value()) {
                     RegionCounter* rc = fManagementSegment.find<RegionCounter>(unique_instance).first;
@@ -345,7 +442,7 @@ class Manager
                         cfg.rcSegmentSize = info->second.fRCSegmentSize;
                     }
 
-                    auto res = fRegions.emplace(id, std::make_unique<UnmanagedRegion>(fShmId, size, true, cfg));
+                    auto res = fRegions.emplace(id, std::make_unique<UnmanagedRegion>(fShmId, size, true, cfg, fPrefaultConfig, fManagementSegment.get_size()));
                     region = res.first->second.get();
                 }
                 // LOG(debug) << "Created region with id '" << id << "', path: '" << cfg.path << "', flags: '" << cfg.creationFlags << "'";
@@ -354,8 +451,8 @@ class Manager
                 if (callback || bulkCallback) {
                     region->SetCallbacks(callback, bulkCallback);
                     region->InitializeQueues();
-                    region->StartAckSender();
-                    region->StartAckReceiver();
+                    region->StartAckSender(fHousekeepingPlacement);
+                    region->StartAckReceiver(fHousekeepingPlacement);
                 }
                 result.first = region;
                 result.second = id;
@@ -407,7 +504,7 @@ class Manager
             RegionConfig cfg;
             // get region info
             {
-                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> shmLock(*fShmMtx);
+                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> regionsLock(fLocks->fRegionsMtx);
                 RegionInfo regionInfo = fShmRegions->at(id);
                 cfg.id = id;
                 cfg.creationFlags = regionInfo.fCreationFlags;
@@ -418,7 +515,7 @@ class Manager
 
             auto r = fRegions.emplace(id, std::make_unique<UnmanagedRegion>(fShmId, 0, false, std::move(cfg)));
             r.first->second->InitializeQueues();
-            r.first->second->StartAckSender();
+            r.first->second->StartAckSender(fHousekeepingPlacement);
             return r.first->second.get();
         } catch (std::out_of_range& oor) {
             LOG(error) << "Could not get remote region with id '" << id << "'. Does the region creator run with the same session id?";
@@ -433,13 +530,14 @@ class Manager
     void RemoveRegion(uint16_t id)
     {
         try {
-            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> shmLock(*fShmMtx);
+            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> regionsLock(fLocks->fRegionsMtx);
             std::lock_guard<std::mutex> lock(fLocalRegionsMtx);
             fRegions.at(id)->StopAcks();
             {
                 if (fRegions.at(id)->RemoveOnDestruction()) {
                     fShmRegions->at(id).fDestroyed = true;
                     (fEventCounter->fCount)++;
+                    fRegionEventLog->Append(id, false, true);
                 }
                 fRegions.erase(id);
             }
@@ -454,26 +552,33 @@ class Manager
         std::vector<fair::mq::RegionInfo> result;
         std::map<uint64_t, RegionConfig> regionCfgs;
 
+        std::vector<uint16_t> segmentIds;
         {
-            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> shmLock(*fShmMtx);
-
+            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> segmentsLock(fLocks->fSegmentsMtx);
             for (const auto& [segmentId, segmentInfo] : *fShmSegments) {
-                // make sure any segments in the session are found
-                GetSegment(segmentId);
-                try {
-                    fair::mq::RegionInfo info;
-                    info.managed = true;
-                    info.id = segmentId;
-                    info.event = RegionEvent::created;
-                    info.ptr = std::visit([](auto& s) { return s.get_address(); }, fSegments.at(segmentId));
-                    info.size = std::visit([](auto& s) { return s.get_size(); }, fSegments.at(segmentId));
-                    result.push_back(info);
-                } catch (const std::out_of_range& oor) {
-                    LOG(error) << "could not find segment with id " << segmentId;
-                    LOG(error) << oor.what();
-                }
+                segmentIds.push_back(segmentId);
+            }
+        }
+
+        for (const auto segmentId : segmentIds) {
+            // make sure any segments in the session are found
+            GetSegment(segmentId);
+            try {
+                fair::mq::RegionInfo info;
+                info.managed = true;
+                info.id = segmentId;
+                info.event = RegionEvent::created;
+                info.ptr = std::visit([](auto& s) { return s.get_address(); }, SegmentAt(segmentId));
+                info.size = std::visit([](auto& s) { return s.get_size(); }, SegmentAt(segmentId));
+                result.push_back(info);
+            } catch (const std::out_of_range& oor) {
+                LOG(error) << "could not find segment with id " << segmentId;
+                LOG(error) << oor.what();
             }
+        }
 
+        {
+            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> regionsLock(fLocks->fRegionsMtx);
             for (const auto& [regionId, regionInfo] : *fShmRegions) {
                 fair::mq::RegionInfo info;
                 info.managed = false;
@@ -487,7 +592,7 @@ class Manager
                     cfg.path = regionInfo.fPath.c_str();
                     cfg.rcSegmentSize = regionInfo.fRCSegmentSize;
                     regionCfgs.emplace(info.id, cfg);
-                    // fill the ptr+size info after shmLock is released, to avoid constructing local region under it
+                    // fill the ptr+size info after regionsLock is released, to avoid constructing local region under it
                 } else {
                     info.ptr = nullptr;
                     info.size = 0;
@@ -496,7 +601,7 @@ class Manager
             }
         }
 
-        // do another iteration outside of shm lock, to fill ptr+size of unmanaged regions
+        // do another iteration outside of the regions lock, to fill ptr+size of unmanaged regions
         for (auto& info : result) {
             if (!info.managed && info.event == RegionEvent::created) {
                 auto cfgIt = regionCfgs.find(info.id);
@@ -510,7 +615,7 @@ class Manager
                         auto r = fRegions.emplace(cfgIt->first, std::make_unique<UnmanagedRegion>(fShmId, 0, false, cfgIt->second));
                         region = r.first->second.get();
                         region->InitializeQueues();
-                        region->StartAckSender();
+                        region->StartAckSender(fHousekeepingPlacement);
                     }
 
                     info.ptr = region->GetData();
@@ -529,11 +634,7 @@ class Manager
     {
         if (fRegionEventThread.joinable()) {
             LOG(debug) << "Already subscribed. Overwriting previous subscription.";
-            std::unique_lock<std::mutex> lock(fRegionEventsMtx);
-            fRegionEventsSubscriptionActive = false;
-            lock.unlock();
-            fRegionEventsCV.notify_one();
-            fRegionEventThread.join();
+            StopRegionEventsSubscription();
         }
         std::lock_guard<std::mutex> lock(fRegionEventsMtx);
         fRegionEventCallback = callback;
@@ -546,50 +647,110 @@ class Manager
     void UnsubscribeFromRegionEvents()
     {
         if (fRegionEventThread.joinable()) {
-            std::unique_lock<std::mutex> lock(fRegionEventsMtx);
-            fRegionEventsSubscriptionActive = false;
-            lock.unlock();
-            fRegionEventsCV.notify_one();
-            fRegionEventThread.join();
-            lock.lock();
+            StopRegionEventsSubscription();
+            std::lock_guard<std::mutex> lock(fRegionEventsMtx);
             fRegionEventCallback = nullptr;
         }
     }
 
+    void StopRegionEventsSubscription()
+    {
+        {
+            std::lock_guard<std::mutex> lock(fRegionEventsMtx);
+            fRegionEventsSubscriptionActive = false;
+        }
+        fRegionEventLog->Wake();
+        fRegionEventThread.join();
+    }
+
+    // deliver the event unless it has already been delivered (there are two events per id - created & destroyed)
+    void DeliverRegionEvent(const fair::mq::RegionInfo& info)
+    {
+        auto el = fObservedRegionEvents.find({info.id, info.managed});
+        if (el == fObservedRegionEvents.end()) {
+            fObservedRegionEvents.emplace(std::make_pair(info.id, info.managed), info.event);
+            // if a region has been created and destroyed rapidly, we could see 'destroyed' without ever seeing 'created'
+            if (info.event == RegionEvent::created) {
+                fRegionEventCallback(info);
+            }
+        } else if (el->second == RegionEvent::created && info.event == RegionEvent::destroyed) {
+            fRegionEventCallback(info);
+            el->second = info.event;
+        }
+    }
+
+    // full scan of the session segments/regions, on subscription or if the event log has been overrun
+    void ScanRegionEvents()
+    {
+        for (const auto& info : GetRegionInfo()) {
+            DeliverRegionEvent(info);
+        }
+    }
+
+    // resolve a logged event into a RegionInfo (opening the segment/region if necessary)
+    fair::mq::RegionInfo ResolveRegionEvent(const RegionEventLog::Entry& entry)
+    {
+        fair::mq::RegionInfo info(entry.fManaged, entry.fId, nullptr, 0, 0, entry.fDestroyed ? RegionEvent::destroyed : RegionEvent::created);
+        if (entry.fDestroyed) {
+            return info;
+        }
+        if (entry.fManaged) {
+            GetSegment(entry.fId);
+            info.ptr = std::visit([](auto& s) { return s.get_address(); }, SegmentAt(entry.fId));
+            info.size = std::visit([](auto& s) { return s.get_size(); }, SegmentAt(entry.fId));
+        } else {
+            {
+                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> regionsLock(fLocks->fRegionsMtx);
+                auto it = fShmRegions->find(entry.fId);
+                if (it == fShmRegions->end()) {
+                    return info;
+                }
+                info.flags = it->second.fUserFlags;
+                if (it->second.fDestroyed) {
+                    info.event = RegionEvent::destroyed;
+                    return info;
+                }
+            }
+            if (UnmanagedRegion* region = GetRegion(entry.fId)) {
+                info.ptr = region->GetData();
+                info.size = region->GetSize();
+            }
+        }
+        return info;
+    }
+
     void RegionEventsSubscription()
     {
-        std::unique_lock<std::mutex> lock(fRegionEventsMtx);
-
-        while (fRegionEventsSubscriptionActive) {
-            if (fNumObservedEvents != fEventCounter->fCount) {
-                auto infos = GetRegionInfo();
-
-                for (const auto& i : infos) {
-                    auto el = fObservedRegionEvents.find({i.id, i.managed});
-                    if (el == fObservedRegionEvents.end()) { // if event id has not been observed
-                        fObservedRegionEvents.emplace(std::make_pair(i.id, i.managed), i.event);
-                        // if a region has been created and destroyed rapidly, we could see 'destroyed' without ever seeing 'created'
-                        // TODO: do we care to show 'created' events if we know region is already destroyed?
-                        if (i.event == RegionEvent::created) {
-                            fRegionEventCallback(i);
-                            ++fNumObservedEvents;
-                        } else {
-                            fNumObservedEvents += 2;
-                        }
-                    } else { // if event id has been observed (expected - there are two events per id - created & destroyed)
-                        // fire a callback if we have observed 'created' event and incoming is 'destroyed'
-                        if (el->second == RegionEvent::created && i.event == RegionEvent::destroyed) {
-                            fRegionEventCallback(i);
-                            el->second = i.event;
-                            ++fNumObservedEvents;
-                        } else {
-                            // LOG(debug) << "ignoring event " << i.id << ": incoming: " << i.event << ", stored: " << el->second;
-                        }
-                    }
+        tools::ApplyThreadPlacement("fmq-shm-revents", fHousekeepingPlacement);
+
+        std::vector<RegionEventLog::Entry> entries;
+        uint64_t position = fRegionEventLog->Next();
+        {
+            std::lock_guard<std::mutex> lock(fRegionEventsMtx);
+            ScanRegionEvents();
+        }
+
+        while (true) {
+            entries.clear();
+            bool complete = fRegionEventLog->Read(position, entries, boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(500),
+                                                  [this] { return !fRegionEventsSubscriptionActive; });
+
+            std::lock_guard<std::mutex> lock(fRegionEventsMtx);
+            if (!fRegionEventsSubscriptionActive) {
+                break;
+            }
+            if (!complete) {
+                LOG(debug) << "region event log overrun, rescanning regions";
+                ScanRegionEvents();
+                continue;
+            }
+            for (const auto& entry : entries) {
+                try {
+                    DeliverRegionEvent(ResolveRegionEvent(entry));
+                } catch (const std::out_of_range& oor) {
+                    LOG(error) << "could not resolve event for " << (entry.fManaged ? "segment" : "region") << " with id " << entry.fId << ": " << oor.what();
                 }
             }
-            // TODO: do better than polling here, without adding too much shmem contention
-            fRegionEventsCV.wait_for(lock, std::chrono::milliseconds(50), [&] { return !fRegionEventsSubscriptionActive; });
         }
     }
 
@@ -615,10 +776,13 @@ class Manager
     {
         using namespace boost::interprocess;
 
+        tools::ApplyThreadPlacement("fmq-shm-heartbeat", fHousekeepingPlacement);
+
         Heartbeat* hb = fManagementSegment.find_or_construct<Heartbeat>(unique_instance)(0);
         std::unique_lock<std::mutex> lock(fHeartbeatsMtx);
         while (fBeatTheHeart) {
             (hb->fCount)++;
+            fAccounting->Beat(fAccountingSlot.load(std::memory_order_relaxed));
             fHeartbeatsCV.wait_for(lock, std::chrono::milliseconds(100), [&]() { return !fBeatTheHeart; });
         }
     }
@@ -637,19 +801,29 @@ class Manager
 
     void GetSegment(uint16_t id)
     {
-        auto it = fSegments.find(id);
-        if (it == fSegments.end()) {
+        if (!SegmentOpened(id)) {
             try {
-                // get segment info
+                // the segment info is read under the (interprocess) segments lock, which also serializes the opening
+                boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> segmentsLock(fLocks->fSegmentsMtx);
+                if (SegmentOpened(id)) {
+                    return; // opened by another thread in the meantime
+                }
                 SegmentInfo segmentInfo = fShmSegments->at(id);
                 LOG(debug) << "Located segment with id '" << id << "'";
 
                 using namespace boost::interprocess;
 
                 if (segmentInfo.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit) {
-                    fSegments.emplace(id, RBTreeBestFitSegment(open_only, MakeShmName(fShmId, "m", id).c_str()));
+                    AddSegment(id, RBTreeBestFitSegment(open_only, MakeShmName(fShmId, "m", id).c_str()));
+                } else if (segmentInfo.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                    if (segmentInfo.fPoolHandle == -1) {
+                        LOG(error) << "Could not get segment with id '" << id << "': segregated_fit segment has no pool (incompletely created segment)";
+                        return;
+                    }
+                    auto& segment = std::get<RBTreeBestFitSegment>(AddSegment(id, RBTreeBestFitSegment(open_only, MakeShmName(fShmId, "m", id).c_str())));
+                    AddPool(id, static_cast<SegregatedFitPool*>(segment.get_address_from_handle(segmentInfo.fPoolHandle)));
                 } else {
-                    fSegments.emplace(id, SimpleSeqFitSegment(open_only, MakeShmName(fShmId, "m", id).c_str()));
+                    AddSegment(id, SimpleSeqFitSegment(open_only, MakeShmName(fShmId, "m", id).c_str()));
                 }
             } catch (std::out_of_range& oor) {
                 LOG(error) << "Could not get segment with id '" << id << "': " << oor.what();
@@ -661,74 +835,97 @@ class Manager
 
     boost::interprocess::managed_shared_memory::handle_t GetHandleFromAddress(const void* ptr, uint16_t segmentId) const
     {
-        return std::visit([ptr](auto& s) { return s.get_handle_from_address(ptr); }, fSegments.at(segmentId));
+        return std::visit([ptr](auto& s) { return s.get_handle_from_address(ptr); }, SegmentAt(segmentId));
     }
     char* GetAddressFromHandle(const boost::interprocess::managed_shared_memory::handle_t handle, uint16_t segmentId) const
     {
-        return std::visit([handle](auto& s) { return reinterpret_cast<char*>(s.get_address_from_handle(handle)); }, fSegments.at(segmentId));
+        return std::visit([handle](auto& s) { return reinterpret_cast<char*>(s.get_address_from_handle(handle)); }, SegmentAt(segmentId));
     }
 
-    char* Allocate(size_t size, size_t alignment = 0)
+    /// @brief allocate a buffer in the own segment, waiting for free memory according to the bad-alloc settings
+    /// and for the device/channel budget according to the quota policy
+    /// throws MessageBadAlloc if no memory becomes available within the allowed attempts, if a budget is exceeded
+    /// with the fail policy, or if the transport is interrupted
+    /// @param channelBudget budget of the channel the message is created for (see GetChannelBudget())
+    /// @return nullptr if a budget is exceeded and the quota policy is drop
+    char* Allocate(size_t size, size_t alignment = 0, uint16_t channelBudget = ShmBudgets::kNoBudget)
     {
-        alignment = std::max(alignment, alignof(std::max_align_t));
-
-        char* ptr = nullptr;
-        int numAttempts = 0;
-        size_t fullSize = ShmHeader::FullSize(size, alignment);
-
-        while (!ptr) {
-            try {
-                size_t segmentSize = std::visit([](auto& s) { return s.get_size(); }, fSegments.at(fSegmentId));
-                if (fullSize > segmentSize) {
-                    throw MessageBadAlloc(tools::ToString("Requested message size (", fullSize, ") exceeds segment size (", segmentSize, ")"));
-                }
-
-                ptr = std::visit([fullSize](auto& s) { return reinterpret_cast<char*>(s.allocate(fullSize)); }, fSegments.at(fSegmentId));
-                ShmHeader::Construct(ptr, alignment);
-            } catch (boost::interprocess::bad_alloc& ba) {
-                // LOG(warn) << "Shared memory full...";
-                if (fBadAllocMaxAttempts >= 0 && ++numAttempts >= fBadAllocMaxAttempts) {
-                    throw MessageBadAlloc(tools::ToString("shmem: could not create a message of size ", size,
-                        ", alignment: ", (alignment != 0) ? std::to_string(alignment) : "default",
-                        ", free memory: ", std::visit([](auto& s) { return s.get_free_memory(); }, fSegments.at(fSegmentId))));
-                }
-                if (numAttempts == 1 && fBadAllocMaxAttempts > 1) {
-                    LOG(warn) << tools::ToString("shmem: could not create a message of size ", size,
-                        ", alignment: ", (alignment != 0) ? std::to_string(alignment) : "default",
-                        ", free memory: ", std::visit([](auto& s) { return s.get_free_memory(); }, fSegments.at(fSegmentId)),
-                        ". Will try ", (fBadAllocMaxAttempts > 1 ? (std::to_string(fBadAllocMaxAttempts - 1)) + " more times" : " until success"),
-                        ", in ", fBadAllocAttemptIntervalInMs, "ms intervals");
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(fBadAllocAttemptIntervalInMs));
-                if (Interrupted()) {
-                    throw MessageBadAlloc(tools::ToString("shmem: could not create a message of size ", size,
-                        ", alignment: ", (alignment != 0) ? std::to_string(alignment) : "default",
-                        ", free memory: ", std::visit([](auto& s) { return s.get_free_memory(); }, fSegments.at(fSegmentId))));
-                } else {
-                    continue;
-                }
+        uint16_t exceeded = ShmBudgets::kNoBudget;
+        char* ptr = AllocateUntil(size, alignment, std::chrono::steady_clock::now(), channelBudget, exceeded);
+
+        if (!ptr && exceeded != ShmBudgets::kNoBudget) {
+            ShmBudgets::Budget& budget = fBudgets->fBudgets[exceeded];
+            if (fQuotaPolicy == QuotaPolicy::drop) {
+                budget.fDropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
             }
-#ifdef FAIRMQ_DEBUG_MODE
-            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(*fShmMtx);
-            IncrementShmMsgCounter(fSegmentId);
-            if (fMsgDebug->count(fSegmentId) == 0) {
-                fMsgDebug->emplace(fSegmentId, fShmVoidAlloc);
+            if (fQuotaPolicy == QuotaPolicy::block) {
+                budget.fBlocked.fetch_add(1, std::memory_order_relaxed);
+                ptr = AllocateUntil(size, alignment, std::nullopt, channelBudget, exceeded);
             }
-            fMsgDebug->at(fSegmentId).emplace(
-                static_cast<size_t>(GetHandleFromAddress(ShmHeader::UserPtr(ptr), fSegmentId)),
-                MsgDebug(getpid(), size, std::chrono::system_clock::now().time_since_epoch().count())
-            );
-#endif
+            if (!ptr) {
+                budget.fFailed.fetch_add(1, std::memory_order_relaxed);
+                throw MessageBadAlloc(tools::ToString("shmem: could not create a message of size ", size, ", ",
+                    budget.fName[0] == '\0' ? std::string("device") : "channel '" + std::string(budget.fName) + "'",
+                    " quota of ", budget.fLimit.load(std::memory_order_relaxed), " bytes exceeded"));
+            }
+        }
+
+        if (!ptr && fBadAllocMaxAttempts != 0 && fBadAllocMaxAttempts != 1) {
+            std::optional<std::chrono::steady_clock::time_point> deadline;
+            if (fBadAllocMaxAttempts > 1) {
+                // the previous attempts translate into a total waiting time, in which each free wakes up the allocation
+                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(fBadAllocAttemptIntervalInMs) * (fBadAllocMaxAttempts - 1);
+            }
+            LOG(warn) << "shmem: could not create a message of size " << size
+                      << ", alignment: " << ((alignment != 0) ? std::to_string(alignment) : "default")
+                      << ", free memory: " << GetFreeMemory(fSegmentId)
+                      << ", cached memory: " << GetCachedMemory(fSegmentId)
+                      << ". Will wait " << (deadline ? "up to " + std::to_string(fBadAllocAttemptIntervalInMs * (fBadAllocMaxAttempts - 1)) + "ms" : "until success")
+                      << " for memory to be freed";
+            ptr = AllocateUntil(size, alignment, deadline, channelBudget, exceeded);
+        }
+
+        if (!ptr) {
+            throw MessageBadAlloc(tools::ToString("shmem: could not create a message of size ", size,
+                ", alignment: ", (alignment != 0) ? std::to_string(alignment) : "default",
+                ", free memory: ", GetFreeMemory(fSegmentId), ", cached memory: ", GetCachedMemory(fSegmentId)));
         }
 
         return ptr;
     }
 
+    /// @brief budget of the given channel ("data[0]" or "data"), as configured with shm-channel-quota, kNoBudget if none
+    uint16_t GetChannelBudget(const std::string& channel) const
+    {
+        if (fChannelBudgets.empty()) {
+            return ShmBudgets::kNoBudget;
+        }
+        auto it = fChannelBudgets.find(channel.substr(0, channel.rfind('[')));
+        return it == fChannelBudgets.end() ? ShmBudgets::kNoBudget : it->second;
+    }
+
+    QuotaPolicy GetQuotaPolicy() const { return fQuotaPolicy; }
+
+    /// @brief free memory of the underlying allocator of the given segment
+    size_t GetFreeMemory(uint16_t segmentId) const
+    {
+        return std::visit([](auto& s) { return s.get_free_memory(); }, SegmentAt(segmentId));
+    }
+
+    /// @brief segregated_fit: memory cached in the size class free lists of the pool of the given segment
+    /// Cached blocks are available to allocations of their size class only, they are not part of GetFreeMemory().
+    size_t GetCachedMemory(uint16_t segmentId) const
+    {
+        auto pool = GetPool(segmentId);
+        return pool ? pool->GetCachedMemory() : 0;
+    }
+
     void Deallocate(boost::interprocess::managed_shared_memory::handle_t handle, uint16_t segmentId)
     {
         char* ptr = GetAddressFromHandle(handle, segmentId);
 #ifdef FAIRMQ_DEBUG_MODE
-        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(*fShmMtx);
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fLocks->fDebugMtx);
         DecrementShmMsgCounter(segmentId);
         try {
             fMsgDebug->at(segmentId).erase(GetHandleFromAddress(ShmHeader::UserPtr(ptr), fSegmentId));
@@ -736,13 +933,86 @@ class Manager
             LOG(debug) << "could not locate debug container for " << segmentId << ": " << oor.what();
         }
 #endif
+        const ShmHeader::Hdr& hdr = ShmHeader::Header(ptr);
+        fAccounting->OnDeallocate(hdr.owner.load(std::memory_order_relaxed), hdr.SizeClass(), hdr.Size(), hdr.creationTime);
+        fBudgets->Discharge(hdr.Budget(), hdr.Size());
         ShmHeader::Destruct(ptr);
-        std::visit([ptr](auto& s) { s.deallocate(ptr); }, fSegments.at(segmentId));
+        if (auto pool = GetPool(segmentId); pool) {
+            pool->Deallocate(std::get<RBTreeBestFitSegment>(SegmentAt(segmentId)), ptr);
+        } else {
+            std::visit([ptr](auto& s) { s.deallocate(ptr); }, SegmentAt(segmentId));
+        }
+        NotifyFreeMemory();
+    }
+
+    /// @brief attribute a received managed segment buffer to this process, or to no process if other references to it exist
+    /// @return false if the buffer has been reclaimed by the monitor (its sender died), it must not be used or freed then
+    bool TakeOwnership(boost::interprocess::managed_shared_memory::handle_t handle, uint16_t segmentId)
+    {
+        GetSegment(segmentId);
+        char* ptr = GetAddressFromHandle(handle, segmentId);
+        return Transfer(ptr, ShmHeader::RefCount(ptr) > 1 ? ShmAccounting::kShared : fAccountingSlot.load(std::memory_order_relaxed));
+    }
+
+    /// @brief detach a buffer referenced by several processes from its owner (it is then never reclaimed)
+    void MarkShared(char* ptr) { Transfer(ptr, ShmAccounting::kShared); }
+
+    /// @brief attribute a managed segment buffer to no process while its meta data is being sent (ShmAccounting::kInFlight)
+    /// A sender dying before the receiver took the buffer over (TakeOwnership()) then does not take it along when its
+    /// buffers are reclaimed. A failed send returns the buffer with TakeOwnership().
+    void MarkInFlight(boost::interprocess::managed_shared_memory::handle_t handle, uint16_t segmentId)
+    {
+        Transfer(GetAddressFromHandle(handle, segmentId), ShmAccounting::kInFlight);
     }
 
     char* ShrinkInPlace(size_t newSize, char* localPtr, uint16_t segmentId)
     {
-        return std::visit(SegmentBufferShrink(newSize, localPtr), fSegments.at(segmentId));
+        newSize = ShmHeader::RoundSize(newSize);
+        char* ptr = nullptr;
+        if (auto pool = GetPool(segmentId); pool) {
+            ptr = pool->ShrinkInPlace(std::get<RBTreeBestFitSegment>(SegmentAt(segmentId)), newSize, localPtr);
+        } else {
+            ptr = std::visit(SegmentBufferShrink(newSize, localPtr), SegmentAt(segmentId));
+        }
+        ResizeAccounted(ptr, newSize);
+        NotifyFreeMemory();
+        return ptr;
+    }
+
+    /// @brief try to grow the buffer at localPtr in place, so that it spans at least newSize bytes
+    bool ExpandInPlace(size_t newSize, char* localPtr, uint16_t segmentId)
+    {
+        // the growth is charged to the budget of the buffer first, a caller falls back to a new (checked) allocation
+        newSize = ShmHeader::RoundSize(newSize);
+        const ShmHeader::Hdr& hdr = ShmHeader::Header(localPtr);
+        if (newSize > ShmHeader::kMaxFullSize) {
+            return false;
+        }
+        const size_t growth = newSize > hdr.Size() ? newSize - hdr.Size() : 0;
+        if (fBudgets->Charge(hdr.Budget(), growth) != ShmBudgets::kNoBudget) {
+            return false;
+        }
+        bool expanded = false;
+        if (auto pool = GetPool(segmentId); pool) {
+            expanded = pool->ExpandInPlace(std::get<RBTreeBestFitSegment>(SegmentAt(segmentId)), newSize, localPtr);
+        } else {
+            expanded = std::visit(SegmentBufferExpand(newSize, localPtr), SegmentAt(segmentId)) != nullptr;
+        }
+        if (expanded) {
+            ResizeAccounted(localPtr, newSize);
+        } else {
+            fBudgets->Discharge(hdr.Budget(), growth);
+        }
+        return expanded;
+    }
+
+    /// @brief segregated fit pool of the given segment, nullptr if the segment uses another allocation algorithm
+    SegregatedFitPool* GetPool(uint16_t segmentId) const
+    {
+        if (segmentId == fSegmentId) {
+            return fPool;
+        }
+        return FindPool(segmentId);
     }
 
     uint16_t GetSegmentId() const { return fSegmentId; }
@@ -787,21 +1057,241 @@ class Manager
     }
 
   private:
+    // segment opened by this process, throws std::out_of_range if it is not (see GetSegment())
+    SegmentVariant& SegmentAt(uint16_t id)
+    {
+        std::shared_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        return fSegments.at(id);
+    }
+    const SegmentVariant& SegmentAt(uint16_t id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        return fSegments.at(id);
+    }
+
+    bool SegmentOpened(uint16_t id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        return fSegments.find(id) != fSegments.end();
+    }
+
+    SegregatedFitPool* FindPool(uint16_t id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        auto it = fPools.find(id);
+        return it != fPools.end() ? it->second : nullptr;
+    }
+
+    SegmentVariant& AddSegment(uint16_t id, SegmentVariant&& segment)
+    {
+        std::unique_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        return fSegments.emplace(id, std::move(segment)).first->second;
+    }
+
+    void AddPool(uint16_t id, SegregatedFitPool* pool)
+    {
+        std::unique_lock<std::shared_mutex> lock(fLocalSegmentsMtx);
+        fPools.emplace(id, pool);
+    }
+
+    // allocate in the own segment, waiting for memory to be freed until the deadline (forever if none is given)
+    // throws MessageBadAlloc if the buffer exceeds the segment size or ShmHeader::kMaxFullSize
+    // returns nullptr if the deadline is reached or the transport is interrupted
+    // exceeded: set to the exceeded budget if the allocation failed because of it, kNoBudget otherwise
+    char* AllocateUntil(size_t size, size_t alignment, std::optional<std::chrono::steady_clock::time_point> deadline, uint16_t channelBudget, uint16_t& exceeded)
+    {
+        alignment = std::max(alignment, alignof(std::max_align_t));
+        size_t fullSize = ShmHeader::FullSize(size, alignment);
+
+        size_t segmentSize = std::visit([](auto& s) { return s.get_size(); }, SegmentAt(fSegmentId));
+        if (fullSize > segmentSize) {
+            throw MessageBadAlloc(tools::ToString("Requested message size (", fullSize, ") exceeds segment size (", segmentSize, ")"));
+        }
+        if (fullSize > ShmHeader::kMaxFullSize) {
+            throw MessageBadAlloc(tools::ToString("Requested message size (", fullSize, ") exceeds the maximum message size (", ShmHeader::kMaxFullSize, ")"));
+        }
+
+        char* ptr = nullptr;
+        bool waiting = false;
+        uint32_t generation = 0;
+        const uint8_t sizeClass = ShmAccounting::SizeClass(fullSize);
+        // a channel budget charges the device budget along (ShmBudgets::Budget::fParent)
+        const uint16_t budget = channelBudget != ShmBudgets::kNoBudget ? channelBudget : fDeviceBudget;
+
+        while (true) {
+            exceeded = fBudgets->Charge(budget, fullSize);
+            if (exceeded == ShmBudgets::kNoBudget) {
+                try {
+                    if (fPool) {
+                        ptr = fPool->Allocate(std::get<RBTreeBestFitSegment>(SegmentAt(fSegmentId)), fullSize);
+                    } else {
+                        ptr = std::visit([fullSize](auto& s) { return reinterpret_cast<char*>(s.allocate(fullSize)); }, SegmentAt(fSegmentId));
+                    }
+                    const uint16_t slot = fAccountingSlot.load(std::memory_order_relaxed);
+                    ShmHeader::Construct(ptr, alignment, fullSize, slot, sizeClass, ShmAccounting::Now(), budget);
+                    fAccounting->OnAllocate(slot, sizeClass, fullSize, ShmHeader::Header(ptr).creationTime);
+                    break;
+                } catch (boost::interprocess::bad_alloc& ba) {
+                    // LOG(warn) << "Shared memory full...";
+                    fBudgets->Discharge(budget, fullSize);
+                }
+            } else if (fQuotaPolicy != QuotaPolicy::block) {
+                break;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (Interrupted() || (deadline && now >= *deadline)) {
+                break;
+            }
+
+            if (!waiting) {
+                // register as waiter and retry once, so that no deallocation between the failed attempt and the registration is missed
+                fAccounting->AddWaiter(fAccountingSlot.load(std::memory_order_relaxed), *fFreeMemoryNotifier);
+                generation = fFreeMemoryNotifier->fGeneration.load(std::memory_order_acquire);
+                waiting = true;
+                continue;
+            }
+            // the attempt interval only serves as a fallback, in case a notifying process died
+            auto waitTill = now + std::chrono::milliseconds(std::max(fBadAllocAttemptIntervalInMs, 1));
+            if (deadline) {
+                waitTill = std::min(waitTill, *deadline);
+            }
+            fFreeMemoryNotifier->Wait(generation, std::chrono::duration_cast<std::chrono::microseconds>(waitTill - now));
+            generation = fFreeMemoryNotifier->fGeneration.load(std::memory_order_acquire);
+        }
+
+        if (waiting) {
+            fAccounting->RemoveWaiter(fAccountingSlot.load(std::memory_order_relaxed), *fFreeMemoryNotifier);
+        }
+
+#ifdef FAIRMQ_DEBUG_MODE
+        if (ptr) {
+            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fLocks->fDebugMtx);
+            IncrementShmMsgCounter(fSegmentId);
+            if (fMsgDebug->count(fSegmentId) == 0) {
+                fMsgDebug->emplace(fSegmentId, fShmVoidAlloc);
+            }
+            fMsgDebug->at(fSegmentId).emplace(
+                static_cast<size_t>(GetHandleFromAddress(ShmHeader::UserPtr(ptr), fSegmentId)),
+                MsgDebug(getpid(), size, std::chrono::system_clock::now().time_since_epoch().count())
+            );
+        }
+#endif
+
+        return ptr;
+    }
+
+    // update the accounted size of a buffer resized in place (growth is charged to the budget by ExpandInPlace)
+    // newSize is rounded to ShmHeader::kSizeUnit
+    void ResizeAccounted(char* ptr, size_t newSize)
+    {
+        ShmHeader::Hdr& hdr = ShmHeader::Header(ptr);
+        fAccounting->OnResize(hdr.owner.load(std::memory_order_relaxed), hdr.Size(), newSize);
+        if (newSize < hdr.Size()) {
+            fBudgets->Discharge(hdr.Budget(), hdr.Size() - newSize);
+        }
+        hdr.SetSize(newSize);
+    }
+
+    static QuotaPolicy ParseQuotaPolicy(const std::string& policy)
+    {
+        if (policy == "block") {
+            return QuotaPolicy::block;
+        } else if (policy == "fail") {
+            return QuotaPolicy::fail;
+        } else if (policy == "drop") {
+            return QuotaPolicy::drop;
+        }
+        throw TransportError(tools::ToString("Unknown shm-quota-policy '", policy, "', expected block, fail or drop"));
+    }
+
+    // claim the budgets configured with shm-quota (device) and shm-channel-quota (<channel>=<bytes>)
+    void RegisterBudgets(const ProgOptions& config)
+    {
+        auto registerBudget = [&](const std::string& name, uint64_t limit, uint16_t parent) {
+            uint16_t budget = fBudgets->Register(getpid(), name, limit, parent);
+            if (budget == ShmBudgets::kNoBudget) {
+                LOG(warn) << "shmem: budget table is full (" << ShmBudgets::kMaxBudgets << " budgets), the quota of "
+                          << (name.empty() ? std::string("the device") : "channel '" + name + "'") << " will not be enforced";
+            }
+            return budget;
+        };
+
+        if (uint64_t quota = config.GetProperty<size_t>("shm-quota", 0); quota > 0) {
+            fDeviceBudget = registerBudget("", quota, ShmBudgets::kNoBudget);
+        }
+        for (const auto& entry : config.GetProperty<std::vector<std::string>>("shm-channel-quota", {})) {
+            size_t pos = entry.rfind('=');
+            uint64_t limit = 0;
+            try {
+                if (pos != std::string::npos) {
+                    limit = std::stoull(entry.substr(pos + 1));
+                }
+            } catch (const std::exception&) {
+                limit = 0;
+            }
+            if (pos == std::string::npos || pos == 0 || limit == 0) {
+                throw TransportError(tools::ToString("Invalid shm-channel-quota entry '", entry, "', expected <channel>=<bytes>"));
+            }
+            fChannelBudgets[entry.substr(0, pos)] = registerBudget(entry.substr(0, pos), limit, fDeviceBudget);
+        }
+    }
+
+    // move the accounting of a buffer to another slot, shared buffers stay shared
+    // returns false if the buffer has been reclaimed (Monitor::ReclaimDeadBuffers), it is not taken over then
+    bool Transfer(char* ptr, uint16_t to)
+    {
+        ShmHeader::Hdr& hdr = ShmHeader::Header(ptr);
+        uint16_t from = hdr.owner.load(std::memory_order_relaxed);
+        while (from != to && from != ShmAccounting::kShared) {
+            if (from == ShmAccounting::kReclaimed) {
+                return false;
+            }
+            if (hdr.owner.compare_exchange_weak(from, to, std::memory_order_relaxed)) {
+                fAccounting->OnTransfer(from, to, hdr.SizeClass(), hdr.Size(), hdr.creationTime);
+                return true;
+            }
+        }
+        return true;
+    }
+
+    // wake up allocations waiting for free memory (in any process), cheap if there are none
+    void NotifyFreeMemory()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (fFreeMemoryNotifier->fWaiters.load() > 0) {
+            fFreeMemoryNotifier->Notify();
+        }
+    }
+
     uint64_t fShmId64;
     std::string fShmId;
     uint16_t fSegmentId;
-    std::unordered_map<uint16_t, std::variant<RBTreeBestFitSegment, SimpleSeqFitSegment>> fSegments; // TODO: refactor to use Segment class
+    // the segments opened by this process and their pools, only accessed via SegmentAt()/SegmentOpened()/FindPool()
+    // (shared lock) and AddSegment()/AddPool() (exclusive lock). Entries are never removed before destruction and
+    // the map nodes stay in place, so references to the segments remain valid after the lookup.
+    std::unordered_map<uint16_t, SegmentVariant> fSegments; // TODO: refactor to use Segment class
+    std::unordered_map<uint16_t, SegregatedFitPool*> fPools; // pools of the segregated_fit segments
+    mutable std::shared_mutex fLocalSegmentsMtx; // guards fSegments and fPools
+    SegregatedFitPool* fPool = nullptr; // pool of the own segment, if it uses segregated_fit
     boost::interprocess::managed_shared_memory fManagementSegment; // TODO: refactor to use ManagementSegment class
     VoidAlloc fShmVoidAlloc;
-    boost::interprocess::interprocess_mutex* fShmMtx;
+    boost::interprocess::interprocess_mutex* fShmMtx; // session mutex, see ManagementLocks for the data locks
+    ManagementLocks* fLocks;
+    FreeMemoryNotifier* fFreeMemoryNotifier;
+    RegionEventLog* fRegionEventLog;
+    ShmAccounting* fAccounting;
+    std::atomic<uint16_t> fAccountingSlot; // own slot in fAccounting, kNoSlot if the table is full (atomic: read by the heartbeat thread)
+    ShmBudgets* fBudgets;
+    uint16_t fDeviceBudget; // own budget in fBudgets, kNoBudget if no quota is configured
+    QuotaPolicy fQuotaPolicy;
+    std::unordered_map<std::string, uint16_t> fChannelBudgets; // by channel name (without index), read-only after construction
 
     std::mutex fLocalRegionsMtx;
     std::mutex fRegionEventsMtx;
-    std::condition_variable fRegionEventsCV;
     std::thread fRegionEventThread;
     std::function<void(fair::mq::RegionInfo)> fRegionEventCallback;
     std::map<std::pair<uint16_t, bool>, RegionEvent> fObservedRegionEvents; // pair: <region id, managed>
-    uint64_t fNumObservedEvents;
 
     DeviceCounter* fDeviceCounter;
     EventCounter* fEventCounter;
@@ -826,7 +1316,7 @@ class Manager
     std::condition_variable fHeartbeatsCV;
     bool fBeatTheHeart;
 
-    bool fRegionEventsSubscriptionActive;
+    std::atomic<bool> fRegionEventsSubscriptionActive; // modified under fRegionEventsMtx, read by the event log wait
     std::atomic<bool> fInterrupted;
 
     int fBadAllocMaxAttempts;
@@ -834,6 +1324,9 @@ class Manager
     bool fNoCleanup;
 
     std::size_t fMetadataMsgSize;
+
+    tools::ThreadPlacement fHousekeepingPlacement;
+    PrefaultConfig fPrefaultConfig;
 };
 
 } // namespace fair::mq::shmem
@@ -22,6 +22,8 @@
 
 #include <cstddef> // size_t
 #include <atomic>
+#include <cstring> // memcpy
+#include <memory> // unique_ptr
 
 #include <sys/types.h> // getpid
 #include <unistd.h> // pid_t
@@ -61,6 +63,17 @@ class Message final : public fair::mq::Message
         fManager.IncrementMsgCounter();
     }
 
+    /// message allocated for the given channel budget (see Manager::GetChannelBudget()), kept on Rebuild(size)
+    Message(Manager& manager, const size_t size, Alignment alignment, uint16_t channelBudget, fair::mq::TransportFactory* factory = nullptr)
+        : fair::mq::Message(factory)
+        , fManager(manager)
+        , fSegmentId(fManager.GetSegmentId())
+        , fChannelBudget(channelBudget)
+    {
+        InitializeChunk(size, alignment.alignment);
+        fManager.IncrementMsgCounter();
+    }
+
     Message(Manager& manager, void* data, const size_t size, fair::mq::FreeFn* ffn, void* hint = nullptr, fair::mq::TransportFactory* factory = nullptr)
         : fair::mq::Message(factory)
         , fManager(manager)
@@ -114,6 +127,7 @@ class Message final : public fair::mq::Message
         , fManaged(hdr.fManaged)
     {
         fManager.IncrementMsgCounter();
+        TakeOwnership();
     }
 
     Message(const Message&) = delete;
@@ -195,6 +209,9 @@ class Message final : public fair::mq::Message
         } else if (newSize == 0) {
             Deallocate();
             return true;
+        } else if (newSize <= fSize && fDropBuffer) {
+            fSize = newSize;
+            return true;
         } else if (newSize <= fSize) {
             try {
                 char* oldPtr = fManager.GetAddressFromHandle(fHandle, fSegmentId);
@@ -213,12 +230,14 @@ class Message final : public fair::mq::Message
                             // if no alignment is provided, take the minimum alignment of the old pointer, but no more than 4096
                             alignment.alignment = 1 << std::min(__builtin_ctz(reinterpret_cast<size_t>(oldPtr)), 12);
                         }
-                        char* ptr = fManager.Allocate(newSize, alignment.alignment);
-                        char* userPtr = ShmHeader::UserPtr(ptr);
-                        std::memcpy(userPtr, fLocalPtr, newSize);
-                        fManager.Deallocate(fHandle, fSegmentId);
-                        fLocalPtr = userPtr;
-                        fHandle = fManager.GetHandleFromAddress(ptr, fSegmentId);
+                        // the old buffer is kept if the new allocation is dropped (quota), it is charged to the same budgets
+                        if (char* ptr = fManager.Allocate(newSize, alignment.alignment, fChannelBudget); ptr) {
+                            char* userPtr = ShmHeader::UserPtr(ptr);
+                            std::memcpy(userPtr, fLocalPtr, newSize);
+                            fManager.Deallocate(fHandle, fSegmentId);
+                            fLocalPtr = userPtr;
+                            fHandle = fManager.GetHandleFromAddress(ptr, fSegmentId);
+                        }
                     }
                     fSize = newSize;
                     return true;
@@ -233,6 +252,74 @@ class Message final : public fair::mq::Message
         }
     }
 
+    bool Resize(size_t newSize, Alignment alignment = Alignment{0}) override
+    {
+        if (newSize <= fSize) {
+            return SetUsedSize(newSize, alignment);
+        }
+        if (fDropBuffer) {
+            std::unique_ptr<char[]> buffer(new char[newSize]);
+            std::memcpy(buffer.get(), fDropBuffer.get(), fSize);
+            fDropBuffer = std::move(buffer);
+            fLocalPtr = fDropBuffer.get();
+            fSize = newSize;
+            return true;
+        }
+
+        try {
+            if (fHandle < 0) {
+                InitializeChunk(newSize, alignment.alignment);
+                return true;
+            }
+
+            char* oldUserPtr = static_cast<char*>(GetData());
+            if (!oldUserPtr) {
+                LOG(error) << "could not resize message, the buffer is not accessible";
+                return false;
+            }
+
+            // try to grow in place, if the current buffer satisfies the requested alignment and is not shared with
+            // other messages (copies, PUB/SUB), which must not see the size change
+            if (fManaged && GetRefCount() == 1
+             && (alignment.alignment == 0 || reinterpret_cast<uintptr_t>(oldUserPtr) % alignment.alignment == 0)) {
+                char* oldPtr = fManager.GetAddressFromHandle(fHandle, fSegmentId);
+                if (fManager.ExpandInPlace(ShmHeader::UserOffset(oldPtr) + newSize, oldPtr, fSegmentId)) {
+                    fSize = newSize;
+                    return true;
+                }
+            }
+
+            // otherwise allocate a new buffer in the own segment and copy the content over (the other references to a
+            // shared buffer keep it)
+            if (alignment.alignment == 0) {
+                // if no alignment is provided, take the minimum alignment of the old pointer, but no more than 4096
+                alignment.alignment = 1 << std::min(__builtin_ctz(reinterpret_cast<size_t>(oldUserPtr)), 12);
+            }
+            char* ptr = fManager.Allocate(newSize, alignment.alignment, fChannelBudget);
+            if (!ptr) { // budget exceeded with the drop quota policy
+                LOG(debug) << "could not resize message, quota exceeded";
+                return false;
+            }
+            char* userPtr = ShmHeader::UserPtr(ptr);
+            std::memcpy(userPtr, oldUserPtr, fSize);
+            Deallocate(); // releases the old buffer (or this message's reference to it)
+
+            fSegmentId = fManager.GetSegmentId();
+            fHandle = fManager.GetHandleFromAddress(ptr, fSegmentId);
+            fShared = -1;
+            fManaged = true;
+            fLocalPtr = userPtr;
+            fSize = newSize;
+            return true;
+        } catch (MessageBadAlloc& e) {
+            LOG(debug) << "could not resize message: " << e.what();
+            return false;
+        } catch (boost::interprocess::interprocess_exception& e) {
+            LOG(debug) << "could not resize message: " << e.what();
+            return false;
+        }
+    }
+
     Transport GetType() const override { return fair::mq::Transport::SHM; }
 
     uint16_t GetRefCount() const
@@ -263,6 +350,15 @@ class Message final : public fair::mq::Message
     void Copy(const fair::mq::Message& other) override
     {
         const Message& otherMsg = static_cast<const Message&>(other);
+        // a copy of a dropped message (see InitializeChunk) is dropped too
+        if (otherMsg.fDropBuffer) {
+            Deallocate();
+            fDropBuffer.reset(new char[otherMsg.fSize]);
+            std::memcpy(fDropBuffer.get(), otherMsg.fDropBuffer.get(), otherMsg.fSize);
+            fLocalPtr = fDropBuffer.get();
+            fSize = otherMsg.fSize;
+            return;
+        }
         // if the other message is not initialized, close this one too and return
         if (otherMsg.fHandle < 0) {
             CloseMessage();
@@ -297,11 +393,16 @@ class Message final : public fair::mq::Message
             } else { // if RefCount segment size is 0, store the ref count in the managed segment
                 if (otherMsg.fShared < 0) { // if UR msg is not yet shared
                     char* ptr = fManager.Allocate(2, 0);
+                    if (!ptr) {
+                        throw RefCountBadAlloc(tools::ToString("Insufficient quota for the reference count of the region message, region id ", otherMsg.fRegionId));
+                    }
                     // point the fShared in the unmanaged region message to the refCount holder
                     otherMsg.fShared = fManager.GetHandleFromAddress(ptr, fSegmentId);
                     // the message needs to be able to locate in which segment the refCount is stored
                     otherMsg.fSegmentId = fSegmentId;
                     ShmHeader::IncrementRefCount(ptr);
+                    // the holder is used by the receivers of the copies as well, it must not be reclaimed with this process
+                    fManager.MarkShared(ptr);
                 } else { // if the UR msg is already shared
                     fManager.GetSegment(otherMsg.fSegmentId);
                     ShmHeader::IncrementRefCount(fManager.GetAddressFromHandle(otherMsg.fShared, otherMsg.fSegmentId));
@@ -322,6 +423,27 @@ class Message final : public fair::mq::Message
     ~Message() override { CloseMessage(); }
 
   private:
+    /// Record that the buffers of this message have been handed over to the receiver (the meta data has been sent):
+    /// the receiver takes over the reference of this message, which no longer releases it.
+    /// Cleared when the message is rebuilt.
+    void HandOver() { fQueued = true; }
+
+    /// Attribute the managed buffer to no process while the meta data is being sent (see Manager::MarkInFlight()),
+    /// before the send. Undone by ReturnFromFlight() if the send fails.
+    void MarkInFlight()
+    {
+        if (fManaged && fHandle >= 0) {
+            fManager.MarkInFlight(fHandle, fSegmentId);
+        }
+    }
+
+    void ReturnFromFlight()
+    {
+        if (fManaged && fHandle >= 0) {
+            fManager.TakeOwnership(fHandle, fSegmentId);
+        }
+    }
+
     Manager& fManager;
     mutable UnmanagedRegion* fRegionPtr = nullptr;
     mutable char* fLocalPtr = nullptr;
@@ -332,10 +454,14 @@ class Message final : public fair::mq::Message
     uint16_t fRegionId = 0; // id of the unmanaged region
     mutable uint16_t fSegmentId; // id of the managed segment
     bool fManaged = true; // true = managed segment, false = unmanaged region
-    bool fQueued = false;
+    bool fQueued = false; // the buffers have been handed over to a receiver, see HandOver()
+    bool fReclaimed = false; // the received buffer had been reclaimed by the monitor, see TakeOwnership()
+    uint16_t fChannelBudget = ShmBudgets::kNoBudget; // budget the buffers of this message are charged to (besides the device budget)
+    std::unique_ptr<char[]> fDropBuffer; // local buffer of a message dropped because of an exceeded budget, discarded on send
 
     void SetMeta(const MetaHeader& meta)
     {
+        fReclaimed = false;
         fSize = meta.fSize;
         fHint = meta.fHint;
         fHandle = meta.fHandle;
@@ -343,6 +469,19 @@ class Message final : public fair::mq::Message
         fRegionId = meta.fRegionId;
         fSegmentId = meta.fSegmentId;
         fManaged = meta.fManaged;
+        TakeOwnership();
+    }
+
+    // account a received managed segment buffer to the receiving process (see ShmAccounting)
+    // a buffer reclaimed by the monitor in the meantime (its sender died) is dropped without touching it
+    void TakeOwnership()
+    {
+        if (fManaged && fHandle >= 0 && !fManager.TakeOwnership(fHandle, fSegmentId)) {
+            fReclaimed = true;
+            fHandle = -1;
+            fLocalPtr = nullptr;
+            fSize = 0;
+        }
     }
 
     char* InitializeChunk(const size_t size, size_t alignment = 0)
@@ -351,7 +490,14 @@ class Message final : public fair::mq::Message
             fSize = 0;
             return fLocalPtr;
         }
-        char* ptr = fManager.Allocate(size, alignment);
+        char* ptr = fManager.Allocate(size, alignment, fChannelBudget);
+        if (!ptr) {
+            // budget exceeded with the drop quota policy: the message is usable, but never leaves the process
+            fDropBuffer.reset(new char[size]);
+            fSize = size;
+            fLocalPtr = fDropBuffer.get();
+            return fLocalPtr;
+        }
         fHandle = fManager.GetHandleFromAddress(ptr, fSegmentId);
         fSize = size;
         fLocalPtr = ShmHeader::UserPtr(ptr);
@@ -394,6 +540,7 @@ class Message final : public fair::mq::Message
                 }
             }
         }
+        fDropBuffer.reset();
         fHandle = -1;
         fLocalPtr = nullptr;
         fSize = 0;
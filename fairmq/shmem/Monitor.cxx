@@ -8,6 +8,7 @@
 
 #include "Common.h"
 #include "Monitor.h"
+#include "SegregatedFit.h"
 #include "Segment.h"
 #include <fairmq/shmem/UnmanagedRegion.h>
 
@@ -22,14 +23,18 @@
 #include <boost/interprocess/sync/named_condition.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
 
+#include <algorithm> // std::sort
 #include <csignal>
 #include <cstdio>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <functional>
 #include <iomanip>
+#include <new> // std::nothrow
 #include <sstream>
+#include <type_traits> // std::remove_reference_t
 #include <variant>
 
 #include <poll.h>
@@ -54,6 +59,192 @@ namespace
 namespace fair::mq::shmem
 {
 
+namespace
+{
+
+// granularity of the largest free block probe
+constexpr size_t kProbeGranularity = 64;
+
+// size of the largest buffer the allocator of the segment can currently hand out, found by a binary search with
+// nothrow allocations (each freed right away, the allocator lock is only held for the single allocations)
+template<typename SegmentType>
+size_t ProbeLargestFreeBlock(SegmentType& segment)
+{
+    size_t allocatable = 0;
+    size_t notAllocatable = segment.get_free_memory() + 1;
+    while (notAllocatable - allocatable > kProbeGranularity) {
+        const size_t size = allocatable + (notAllocatable - allocatable) / 2;
+        if (void* ptr = segment.allocate(size, std::nothrow); ptr) {
+            segment.deallocate(ptr);
+            allocatable = size;
+        } else {
+            notAllocatable = size;
+        }
+    }
+    return allocatable;
+}
+
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+using RBTreeBestFitAlgorithm = boost::interprocess::rbtree_best_fit<boost::interprocess::mutex_family, boost::interprocess::offset_ptr<void>>;
+using SimpleSeqFitAlgorithm = boost::interprocess::simple_seq_fit<boost::interprocess::mutex_family, boost::interprocess::offset_ptr<void>>;
+using SimpleSeqFitImpl = boost::interprocess::ipcdetail::simple_seq_fit_impl<boost::interprocess::mutex_family, boost::interprocess::offset_ptr<void>>;
+
+// The allocators do not expose their blocks, their (private) headers and block traversal functions are reached via the
+// explicit instantiation access rule (access checking does not apply to the arguments of explicit instantiations).
+// This depends on the internals of the Boost version, hence only built with FAIRMQ_SHM_BLOCK_WALK (see CMakeLists.txt).
+template<typename Tag, auto Member>
+struct PrivateMember { friend auto GetMember(Tag) { return Member; } };
+struct RBTreeBestFitHeader { friend auto GetMember(RBTreeBestFitHeader); };
+struct SimpleSeqFitHeader { friend auto GetMember(SimpleSeqFitHeader); };
+template struct PrivateMember<RBTreeBestFitHeader, &RBTreeBestFitAlgorithm::m_header>;
+template struct PrivateMember<SimpleSeqFitHeader, &SimpleSeqFitImpl::m_header>;
+
+// block traversal of the allocators (private as well)
+struct RBTreeBestFitFirstBlock { friend auto GetMember(RBTreeBestFitFirstBlock); };
+struct RBTreeBestFitEndBlock { friend auto GetMember(RBTreeBestFitEndBlock); };
+struct RBTreeBestFitNextBlock { friend auto GetMember(RBTreeBestFitNextBlock); };
+struct RBTreeBestFitUserBuffer { friend auto GetMember(RBTreeBestFitUserBuffer); };
+struct RBTreeBestFitIsAllocated { friend auto GetMember(RBTreeBestFitIsAllocated); };
+struct SimpleSeqFitFirstBlockOffset { friend auto GetMember(SimpleSeqFitFirstBlockOffset); };
+struct SimpleSeqFitUserBuffer { friend auto GetMember(SimpleSeqFitUserBuffer); };
+template struct PrivateMember<RBTreeBestFitFirstBlock, static_cast<RBTreeBestFitAlgorithm::block_ctrl* (RBTreeBestFitAlgorithm::*)()>(&RBTreeBestFitAlgorithm::priv_first_block)>;
+template struct PrivateMember<RBTreeBestFitEndBlock, static_cast<RBTreeBestFitAlgorithm::block_ctrl* (RBTreeBestFitAlgorithm::*)()>(&RBTreeBestFitAlgorithm::priv_end_block)>;
+template struct PrivateMember<RBTreeBestFitNextBlock, &RBTreeBestFitAlgorithm::priv_next_block>;
+template struct PrivateMember<RBTreeBestFitUserBuffer, &RBTreeBestFitAlgorithm::priv_get_user_buffer>;
+template struct PrivateMember<RBTreeBestFitIsAllocated, &RBTreeBestFitAlgorithm::priv_is_allocated_block>;
+template struct PrivateMember<SimpleSeqFitFirstBlockOffset, &SimpleSeqFitImpl::priv_first_block_offset>;
+template struct PrivateMember<SimpleSeqFitUserBuffer, &SimpleSeqFitImpl::priv_get_user_buffer>;
+
+// the memory algorithm is the (private) base of the segment manager
+auto& Header(RBTreeBestFitSegment& segment) { return (*(RBTreeBestFitAlgorithm*)(segment.get_segment_manager())).*GetMember(RBTreeBestFitHeader{}); } // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+auto& Algorithm(RBTreeBestFitSegment& segment) { return *(RBTreeBestFitAlgorithm*)(segment.get_segment_manager()); } // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+auto& Algorithm(SimpleSeqFitSegment& segment) { return *(SimpleSeqFitImpl*)(SimpleSeqFitAlgorithm*)(segment.get_segment_manager()); } // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+auto& Header(SimpleSeqFitSegment& segment) { return (*(SimpleSeqFitImpl*)(SimpleSeqFitAlgorithm*)(segment.get_segment_manager())).*GetMember(SimpleSeqFitHeader{}); } // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+
+boost::interprocess::interprocess_mutex& AllocatorMutex(RBTreeBestFitSegment& segment) { return Header(segment); }
+boost::interprocess::interprocess_mutex& AllocatorMutex(SimpleSeqFitSegment& segment) { return Header(segment); }
+
+// call f(blockSize) for the free blocks (including their header), at most maxBlocks, false if not all were visited
+bool ForEachFreeBlock(RBTreeBestFitSegment& segment, const std::function<void(size_t)>& f, size_t maxBlocks)
+{
+    auto& header = Header(segment);
+    size_t visited = 0;
+    for (auto& block : header.m_imultiset) {
+        if (visited++ == maxBlocks) {
+            return false;
+        }
+        f(static_cast<size_t>(block.m_size) * RBTreeBestFitAlgorithm::Alignment);
+    }
+    return true;
+}
+
+bool ForEachFreeBlock(SimpleSeqFitSegment& segment, const std::function<void(size_t)>& f, size_t maxBlocks)
+{
+    auto& header = Header(segment);
+    size_t visited = 0;
+    for (auto block = header.m_root.m_next.get(); block != &header.m_root; block = block->m_next.get()) {
+        if (visited++ == maxBlocks) {
+            return false;
+        }
+        f(static_cast<size_t>(block->m_size) * SimpleSeqFitAlgorithm::Alignment);
+    }
+    return true;
+}
+
+// call f(ptr, size) for every allocated block: ptr as returned by the allocator, size: usable bytes
+void ForEachAllocatedBlock(RBTreeBestFitSegment& segment, const std::function<void(char*, size_t)>& f)
+{
+    auto& algo = Algorithm(segment);
+    auto* end = (algo.*GetMember(RBTreeBestFitEndBlock{}))();
+    for (auto* block = (algo.*GetMember(RBTreeBestFitFirstBlock{}))(); block != end; block = GetMember(RBTreeBestFitNextBlock{})(block)) {
+        if ((algo.*GetMember(RBTreeBestFitIsAllocated{}))(block)) {
+            char* ptr = static_cast<char*>(GetMember(RBTreeBestFitUserBuffer{})(block));
+            // the size field of the next block is usable by the allocated block as well
+            const size_t size = static_cast<size_t>(block->m_size) * RBTreeBestFitAlgorithm::Alignment + sizeof(RBTreeBestFitAlgorithm::size_type);
+            f(ptr, size - static_cast<size_t>(ptr - reinterpret_cast<char*>(block)));
+        }
+    }
+}
+
+void ForEachAllocatedBlock(SimpleSeqFitSegment& segment, const std::function<void(char*, size_t)>& f)
+{
+    auto& algo = Algorithm(segment);
+    auto& header = Header(segment);
+    using Block = std::remove_reference_t<decltype(*header.m_root.m_next)>;
+    char* base = reinterpret_cast<char*>(&algo);
+    // the blocks are contiguous, free blocks are linked into the free list, allocated ones are not
+    for (size_t offset = GetMember(SimpleSeqFitFirstBlockOffset{})(&algo, header.m_extra_hdr_bytes); offset < header.m_size;) {
+        auto* block = reinterpret_cast<Block*>(base + offset);
+        const size_t size = static_cast<size_t>(block->m_size) * SimpleSeqFitAlgorithm::Alignment;
+        if (size == 0) {
+            break;
+        }
+        if (!block->m_next) {
+            char* ptr = static_cast<char*>(GetMember(SimpleSeqFitUserBuffer{})(block));
+            f(ptr, size - static_cast<size_t>(ptr - reinterpret_cast<char*>(block)));
+        }
+        offset += size;
+    }
+}
+
+constexpr long kAllocatorLockTimeoutInMS = 1000;
+// bounds the time the allocator lock is held (blocking allocations of the devices) by a fragmentation walk
+constexpr size_t kMaxFreeBlocksPerWalk = 65536;
+
+// call f(blockSize) for the free blocks of the segment (at most kMaxFreeBlocksPerWalk), under the allocator lock
+// returns false if not all free blocks were visited
+template<typename SegmentType, typename F>
+bool ForEachFreeBlockLocked(SegmentType& segment, F&& f)
+{
+    bipc::scoped_lock<bipc::interprocess_mutex> lock(AllocatorMutex(segment), boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(kAllocatorLockTimeoutInMS));
+    if (!lock) {
+        throw Monitor::MonitorError("could not lock the segment allocator");
+    }
+    return ForEachFreeBlock(segment, f, kMaxFreeBlocksPerWalk);
+}
+
+// collect the buffers of the given segment for which pick(ptr) is true, under the allocator lock
+// (the buffers are freed after the walk, deallocation takes the allocator lock itself)
+template<typename SegmentType, typename Pick>
+vector<char*> CollectBuffersLocked(SegmentType& segment, const SegregatedFitPool* pool, Pick&& pick)
+{
+    vector<char*> buffers;
+    auto check = [&](char* ptr, size_t capacity) {
+        if (ShmHeader::Valid(ptr, capacity) && pick(ptr)) {
+            buffers.push_back(ptr);
+        }
+    };
+    using Prefix = SegregatedFitPool::BlockPrefix;
+
+    bipc::scoped_lock<bipc::interprocess_mutex> lock(AllocatorMutex(segment), boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(kAllocatorLockTimeoutInMS));
+    if (!lock) {
+        throw Monitor::MonitorError("could not lock the segment allocator");
+    }
+    ForEachAllocatedBlock(segment, [&](char* ptr, size_t size) {
+        if (!pool) {
+            check(ptr, size);
+        } else if (ptr != reinterpret_cast<const char*>(pool) && size >= sizeof(Prefix)) {
+            // segregated_fit: a large block or a slab of size class blocks, each preceded by a BlockPrefix
+            const uint32_t sizeClass = reinterpret_cast<Prefix*>(ptr)->fClass;
+            if (sizeClass == SegregatedFitPool::kLargeClass) {
+                check(ptr + sizeof(Prefix), size - sizeof(Prefix));
+            } else if (sizeClass < SegregatedFitPool::kNumClasses) {
+                const size_t blockSize = SegregatedFitPool::ClassSize(sizeClass);
+                for (size_t offset = 0; offset + blockSize <= size; offset += blockSize) {
+                    if (reinterpret_cast<Prefix*>(ptr + offset)->fClass == sizeClass) {
+                        check(ptr + offset + sizeof(Prefix), blockSize - sizeof(Prefix));
+                    }
+                }
+            }
+        }
+    });
+    return buffers;
+}
+
+#endif // FAIRMQ_SHM_BLOCK_WALK
+
+} // namespace
+
 void signalHandler(int signal)
 {
     gSignalStatus = signal;
@@ -66,6 +257,8 @@ Monitor::Monitor(string shmId, bool selfDestruct, bool interactive, bool viewOnl
     , fMonitor(monitor)
     , fSeenOnce(false)
     , fCleanOnExit(cleanOnExit)
+    , fFragmentationSampling(false)
+    , fJson(false)
     , fTimeoutInMS(timeoutInMS)
     , fIntervalInMS(intervalInMS)
     , fShmId(std::move(shmId))
@@ -186,6 +379,7 @@ bool Monitor::PrintShm(const ShmId& shmId)
 
         Uint16SegmentInfoHashMap* shmSegments = managementSegment.find<Uint16SegmentInfoHashMap>(unique_instance).first;
         std::unordered_map<uint16_t, std::variant<RBTreeBestFitSegment, SimpleSeqFitSegment>> segments;
+        std::unordered_map<uint16_t, const SegregatedFitPool*> pools;
 
         Uint16RegionInfoHashMap* shmRegions = managementSegment.find<Uint16RegionInfoHashMap>(unique_instance).first;
 
@@ -201,6 +395,11 @@ bool Monitor::PrintShm(const ShmId& shmId)
         for (const auto& s : *shmSegments) {
             if (s.second.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit) {
                 segments.emplace(s.first, RBTreeBestFitSegment(open_read_only, MakeShmName(shmId.shmId, "m", s.first).c_str()));
+            } else if (s.second.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                auto& segment = std::get<RBTreeBestFitSegment>(segments.emplace(s.first, RBTreeBestFitSegment(open_read_only, MakeShmName(shmId.shmId, "m", s.first).c_str())).first->second);
+                if (s.second.fPoolHandle != -1) {
+                    pools.emplace(s.first, static_cast<const SegregatedFitPool*>(segment.get_address_from_handle(s.second.fPoolHandle)));
+                }
             } else {
                 segments.emplace(s.first, SimpleSeqFitSegment(open_read_only, MakeShmName(shmId.shmId, "m", s.first).c_str()));
             }
@@ -222,6 +421,7 @@ bool Monitor::PrintShm(const ShmId& shmId)
 #ifdef FAIRMQ_DEBUG_MODE
         Uint16MsgCounterHashMap* msgCounters = managementSegment.find<Uint16MsgCounterHashMap>(unique_instance).first;
 #endif
+        const ShmAccounting* accounting = managementSegment.find<ShmAccounting>(unique_instance).first;
 
         stringstream ss;
         size_t mfree = managementSegment.get_free_memory();
@@ -237,7 +437,12 @@ bool Monitor::PrintShm(const ShmId& shmId)
         for (const auto& s : segments) {
             size_t free = std::visit([](auto& seg){ return seg.get_free_memory(); }, s.second);
             size_t total = std::visit([](auto& seg){ return seg.get_size(); }, s.second);
-            size_t used = total - free;
+            size_t cached = 0;
+            auto pool = pools.find(s.first);
+            if (pool != pools.end()) {
+                cached = pool->second->GetCachedMemory();
+            }
+            size_t used = total - free - cached;
 
             std::string msgCount;
 #ifdef FAIRMQ_DEBUG_MODE
@@ -250,15 +455,35 @@ bool Monitor::PrintShm(const ShmId& shmId)
                 }
             }
 #else
-            msgCount = "NODEBUG";
+            if (accounting) {
+                uint64_t outstanding = 0;
+                for (const auto& p : accounting->fProcesses) {
+                    if (p.fPid.load(std::memory_order_acquire) > 0 && p.fSegmentId.load(std::memory_order_relaxed) == s.first) {
+                        outstanding += p.Outstanding();
+                    }
+                }
+                msgCount = to_string(outstanding);
+            } else {
+                msgCount = "n/a";
+            }
 #endif
 
             ss << "   [" << s.first << "]"
                << ": total: " << total
                << ", msgs: " << msgCount
-               << ", free: " << free
-               << ", used: " << used
+               << ", free: " << free;
+            if (pool != pools.end()) {
+                ss << ", cached: " << cached;
+            }
+            ss << ", used: " << used
                << "\n";
+            if (pool != pools.end()) {
+                ss << "      size classes (block size: blocks total/free):";
+                for (const auto& c : pool->second->GetStats()) {
+                    ss << " " << c.size << ": " << c.total << "/" << c.free;
+                }
+                ss << "\n";
+            }
         }
 
         ss << "   [m]: "
@@ -396,6 +621,13 @@ void Monitor::Interactive()
                 case 'b':
                     PrintDebugInfo(ShmId{fShmId});
                     break;
+                case 'a':
+                    PrintAccountingInfo(ShmId{fShmId});
+                    break;
+                case 'f':
+                    fFragmentationSampling = !fFragmentationSampling;
+                    LOG(info) << "\n[f] --> fragmentation sampling " << (fFragmentationSampling ? "on" : "off");
+                    break;
                 default:
                     LOG(info) << "\n[" << c << "] --> invalid input.";
                     break;
@@ -411,6 +643,9 @@ void Monitor::Interactive()
         }
 
         PrintShm(ShmId{fShmId});
+        if (fFragmentationSampling) {
+            PrintFragmentationInfo(ShmId{fShmId}, fJson);
+        }
     }
 }
 
@@ -420,8 +655,8 @@ void Monitor::PrintDebugInfo(const ShmId& shmId __attribute__((unused)))
     string managementSegmentName = MakeShmName(shmId.shmId, "mng");
     try {
         bipc::managed_shared_memory managementSegment(bipc::open_only, managementSegmentName.c_str());
-        bipc::interprocess_mutex* mtx(managementSegment.find_or_construct<bipc::interprocess_mutex>(bipc::unique_instance)());
-        bipc::scoped_lock<bipc::interprocess_mutex> lock(*mtx);
+        ManagementLocks* locks = managementSegment.find_or_construct<ManagementLocks>(bipc::unique_instance)();
+        bipc::scoped_lock<bipc::interprocess_mutex> lock(locks->fDebugMtx);
 
         Uint16MsgDebugMapHashMap* debug = managementSegment.find<Uint16MsgDebugMapHashMap>(bipc::unique_instance).first;
 
@@ -472,8 +707,8 @@ unordered_map<uint16_t, std::vector<BufferDebugInfo>> Monitor::GetDebugInfo(cons
     string managementSegmentName = MakeShmName(shmId.shmId, "mng");
     try {
         bipc::managed_shared_memory managementSegment(bipc::open_only, managementSegmentName.c_str());
-        bipc::interprocess_mutex* mtx(managementSegment.find_or_construct<bipc::interprocess_mutex>(bipc::unique_instance)());
-        bipc::scoped_lock<bipc::interprocess_mutex> lock(*mtx);
+        ManagementLocks* locks = managementSegment.find_or_construct<ManagementLocks>(bipc::unique_instance)();
+        bipc::scoped_lock<bipc::interprocess_mutex> lock(locks->fDebugMtx);
 
         Uint16MsgDebugMapHashMap* debug = managementSegment.find<Uint16MsgDebugMapHashMap>(bipc::unique_instance).first;
 
@@ -505,13 +740,423 @@ unordered_map<uint16_t, std::vector<BufferDebugInfo>> Monitor::GetDebugInfo(cons
     return GetDebugInfo(shmId);
 }
 
+vector<ProcessAccountingInfo> Monitor::GetAccountingInfo(const ShmId& shmId)
+{
+    vector<ProcessAccountingInfo> result;
+
+    try {
+        bipc::managed_shared_memory managementSegment(bipc::open_read_only, MakeShmName(shmId.shmId, "mng").c_str());
+        const ShmAccounting* accounting = managementSegment.find<ShmAccounting>(bipc::unique_instance).first;
+        if (!accounting) {
+            return result;
+        }
+
+        for (uint16_t slot = 0; slot < ShmAccounting::kMaxProcesses; ++slot) {
+            const auto& p = accounting->fProcesses[slot];
+            int32_t pid = p.fPid.load(memory_order_acquire);
+            if (pid <= 0) {
+                continue;
+            }
+            ProcessAccountingInfo info{pid, accounting->SlotAlive(slot), p.fHeartbeat.load(memory_order_relaxed), p.fSegmentId.load(memory_order_relaxed), 0, 0,
+                                       p.fBytes.load(memory_order_relaxed), p.fPeakBytes.load(memory_order_relaxed), {}, 0, 0, false};
+            for (size_t c = 0; c < ShmAccounting::kNumSizeClasses; ++c) {
+                info.fAllocations += p.fAllocations[c].load(memory_order_relaxed);
+                uint64_t outstanding = p.Outstanding(c);
+                if (outstanding > 0) {
+                    info.fOutstanding += outstanding;
+                    info.fOutstandingBySize.emplace_back(ShmAccounting::SizeClassLimit(c), outstanding);
+                }
+            }
+
+            uint32_t oldestMinute = 0;
+            for (size_t i = 0; i < ShmAccounting::kAgeSlots; ++i) {
+                uint32_t minute = p.fAgeMinute[i].load(memory_order_relaxed);
+                int64_t count = p.fAgeCount[i].load(memory_order_relaxed);
+                if (count > 0 && (oldestMinute == 0 || minute < oldestMinute)) {
+                    oldestMinute = minute;
+                    info.fNumOldest = count;
+                }
+            }
+            int64_t older = p.fOlder.load(memory_order_relaxed);
+            if (older > 0) {
+                info.fOlderThanTracked = true;
+                info.fNumOldest = older;
+            }
+            info.fOldestCreationTime = uint64_t(oldestMinute) * 60;
+            result.push_back(std::move(info));
+        }
+    } catch (bie&) {
+        LOG(info) << "no segments found";
+    }
+
+    return result;
+}
+
+vector<ProcessAccountingInfo> Monitor::GetAccountingInfo(const SessionId& sessionId)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    return GetAccountingInfo(shmId);
+}
+
+vector<BudgetInfo> Monitor::GetBudgetInfo(const ShmId& shmId)
+{
+    vector<BudgetInfo> result;
+
+    try {
+        bipc::managed_shared_memory managementSegment(bipc::open_read_only, MakeShmName(shmId.shmId, "mng").c_str());
+        const ShmBudgets* budgets = managementSegment.find<ShmBudgets>(bipc::unique_instance).first;
+        if (!budgets) {
+            return result;
+        }
+
+        for (uint16_t i = 0; i < ShmBudgets::kMaxBudgets; ++i) {
+            const auto& b = budgets->fBudgets[i];
+            int32_t pid = b.fPid.load(memory_order_acquire);
+            if (pid <= 0) {
+                continue;
+            }
+            result.push_back(BudgetInfo{pid, budgets->Alive(i), b.fName,
+                                        b.fLimit.load(memory_order_relaxed), b.fBytes.load(memory_order_relaxed), b.fPeakBytes.load(memory_order_relaxed),
+                                        b.fBlocked.load(memory_order_relaxed), b.fFailed.load(memory_order_relaxed), b.fDropped.load(memory_order_relaxed)});
+        }
+    } catch (bie&) {
+        LOG(info) << "no segments found";
+    }
+
+    return result;
+}
+
+vector<BudgetInfo> Monitor::GetBudgetInfo(const SessionId& sessionId)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    return GetBudgetInfo(shmId);
+}
+
+void Monitor::PrintAccountingInfo(const ShmId& shmId)
+{
+    vector<ProcessAccountingInfo> infos = GetAccountingInfo(shmId);
+    if (infos.empty()) {
+        LOG(info) << "no accounting data found";
+        return;
+    }
+    // biggest consumers first
+    sort(infos.begin(), infos.end(), [](const auto& a, const auto& b) { return a.fBytes > b.fBytes; });
+
+    stringstream ss;
+    ss << "\nbuffer accounting per process:";
+    for (const auto& i : infos) {
+        ss << "\n   pid " << i.fPid;
+        if (!i.fAlive) {
+            time_t t = static_cast<time_t>(i.fLastHeartbeat);
+            auto tm = localtime(&t);
+            ss << " (dead, last seen at " << setfill('0') << setw(2) << tm->tm_hour << ":" << setw(2) << tm->tm_min << ":" << setw(2) << tm->tm_sec << setfill(' ') << ")";
+        }
+        ss << ", segment: " << i.fSegmentId
+           << ", allocations: " << i.fAllocations
+           << ", outstanding: " << i.fOutstanding
+           << ", bytes: " << i.fBytes
+           << ", peak bytes: " << i.fPeakBytes;
+        if (i.fOutstanding > 0) {
+            ss << "\n      outstanding by size (<= bytes: buffers):";
+            for (const auto& [limit, count] : i.fOutstandingBySize) {
+                ss << " " << (limit == 0 ? string("more") : to_string(limit)) << ": " << count;
+            }
+            if (i.fNumOldest > 0) {
+                time_t t = static_cast<time_t>(i.fOldestCreationTime);
+                auto tm = localtime(&t);
+                ss << "\n      oldest outstanding: " << i.fNumOldest << " buffers created "
+                   << (i.fOlderThanTracked ? "before " : "at ") << setfill('0')
+                   << setw(2) << tm->tm_hour << ":" << setw(2) << tm->tm_min << setfill(' ');
+            }
+        }
+    }
+    vector<BudgetInfo> budgets = GetBudgetInfo(shmId);
+    if (!budgets.empty()) {
+        ss << "\nbudgets:";
+        for (const auto& b : budgets) {
+            ss << "\n   pid " << b.fPid << (b.fAlive ? "" : " (dead)")
+               << ", " << (b.fChannel.empty() ? string("device") : "channel '" + b.fChannel + "'")
+               << ", limit: " << b.fLimit
+               << ", bytes: " << b.fBytes
+               << ", peak bytes: " << b.fPeakBytes
+               << ", blocked: " << b.fBlocked
+               << ", failed: " << b.fFailed
+               << ", dropped: " << b.fDropped;
+        }
+    }
+    LOG(info) << ss.str();
+}
+
+void Monitor::PrintAccountingInfo(const SessionId& sessionId)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    PrintAccountingInfo(shmId);
+}
+
+ReclaimInfo Monitor::ReclaimDeadBuffers(const ShmId& shmId, unsigned int minAgeInS, bool verbose)
+{
+#ifndef FAIRMQ_SHM_BLOCK_WALK
+    (void)minAgeInS;
+    (void)verbose;
+    throw MonitorError(tools::ToString("cannot reclaim the buffers of session ", shmId.shmId, ": walking the segment blocks is not built in (FAIRMQ_SHM_BLOCK_WALK=OFF)"));
+#else
+    ReclaimInfo result{{}, 0, 0, 0};
+
+    try {
+        bipc::managed_shared_memory managementSegment(bipc::open_only, MakeShmName(shmId.shmId, "mng").c_str());
+        ShmAccounting* accounting = managementSegment.find<ShmAccounting>(bipc::unique_instance).first;
+        ShmBudgets* budgets = managementSegment.find<ShmBudgets>(bipc::unique_instance).first;
+        Uint16SegmentInfoHashMap* segmentInfos = managementSegment.find<Uint16SegmentInfoHashMap>(bipc::unique_instance).first;
+        if (!accounting || !segmentInfos) {
+            return result;
+        }
+
+        FreeMemoryNotifier* notifier = managementSegment.find<FreeMemoryNotifier>(bipc::unique_instance).first;
+
+        vector<bool> dead(ShmAccounting::kMaxProcesses, false);
+        for (uint16_t slot = 0; slot < ShmAccounting::kMaxProcesses; ++slot) {
+            const auto& p = accounting->fProcesses[slot];
+            int32_t pid = p.fPid.load(memory_order_acquire);
+            if (pid > 0 && !accounting->SlotAlive(slot)) {
+                if (notifier && p.fWaiting.load(memory_order_relaxed) > 0) {
+                    // the process died while waiting for free memory
+                    accounting->ReleaseWaiters(slot, *notifier);
+                }
+                if (p.Outstanding() > 0) {
+                    dead[slot] = true;
+                    result.fDeadPids.push_back(pid);
+                }
+            }
+        }
+        if (result.fDeadPids.empty()) {
+            return result;
+        }
+
+        const uint32_t maxCreationTime = ShmAccounting::Now() - minAgeInS;
+        auto pick = [&](char* ptr) {
+            const ShmHeader::Hdr& hdr = ShmHeader::Header(ptr);
+            uint16_t owner = hdr.owner.load(memory_order_relaxed);
+            if (owner >= ShmAccounting::kMaxProcesses || !dead[owner]) {
+                return false;
+            }
+            if (hdr.creationTime > maxCreationTime) {
+                ++result.fSkipped;
+                return false;
+            }
+            return true;
+        };
+        auto reclaim = [&](const vector<char*>& buffers, auto&& deallocate) {
+            for (char* ptr : buffers) {
+                ShmHeader::Hdr& hdr = ShmHeader::Header(ptr);
+                uint16_t owner = hdr.owner.load(memory_order_relaxed);
+                // claim the buffer, skip it if it has been taken over in the meantime
+                if (owner >= ShmAccounting::kMaxProcesses || !dead[owner] || !hdr.owner.compare_exchange_strong(owner, ShmAccounting::kReclaimed)) {
+                    continue;
+                }
+                accounting->OnDeallocate(owner, hdr.SizeClass(), hdr.Size(), hdr.creationTime);
+                if (budgets) {
+                    budgets->Discharge(hdr.Budget(), hdr.Size());
+                }
+                ++result.fBuffers;
+                result.fBytes += hdr.Size();
+                ShmHeader::Destruct(ptr);
+                deallocate(ptr);
+            }
+        };
+
+        for (const auto& [id, info] : *segmentInfos) {
+            if (info.fAllocationAlgorithm == AllocationAlgorithm::simple_seq_fit) {
+                SimpleSeqFitSegment segment(bipc::open_only, MakeShmName(shmId.shmId, "m", id).c_str());
+                reclaim(CollectBuffersLocked(segment, nullptr, pick), [&](char* ptr) { segment.deallocate(ptr); });
+            } else {
+                RBTreeBestFitSegment segment(bipc::open_only, MakeShmName(shmId.shmId, "m", id).c_str());
+                SegregatedFitPool* pool = nullptr;
+                if (info.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit && info.fPoolHandle != -1) {
+                    pool = static_cast<SegregatedFitPool*>(segment.get_address_from_handle(info.fPoolHandle));
+                }
+                reclaim(CollectBuffersLocked(segment, pool, pick), [&](char* ptr) {
+                    if (pool) {
+                        pool->Deallocate(segment, ptr);
+                    } else {
+                        segment.deallocate(ptr);
+                    }
+                });
+            }
+        }
+
+        if (result.fBuffers > 0 && notifier) {
+            // wake up allocations waiting for free memory
+            notifier->Notify();
+        }
+    } catch (bie& e) {
+        LOG(debug) << "could not open shared memory segments: " << e.what();
+    }
+
+    if (verbose) {
+        stringstream ss;
+        ss << "reclaimed " << result.fBuffers << " buffers (" << result.fBytes << " bytes) of " << result.fDeadPids.size() << " dead processes";
+        for (size_t i = 0; i < result.fDeadPids.size(); ++i) {
+            ss << (i == 0 ? ": " : ", ") << result.fDeadPids[i];
+        }
+        if (result.fSkipped > 0) {
+            ss << ", skipped " << result.fSkipped << " buffers younger than " << minAgeInS << " s";
+        }
+        LOG(info) << ss.str();
+    }
+
+    return result;
+#endif // FAIRMQ_SHM_BLOCK_WALK
+}
+
+ReclaimInfo Monitor::ReclaimDeadBuffers(const SessionId& sessionId, unsigned int minAgeInS, bool verbose)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    return ReclaimDeadBuffers(shmId, minAgeInS, verbose);
+}
+
+vector<SegmentFragmentationInfo> Monitor::GetFragmentationInfo(const ShmId& shmId)
+{
+    vector<SegmentFragmentationInfo> result;
+
+    try {
+        bipc::managed_shared_memory managementSegment(bipc::open_read_only, MakeShmName(shmId.shmId, "mng").c_str());
+        Uint16SegmentInfoHashMap* segmentInfos = managementSegment.find<Uint16SegmentInfoHashMap>(bipc::unique_instance).first;
+        if (!segmentInfos) {
+            return result;
+        }
+
+        for (const auto& [id, info] : *segmentInfos) {
+            SegmentFragmentationInfo frag{id, "", 0, 0, 0, 0, 0, 0., {}, false};
+            vector<size_t> histogram(64, 0);
+            auto analyze = [&](auto& segment) {
+                frag.fSize = segment.get_size();
+                frag.fFreeMemory = segment.get_free_memory();
+                frag.fLargestFreeBlock = ProbeLargestFreeBlock(segment);
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+                frag.fSampled = !ForEachFreeBlockLocked(segment, [&](size_t size) {
+                    ++frag.fNumFreeBlocks;
+                    ++histogram.at(size <= 1 ? 0 : 64 - __builtin_clzll(size - 1)); // ceil(log2(size))
+                });
+#endif
+            };
+
+            // the probe allocates, the segment has to be opened read/write
+            if (info.fAllocationAlgorithm == AllocationAlgorithm::simple_seq_fit) {
+                SimpleSeqFitSegment segment(bipc::open_only, MakeShmName(shmId.shmId, "m", id).c_str());
+                frag.fAllocationAlgorithm = "simple_seq_fit";
+                analyze(segment);
+            } else {
+                RBTreeBestFitSegment segment(bipc::open_only, MakeShmName(shmId.shmId, "m", id).c_str());
+                if (info.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                    frag.fAllocationAlgorithm = "segregated_fit";
+                    if (info.fPoolHandle != -1) {
+                        frag.fCachedMemory = static_cast<const SegregatedFitPool*>(segment.get_address_from_handle(info.fPoolHandle))->GetCachedMemory();
+                    }
+                } else {
+                    frag.fAllocationAlgorithm = "rbtree_best_fit";
+                }
+                analyze(segment);
+            }
+
+            if (frag.fFreeMemory > 0) {
+                frag.fFragmentation = max(0., 1. - static_cast<double>(frag.fLargestFreeBlock) / static_cast<double>(frag.fFreeMemory));
+            }
+            for (size_t i = 0; i < histogram.size(); ++i) {
+                if (histogram[i] > 0) {
+                    frag.fFreeBlockHistogram.emplace_back(size_t(1) << i, histogram[i]);
+                }
+            }
+            result.push_back(std::move(frag));
+        }
+    } catch (bie& e) {
+        LOG(debug) << "could not open shared memory segments: " << e.what();
+    }
+
+    return result;
+}
+
+vector<SegmentFragmentationInfo> Monitor::GetFragmentationInfo(const SessionId& sessionId)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    return GetFragmentationInfo(shmId);
+}
+
+void Monitor::PrintFragmentationInfo(const ShmId& shmId, bool json)
+{
+    vector<SegmentFragmentationInfo> infos;
+    try {
+        infos = GetFragmentationInfo(shmId);
+    } catch (MonitorError& e) {
+        LOG(error) << "could not analyze segment fragmentation: " << e.what();
+        return;
+    }
+
+    stringstream ss;
+    if (json) {
+        ss << "{\"shmId\":\"" << shmId.shmId << "\""
+           << ",\"time\":" << chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count()
+           << ",\"segments\":[";
+        for (size_t i = 0; i < infos.size(); ++i) {
+            const auto& f = infos[i];
+            ss << (i > 0 ? "," : "") << "{\"id\":" << f.fSegmentId
+               << ",\"algorithm\":\"" << f.fAllocationAlgorithm << "\""
+               << ",\"size\":" << f.fSize
+               << ",\"free\":" << f.fFreeMemory
+               << ",\"cached\":" << f.fCachedMemory
+               << ",\"freeBlocks\":" << f.fNumFreeBlocks
+               << ",\"largestFreeBlock\":" << f.fLargestFreeBlock
+               << ",\"fragmentation\":" << f.fFragmentation
+               << ",\"sampled\":" << (f.fSampled ? "true" : "false")
+               << ",\"histogram\":[";
+            for (size_t j = 0; j < f.fFreeBlockHistogram.size(); ++j) {
+                ss << (j > 0 ? "," : "") << "{\"upTo\":" << f.fFreeBlockHistogram[j].first << ",\"count\":" << f.fFreeBlockHistogram[j].second << "}";
+            }
+            ss << "]}";
+        }
+        ss << "]}";
+        // machine readable output goes to stdout without logger decoration
+        cout << ss.str() << endl;
+        return;
+    }
+
+    if (infos.empty()) {
+        LOG(info) << "no segments found";
+        return;
+    }
+    ss << "\nfragmentation of managed segments:";
+    for (const auto& f : infos) {
+        ss << "\n   [" << f.fSegmentId << "] " << f.fAllocationAlgorithm
+           << ": free: " << f.fFreeMemory;
+        if (f.fAllocationAlgorithm == "segregated_fit") {
+            ss << " (+ " << f.fCachedMemory << " cached in size classes)";
+        }
+        ss << ", largest free block: " << f.fLargestFreeBlock
+           << ", fragmentation: " << fixed << setprecision(3) << f.fFragmentation << defaultfloat;
+        if (f.fNumFreeBlocks > 0) {
+            ss << ", free blocks: " << f.fNumFreeBlocks
+               << (f.fSampled ? " (sampled, the free list is longer than the walked part)" : "")
+               << "\n      free blocks by size (<= bytes: blocks):";
+            for (const auto& [limit, count] : f.fFreeBlockHistogram) {
+                ss << " " << limit << ": " << count;
+            }
+        }
+    }
+    LOG(info) << ss.str();
+}
+
+void Monitor::PrintFragmentationInfo(const SessionId& sessionId, bool json)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    PrintFragmentationInfo(shmId, json);
+}
+
 unsigned long Monitor::GetFreeMemory(const ShmId& shmId, uint16_t segmentId)
 {
     using namespace boost::interprocess;
     try {
         bipc::managed_shared_memory managementSegment(bipc::open_only, MakeShmName(shmId.shmId, "mng").c_str());
-        boost::interprocess::interprocess_mutex* mtx(managementSegment.find_or_construct<bipc::interprocess_mutex>(bipc::unique_instance)());
-        boost::interprocess::scoped_lock<bipc::interprocess_mutex> lock(*mtx);
+        ManagementLocks* locks = managementSegment.find_or_construct<ManagementLocks>(bipc::unique_instance)();
+        boost::interprocess::scoped_lock<bipc::interprocess_mutex> lock(locks->fSegmentsMtx);
 
         Uint16SegmentInfoHashMap* shmSegments = managementSegment.find<Uint16SegmentInfoHashMap>(unique_instance).first;
 
@@ -525,6 +1170,9 @@ unsigned long Monitor::GetFreeMemory(const ShmId& shmId, uint16_t segmentId)
             if (it->second.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit) {
                 RBTreeBestFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
                 return segment.get_free_memory();
+            } else if (it->second.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                RBTreeBestFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
+                return segment.get_free_memory();
             } else {
                 SimpleSeqFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
                 return segment.get_free_memory();
@@ -544,6 +1192,43 @@ unsigned long Monitor::GetFreeMemory(const SessionId& sessionId, uint16_t segmen
     return GetFreeMemory(shmId, segmentId);
 }
 
+unsigned long Monitor::GetCachedMemory(const ShmId& shmId, uint16_t segmentId)
+{
+    using namespace boost::interprocess;
+    try {
+        bipc::managed_shared_memory managementSegment(bipc::open_only, MakeShmName(shmId.shmId, "mng").c_str());
+        ManagementLocks* locks = managementSegment.find_or_construct<ManagementLocks>(bipc::unique_instance)();
+        boost::interprocess::scoped_lock<bipc::interprocess_mutex> lock(locks->fSegmentsMtx);
+
+        Uint16SegmentInfoHashMap* shmSegments = managementSegment.find<Uint16SegmentInfoHashMap>(unique_instance).first;
+
+        if (!shmSegments) {
+            LOG(error) << "Found management segment, but could not locate segment info";
+            throw MonitorError("Found management segment, but could not locate segment info");
+        }
+
+        auto it = shmSegments->find(segmentId);
+        if (it != shmSegments->end()) {
+            if (it->second.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit && it->second.fPoolHandle != -1) {
+                RBTreeBestFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
+                return static_cast<const SegregatedFitPool*>(segment.get_address_from_handle(it->second.fPoolHandle))->GetCachedMemory();
+            }
+            return 0;
+        } else {
+            LOG(error) << "Could not find segment id '" << segmentId << "'";
+            throw MonitorError(tools::ToString("Could not find segment id '", segmentId, "'"));
+        }
+    } catch (bie&) {
+        LOG(error) << "Could not find management segment for shmid '" << shmId.shmId << "'";
+        throw MonitorError(tools::ToString("Could not find management segment for shmid '", shmId.shmId, "'"));
+    }
+}
+unsigned long Monitor::GetCachedMemory(const SessionId& sessionId, uint16_t segmentId)
+{
+    ShmId shmId{makeShmIdStr(sessionId.sessionId)};
+    return GetCachedMemory(shmId, segmentId);
+}
+
 bool Monitor::SegmentIsPresent(const ShmId& shmId, uint16_t segmentId)
 {
     using namespace boost::interprocess;
@@ -559,7 +1244,8 @@ bool Monitor::SegmentIsPresent(const ShmId& shmId, uint16_t segmentId)
         auto it = shmSegments->find(segmentId);
         if (it != shmSegments->end()) {
             try {
-                if (it->second.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit) {
+                if (it->second.fAllocationAlgorithm == AllocationAlgorithm::rbtree_best_fit
+                 || it->second.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
                     RBTreeBestFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
                 } else {
                     SimpleSeqFitSegment segment(open_read_only, MakeShmName(shmId.shmId, "m", segmentId).c_str());
@@ -630,6 +1316,8 @@ void Monitor::PrintHelp()
 {
     LOG(info) << "controls: [x] close memory, "
               << "[b] print a list of allocated messages (only available when compiled with FAIMQ_DEBUG_MODE=ON), "
+              << "[a] print buffer accounting per process, "
+              << "[f] toggle periodic output of the segment fragmentation, "
               << "[h] help, "
               << "[q] quit.";
 }
@@ -756,7 +1444,7 @@ void Monitor::ResetContent(const ShmId& shmIdT, bool verbose /* = true */)
         Uint16SegmentInfoHashMap* segmentInfos = managementSegment.find<Uint16SegmentInfoHashMap>(unique_instance).first;
         if (segmentInfos) {
             cout << "Found info for " << segmentInfos->size() << " managed segments" << endl;
-            for (const auto& [id, info] : *segmentInfos) {
+            for (auto& [id, info] : *segmentInfos) {
                 if (verbose) {
                     cout << "Resetting content of segment '" << MakeShmName(shmId, "m", id) << "'..." << endl;
                 }
@@ -766,6 +1454,13 @@ void Monitor::ResetContent(const ShmId& shmIdT, bool verbose /* = true */)
                         void* ptr = segment.get_segment_manager();
                         size_t size = segment.get_segment_manager()->get_size();
                         new(ptr) segment_manager<char, rbtree_best_fit<mutex_family, offset_ptr<void>>, null_index>(size);
+                    } else if (info.fAllocationAlgorithm == AllocationAlgorithm::segregated_fit) {
+                        RBTreeBestFitSegment segment(open_only, MakeShmName(shmId, "m", id).c_str());
+                        void* ptr = segment.get_segment_manager();
+                        size_t size = segment.get_segment_manager()->get_size();
+                        new(ptr) segment_manager<char, rbtree_best_fit<mutex_family, offset_ptr<void>>, null_index>(size);
+                        // the pool lived in the segment, recreate it
+                        info.fPoolHandle = segment.get_handle_from_address(SegregatedFitPool::Create(segment));
                     } else {
                         SimpleSeqFitSegment segment(open_only, MakeShmName(shmId, "m", id).c_str());
                         void* ptr = segment.get_segment_manager();
@@ -785,6 +1480,17 @@ void Monitor::ResetContent(const ShmId& shmIdT, bool verbose /* = true */)
             cout << "Found management segment, but cannot locate segment info, something went wrong..." << endl;
         }
 
+        // all buffers are gone, restart the accounting
+        if (ShmAccounting* accounting = managementSegment.find<ShmAccounting>(unique_instance).first; accounting) {
+            new (accounting) ShmAccounting();
+        }
+        // budgets stay registered (their owners keep charging them), only the charged bytes are gone
+        if (ShmBudgets* budgets = managementSegment.find<ShmBudgets>(unique_instance).first; budgets) {
+            for (auto& b : budgets->fBudgets) {
+                b.fBytes.store(0, memory_order_relaxed);
+            }
+        }
+
         Uint16RegionInfoHashMap* shmRegions = managementSegment.find<Uint16RegionInfoHashMap>(bipc::unique_instance).first;
         if (shmRegions) {
             for (const auto& region : *shmRegions) {
@@ -820,20 +1526,30 @@ void Monitor::ResetContent(const ShmId& shmIdT, const std::vector<SegmentConfig>
 
     std::string shmId = shmIdT.shmId;
     std::string managementSegmentName = MakeShmName(shmId, "mng");
+    // keep the size of the management segment, as configured by the session creator (shm-mng-segment-size)
+    size_t mngSegmentSize = kManagementSegmentSize;
+    try {
+        managed_shared_memory existing(open_read_only, managementSegmentName.c_str());
+        mngSegmentSize = existing.get_size();
+    } catch (bie&) {
+        LOG(debug) << "no management segment found, recreating it with the default size";
+    }
     // delete management segment
     cout << "deleting management segment" << endl;
     Remove<bipc::shared_memory_object>(managementSegmentName, verbose);
     // recreate management segment
     cout << "recreating management segment..." << endl;
-    managed_shared_memory mngSegment(create_only, managementSegmentName.c_str(), kManagementSegmentSize);
+    managed_shared_memory mngSegment(create_only, managementSegmentName.c_str(), mngSegmentSize);
     cout << "done." << endl;
     // fill management segment with segment & region infos
     cout << "filling management segment with managed segment configs..." << endl;
     for (const auto& s : segmentCfgs) {
         if (s.allocationAlgorithm == "rbtree_best_fit") {
-            Segment::Register(shmId, s.id, AllocationAlgorithm::rbtree_best_fit);
+            Segment::Register(shmId, s.id, AllocationAlgorithm::rbtree_best_fit, mngSegmentSize);
         } else if (s.allocationAlgorithm == "simple_seq_fit") {
-            Segment::Register(shmId, s.id, AllocationAlgorithm::simple_seq_fit);
+            Segment::Register(shmId, s.id, AllocationAlgorithm::simple_seq_fit, mngSegmentSize);
+        } else if (s.allocationAlgorithm == "segregated_fit") {
+            Segment::Register(shmId, s.id, AllocationAlgorithm::segregated_fit, mngSegmentSize); // the pool is created by ResetContent below
         } else {
             LOG(error) << "Unknown allocation algorithm provided: " << s.allocationAlgorithm;
             throw MonitorError("Unknown allocation algorithm provided: " + s.allocationAlgorithm);
@@ -842,7 +1558,7 @@ void Monitor::ResetContent(const ShmId& shmIdT, const std::vector<SegmentConfig>
     cout << "done." << endl;
     cout << "filling management segment with unmanaged region configs..." << endl;
     for (const auto& r : regionCfgs) {
-        fair::mq::shmem::UnmanagedRegion::Register(shmId, r);
+        fair::mq::shmem::UnmanagedRegion::Register(shmId, r, mngSegmentSize);
     }
     cout << "done." << endl;
     // reset managed segments
@@ -51,6 +51,57 @@ struct BufferDebugInfo
     uint64_t fCreationTime;
 };
 
+struct ProcessAccountingInfo
+{
+    pid_t fPid;
+    bool fAlive;
+    uint64_t fLastHeartbeat; // seconds since epoch
+    uint16_t fSegmentId; // segment the process allocates in
+    uint64_t fAllocations; // total number of allocated buffers
+    uint64_t fOutstanding; // number of buffers not yet freed
+    uint64_t fBytes; // outstanding bytes
+    uint64_t fPeakBytes;
+    std::vector<std::pair<size_t, uint64_t>> fOutstandingBySize; // (size class upper limit in bytes, 0 = unlimited; outstanding buffers), non-empty classes only
+    uint64_t fOldestCreationTime; // creation minute of the oldest outstanding buffers (seconds since epoch), 0 if none
+    uint64_t fNumOldest; // number of outstanding buffers created in that minute
+    bool fOlderThanTracked; // oldest outstanding buffers are older than the tracked age range (fOldestCreationTime is an upper bound)
+};
+
+struct BudgetInfo
+{
+    pid_t fPid;
+    bool fAlive;
+    std::string fChannel; // channel name, empty for the device budget
+    uint64_t fLimit; // bytes
+    uint64_t fBytes; // charged bytes
+    uint64_t fPeakBytes;
+    uint64_t fBlocked; // allocations that waited for the budget
+    uint64_t fFailed; // allocations that failed because of the budget
+    uint64_t fDropped; // messages dropped because of the budget
+};
+
+struct SegmentFragmentationInfo
+{
+    uint16_t fSegmentId;
+    std::string fAllocationAlgorithm;
+    size_t fSize; // segment size
+    size_t fFreeMemory; // free memory of the underlying allocator
+    size_t fCachedMemory; // free memory cached in size classes (segregated_fit only), not part of the free blocks
+    size_t fNumFreeBlocks; // 0 if the free blocks are not walked (built without FAIRMQ_SHM_BLOCK_WALK)
+    size_t fLargestFreeBlock; // largest allocatable buffer in bytes (probed with allocations, within 64 bytes)
+    double fFragmentation; // 1 - largest free block / free memory: 0 - all free memory is contiguous, towards 1 - scattered
+    std::vector<std::pair<size_t, size_t>> fFreeBlockHistogram; // (block size upper limit (power of 2), number of free blocks), non-empty buckets only
+    bool fSampled; // true if the free list was too long to be walked completely (bounding the allocator lock time): block count and histogram cover the walked part only
+};
+
+struct ReclaimInfo
+{
+    std::vector<pid_t> fDeadPids; // dead processes that held buffers
+    uint64_t fBuffers; // number of reclaimed buffers
+    uint64_t fBytes; // reclaimed bytes
+    uint64_t fSkipped; // buffers of dead processes younger than the minimum age, left in place
+};
+
 struct SegmentConfig
 {
     uint16_t id;
@@ -72,6 +123,9 @@ class Monitor
     void CatchSignals();
     void Run();
 
+    /// @brief output the segment fragmentation at every interval (interactive mode, toggled with [f])
+    void SetFragmentationSampling(bool enabled, bool json = false) { fFragmentationSampling = enabled; fJson = json; }
+
     /// @brief Cleanup all shared memory artifacts created by devices
     /// @param shmId shared memory id
     /// @param verbose output cleanup results to stdout
@@ -118,16 +172,86 @@ class Monitor
     /// @brief Returns a list of messages in shmem (if compiled with FAIRMQ_DEBUG_MODE=ON)
     /// @param sessionId session id
     static std::unordered_map<uint16_t, std::vector<BufferDebugInfo>> GetDebugInfo(const SessionId& sessionId);
+    /// @brief Outputs the buffer accounting per process (live usage, size histogram, oldest outstanding buffers) and the budgets
+    /// @param shmId shmem id
+    static void PrintAccountingInfo(const ShmId& shmId);
+    /// @brief Outputs the buffer accounting per process (live usage, size histogram, oldest outstanding buffers) and the budgets
+    /// @param sessionId session id
+    static void PrintAccountingInfo(const SessionId& sessionId);
+    /// @brief Returns the buffer accounting per process
+    /// @param shmId shmem id
+    static std::vector<ProcessAccountingInfo> GetAccountingInfo(const ShmId& shmId);
+    /// @brief Returns the buffer accounting per process
+    /// @param sessionId session id
+    static std::vector<ProcessAccountingInfo> GetAccountingInfo(const SessionId& sessionId);
+    /// @brief Returns the device and channel budgets (quotas) of the managed segment allocations
+    /// @param shmId shmem id
+    static std::vector<BudgetInfo> GetBudgetInfo(const ShmId& shmId);
+    /// @brief Returns the device and channel budgets (quotas) of the managed segment allocations
+    /// @param sessionId session id
+    static std::vector<BudgetInfo> GetBudgetInfo(const SessionId& sessionId);
+    /// @brief Returns the fragmentation of all managed segments. The largest free block is probed with (immediately
+    /// freed) allocations. Free block count and histogram require FAIRMQ_SHM_BLOCK_WALK: the free blocks are walked
+    /// (briefly locking each segment allocator, very long free lists are only sampled, see SegmentFragmentationInfo::fSampled)
+    /// @param shmId shmem id
+    /// @throws MonitorError if a segment allocator stays locked (e.g. by a crashed process)
+    static std::vector<SegmentFragmentationInfo> GetFragmentationInfo(const ShmId& shmId);
+    /// @brief Returns the fragmentation of all managed segments. The largest free block is probed with (immediately
+    /// freed) allocations. Free block count and histogram require FAIRMQ_SHM_BLOCK_WALK: the free blocks are walked
+    /// (briefly locking each segment allocator, very long free lists are only sampled, see SegmentFragmentationInfo::fSampled)
+    /// @param sessionId session id
+    /// @throws MonitorError if a segment allocator stays locked (e.g. by a crashed process)
+    static std::vector<SegmentFragmentationInfo> GetFragmentationInfo(const SessionId& sessionId);
+    /// @brief Outputs the fragmentation of all managed segments
+    /// @param shmId shmem id
+    /// @param json output a single line JSON object instead of text
+    static void PrintFragmentationInfo(const ShmId& shmId, bool json = false);
+    /// @brief Outputs the fragmentation of all managed segments
+    /// @param sessionId session id
+    /// @param json output a single line JSON object instead of text
+    static void PrintFragmentationInfo(const SessionId& sessionId, bool json = false);
+    /// @brief Frees the managed segment buffers still attributed to processes that have died (crashed or were killed)
+    /// Buffers are attributed to the process that allocated them, or, once received, to the receiving process.
+    /// Sent buffers are attributed to no process until the receiver takes them over, buffers that were received while
+    /// other references to them existed are shared: neither are reclaimed. The minimum age is an additional margin,
+    /// e.g. for buffer handles passed between processes by other means than channels.
+    /// @param shmId shmem id
+    /// @param minAgeInS only reclaim buffers created at least this many seconds ago
+    /// @param verbose output the reclaimed buffers to stdout
+    /// @throws MonitorError if a segment allocator stays locked (e.g. by a crashed process), or if built without
+    /// FAIRMQ_SHM_BLOCK_WALK (the segment blocks have to be walked)
+    static ReclaimInfo ReclaimDeadBuffers(const ShmId& shmId, unsigned int minAgeInS = 10, bool verbose = true);
+    /// @brief Frees the managed segment buffers still attributed to processes that have died (see above)
+    /// @param sessionId session id
+    /// @param minAgeInS only reclaim buffers created at least this many seconds ago
+    /// @param verbose output the reclaimed buffers to stdout
+    /// @throws MonitorError if a segment allocator stays locked (e.g. by a crashed process), or if built without
+    /// FAIRMQ_SHM_BLOCK_WALK (the segment blocks have to be walked)
+    static ReclaimInfo ReclaimDeadBuffers(const SessionId& sessionId, unsigned int minAgeInS = 10, bool verbose = true);
     /// @brief Returns the amount of free memory in the specified segment
+    /// (segregated_fit: without the blocks cached in the size class free lists, see GetCachedMemory())
     /// @param shmId shmem id
     /// @param segmentId segment id
     /// @throws MonitorError
     static unsigned long GetFreeMemory(const ShmId& shmId, uint16_t segmentId);
     /// @brief Returns the amount of free memory in the specified segment
+    /// (segregated_fit: without the blocks cached in the size class free lists, see GetCachedMemory())
     /// @param sessionId session id
     /// @param segmentId segment id
     /// @throws MonitorError
     static unsigned long GetFreeMemory(const SessionId& sessionId, uint16_t segmentId);
+    /// @brief Returns the amount of memory cached in the size class free lists of the specified segment (segregated_fit,
+    /// 0 for other allocation algorithms), usable only for allocations of their size class
+    /// @param shmId shmem id
+    /// @param segmentId segment id
+    /// @throws MonitorError
+    static unsigned long GetCachedMemory(const ShmId& shmId, uint16_t segmentId);
+    /// @brief Returns the amount of memory cached in the size class free lists of the specified segment (segregated_fit,
+    /// 0 for other allocation algorithms), usable only for allocations of their size class
+    /// @param sessionId session id
+    /// @param segmentId segment id
+    /// @throws MonitorError
+    static unsigned long GetCachedMemory(const SessionId& sessionId, uint16_t segmentId);
     /// @brief Checks if a given segment can be opened
     /// @param shmId shmem id
     /// @param segmentId segment id
@@ -172,6 +296,8 @@ class Monitor
     bool fMonitor;
     bool fSeenOnce; // true is segment has been opened successfully at least once
     bool fCleanOnExit;
+    bool fFragmentationSampling;
+    bool fJson;
     unsigned int fTimeoutInMS;
     unsigned int fIntervalInMS;
     std::string fShmId;
@@ -0,0 +1,261 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#ifndef FAIR_MQ_SHMEM_PREFAULT_H_
+#define FAIR_MQ_SHMEM_PREFAULT_H_
+
+#include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
+
+#include <fairlogger/Logger.h>
+
+#include <algorithm> // min
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef> // size_t
+#include <cstdint> // uintptr_t
+#include <cstring> // memset
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h> // madvise
+#include <unistd.h> // sysconf
+#ifdef __linux__
+#include <linux/mempolicy.h> // MPOL_F_NODE, MPOL_F_ADDR
+#include <sys/syscall.h>
+#endif
+
+namespace fair::mq::shmem
+{
+
+/// Configuration of the parallel prefault/zero engine, used for the managed segments and the unmanaged regions
+struct PrefaultConfig
+{
+    int threads = 0; // number of threads, 0: one per cpu of the NUMA node of the memory (all cpus if not pinned), 1: calling thread only
+    int numaNode = -1; // pin the threads to the cpus of this NUMA node, -1: node of the first page of the memory, -2: do not pin
+    bool populate = false; // fault pages with madvise(MADV_POPULATE_WRITE) (Linux >= 5.14) instead of touching every page
+    std::function<void(size_t done, size_t total)> progress = nullptr; // called from the calling thread about once per second
+};
+
+namespace prefault
+{
+
+/// the ranges are processed in chunks of this size, distributed dynamically among the threads
+constexpr size_t kChunkSize = 64 * 1024 * 1024;
+constexpr auto kProgressInterval = std::chrono::seconds(1);
+#ifdef MADV_POPULATE_WRITE
+constexpr int kMadvPopulateWrite = MADV_POPULATE_WRITE;
+#else
+constexpr int kMadvPopulateWrite = 23; // not in the headers of older systems, rejected with EINVAL by older kernels
+#endif
+
+struct Range
+{
+    char* fData;
+    size_t fSize;
+};
+
+inline size_t PageSize()
+{
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+}
+
+/// @brief NUMA node of the page at the given address (faults it in), -1 if unknown
+inline int NumaNodeOf(void* ptr)
+{
+#ifdef __linux__
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, ptr, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return node;
+    }
+#else
+    (void)ptr;
+#endif
+    return -1;
+}
+
+/// @brief cpus of the given NUMA node, empty if the system has a single node or the node is unknown
+inline std::vector<int> NumaNodeCpus(int node)
+{
+    if (node < 0) {
+        return {};
+    }
+    std::ifstream possible("/sys/devices/system/node/possible");
+    std::string nodes;
+    if (!(possible >> nodes) || nodes == "0") {
+        return {};
+    }
+    std::ifstream cpulist(tools::ToString("/sys/devices/system/node/node", node, "/cpulist"));
+    std::string cpus;
+    if (!(cpulist >> cpus)) {
+        return {};
+    }
+    try {
+        return tools::ParseCpuList(cpus);
+    } catch (const tools::ThreadPlacementError&) {
+        return {};
+    }
+}
+
+/// @brief fault in the pages of the range for writing, without modifying their content
+inline void Populate(char* data, size_t size, bool populate, std::atomic<bool>& populateSupported)
+{
+    const size_t pageSize = PageSize();
+    // madvise needs a page aligned start, the range is part of a page aligned mapping
+    char* begin = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1));
+    if (populate && populateSupported.load(std::memory_order_relaxed)) {
+        if (madvise(begin, size + (data - begin), kMadvPopulateWrite) == 0) {
+            return;
+        }
+        if (errno == EINVAL) {
+            if (populateSupported.exchange(false)) {
+                LOG(warn) << "madvise(MADV_POPULATE_WRITE) is not supported by the kernel, falling back to touching the pages";
+            }
+        } else {
+            LOG(warn) << "madvise(MADV_POPULATE_WRITE) failed, falling back to touching the pages: " << strerror(errno);
+        }
+    }
+    // an atomic no-op write faults the page in for writing, without racing with concurrent writers of other processes
+    for (char* page = begin; page < data + size; page += pageSize) {
+        __atomic_fetch_or(page, char(0), __ATOMIC_RELAXED);
+    }
+}
+
+/// @brief apply op(data, size) to the given ranges, split into chunks, in parallel
+template<typename Op>
+void ForEachChunk(const std::vector<Range>& ranges, const PrefaultConfig& cfg, Op&& op)
+{
+    std::vector<Range> chunks;
+    size_t total = 0;
+    for (const auto& range : ranges) {
+        for (size_t offset = 0; offset < range.fSize; offset += kChunkSize) {
+            chunks.push_back(Range{range.fData + offset, std::min(kChunkSize, range.fSize - offset)});
+        }
+        total += range.fSize;
+    }
+    if (chunks.empty()) {
+        return;
+    }
+
+    std::vector<int> cpus;
+    if (cfg.numaNode != -2 && cfg.threads != 1) {
+        cpus = NumaNodeCpus(cfg.numaNode == -1 ? NumaNodeOf(chunks.front().fData) : cfg.numaNode);
+    }
+    size_t numThreads = cfg.threads > 0 ? static_cast<size_t>(cfg.threads) : (cpus.empty() ? std::thread::hardware_concurrency() : cpus.size());
+    numThreads = std::max<size_t>(1, std::min(numThreads, chunks.size()));
+
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    auto work = [&]() {
+        for (size_t i = next++; i < chunks.size(); i = next++) {
+            op(chunks[i].fData, chunks[i].fSize);
+            done += chunks[i].fSize;
+        }
+    };
+
+    if (numThreads == 1) {
+        auto lastReport = std::chrono::steady_clock::now();
+        for (size_t i = next++; i < chunks.size(); i = next++) {
+            op(chunks[i].fData, chunks[i].fSize);
+            done += chunks[i].fSize;
+            if (cfg.progress && std::chrono::steady_clock::now() - lastReport > kProgressInterval) {
+                cfg.progress(done, total);
+                lastReport = std::chrono::steady_clock::now();
+            }
+        }
+        return;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t finished = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        try {
+            threads.emplace_back([&, i]() {
+                tools::SetThreadName(tools::ToString("fmq-prefault-", i));
+                tools::SetThreadAffinity(cpus);
+                work();
+                std::lock_guard<std::mutex> lock(mtx);
+                ++finished;
+                cv.notify_one();
+            });
+        } catch (const std::system_error& e) {
+            LOG(warn) << "Could not start prefault thread " << i << ", continuing with " << threads.size() << " threads: " << e.what();
+            break;
+        }
+    }
+    if (threads.empty()) {
+        work();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!cv.wait_for(lock, kProgressInterval, [&]() { return finished == threads.size(); })) {
+            if (cfg.progress) {
+                cfg.progress(done, total);
+            }
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace prefault
+
+/// @brief read the prefault configuration from the "shm-prefault-*" config properties
+/// @param config configuration (fair::mq::ProgOptions), may be nullptr
+template<typename Config>
+PrefaultConfig GetPrefaultConfig(const Config* config)
+{
+    PrefaultConfig cfg;
+    if (config) {
+        cfg.threads = config->template GetProperty<int>("shm-prefault-threads", cfg.threads);
+        cfg.numaNode = config->template GetProperty<int>("shm-prefault-numa-node", cfg.numaNode);
+        cfg.populate = config->template GetProperty<bool>("shm-prefault-populate", cfg.populate);
+    }
+    return cfg;
+}
+
+/// @brief copy of the configuration that logs the progress of the operation under the given description
+inline PrefaultConfig WithProgressLog(PrefaultConfig cfg, const std::string& what)
+{
+    cfg.progress = [what](size_t done, size_t total) {
+        LOG(info) << what << ": " << (total > 0 ? done * 100 / total : 100) << "% (" << done << " of " << total << " bytes)";
+    };
+    return cfg;
+}
+
+/// @brief fault in all pages of the memory range for writing, in parallel, without modifying the content
+inline void PrefaultMemory(void* data, size_t size, const PrefaultConfig& cfg)
+{
+    std::atomic<bool> populateSupported(true);
+    prefault::ForEachChunk({prefault::Range{static_cast<char*>(data), size}}, cfg, [&](char* chunk, size_t chunkSize) {
+        prefault::Populate(chunk, chunkSize, cfg.populate, populateSupported);
+    });
+}
+
+/// @brief zero the given memory ranges, in parallel
+inline void ZeroMemory(const std::vector<prefault::Range>& ranges, const PrefaultConfig& cfg)
+{
+    prefault::ForEachChunk(ranges, cfg, [](char* chunk, size_t chunkSize) { std::memset(chunk, 0, chunkSize); });
+}
+
+} // namespace fair::mq::shmem
+
+#endif /* FAIR_MQ_SHMEM_PREFAULT_H_ */
@@ -10,6 +10,7 @@
 
 #include <fairmq/shmem/Common.h>
 #include <fairmq/shmem/Monitor.h>
+#include <fairmq/shmem/SegregatedFit.h>
 #include <fairmq/Transports.h>
 
 #include <cstdint>
@@ -21,29 +22,45 @@ namespace fair::mq::shmem
 
 struct SimpleSeqFit {};
 struct RBTreeBestFit {};
+struct SegregatedFit {};
 static const SimpleSeqFit simpleSeqFit = SimpleSeqFit();
 static const RBTreeBestFit rbTreeBestFit = RBTreeBestFit();
+static const SegregatedFit segregatedFit = SegregatedFit();
 
 struct Segment
 {
     friend class Monitor;
 
-    Segment(const std::string& shmId, uint16_t id, size_t size, SimpleSeqFit)
+    // mngSegmentSize: size of the management segment, if the segment creates the session (see shm-mng-segment-size)
+    Segment(const std::string& shmId, uint16_t id, size_t size, SimpleSeqFit, size_t mngSegmentSize = kManagementSegmentSize)
         : fSegment(SimpleSeqFitSegment(boost::interprocess::open_or_create, MakeShmName(shmId, "m", id).c_str(), size))
     {
-        Register(shmId, id, AllocationAlgorithm::simple_seq_fit);
+        Register(shmId, id, AllocationAlgorithm::simple_seq_fit, mngSegmentSize);
     }
 
-    Segment(const std::string& shmId, uint16_t id, size_t size, RBTreeBestFit)
+    Segment(const std::string& shmId, uint16_t id, size_t size, RBTreeBestFit, size_t mngSegmentSize = kManagementSegmentSize)
         : fSegment(RBTreeBestFitSegment(boost::interprocess::open_or_create, MakeShmName(shmId, "m", id).c_str(), size))
     {
-        Register(shmId, id, AllocationAlgorithm::rbtree_best_fit);
+        Register(shmId, id, AllocationAlgorithm::rbtree_best_fit, mngSegmentSize);
+    }
+
+    Segment(const std::string& shmId, uint16_t id, size_t size, SegregatedFit, size_t mngSegmentSize = kManagementSegmentSize)
+        : fSegment(RBTreeBestFitSegment(boost::interprocess::open_or_create, MakeShmName(shmId, "m", id).c_str(), size))
+    {
+        auto& segment = std::get<RBTreeBestFitSegment>(fSegment);
+        SegmentInfo info = Register(shmId, id, AllocationAlgorithm::segregated_fit, mngSegmentSize, &segment);
+        if (info.fPoolHandle != -1) {
+            fPool = static_cast<SegregatedFitPool*>(segment.get_address_from_handle(info.fPoolHandle));
+        }
     }
 
     size_t GetSize() const { return std::visit([](auto& s){ return s.get_size(); }, fSegment); }
     void* GetData() { return std::visit([](auto& s){ return s.get_address(); }, fSegment); }
 
+    /// @brief free memory of the underlying allocator
     size_t GetFreeMemory() const { return std::visit([](auto& s){ return s.get_free_memory(); }, fSegment); }
+    /// @brief segregated_fit: memory cached in the size class free lists of the pool, not part of GetFreeMemory()
+    size_t GetCachedMemory() const { return fPool ? fPool->GetCachedMemory() : 0; }
 
     void Zero() { std::visit([](auto& s){ return s.zero_free_memory(); }, fSegment); }
     void Lock()
@@ -60,21 +77,32 @@ struct Segment
 
   private:
     std::variant<RBTreeBestFitSegment, SimpleSeqFitSegment> fSegment;
+    SegregatedFitPool* fPool = nullptr;
 
-    static void Register(const std::string& shmId, uint16_t id, AllocationAlgorithm allocAlgo)
+    // register the segment in the management segment (created with mngSegmentSize, if it does not exist yet),
+    // if a pool segment is given, a newly registered segment gets a SegregatedFitPool
+    static SegmentInfo Register(const std::string& shmId, uint16_t id, AllocationAlgorithm allocAlgo, size_t mngSegmentSize, RBTreeBestFitSegment* poolSegment = nullptr)
     {
         using namespace boost::interprocess;
-        managed_shared_memory mngSegment(open_or_create, MakeShmName(shmId, "mng").c_str(), kManagementSegmentSize);
+        managed_shared_memory mngSegment(open_or_create, MakeShmName(shmId, "mng").c_str(), mngSegmentSize);
         VoidAlloc alloc(mngSegment.get_segment_manager());
 
+        ManagementLocks* locks = mngSegment.find_or_construct<ManagementLocks>(unique_instance)();
+        scoped_lock<interprocess_mutex> segmentsLock(locks->fSegmentsMtx);
         Uint16SegmentInfoHashMap* shmSegments = mngSegment.find_or_construct<Uint16SegmentInfoHashMap>(unique_instance)(alloc);
 
         EventCounter* eventCounter = mngSegment.find_or_construct<EventCounter>(unique_instance)(0);
+        RegionEventLog* eventLog = mngSegment.find_or_construct<RegionEventLog>(unique_instance)();
 
-        bool newSegmentRegistered = shmSegments->emplace(id, allocAlgo).second;
+        auto [it, newSegmentRegistered] = shmSegments->emplace(id, allocAlgo);
         if (newSegmentRegistered) {
+            if (poolSegment) {
+                it->second.fPoolHandle = poolSegment->get_handle_from_address(SegregatedFitPool::Create(*poolSegment));
+            }
             (eventCounter->fCount)++;
+            eventLog->Append(id, true, false);
         }
+        return it->second;
     }
 };
 
@@ -0,0 +1,265 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#ifndef FAIR_MQ_SHMEM_SEGREGATEDFIT_H_
+#define FAIR_MQ_SHMEM_SEGREGATEDFIT_H_
+
+#include <fairmq/shmem/Common.h>
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include <algorithm> // std::max
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memset
+#include <new> // placement new
+#include <vector>
+
+namespace fair::mq::shmem
+{
+
+// Segregated fit allocator for the managed segment ("segregated_fit" allocation algorithm).
+//
+// The pool object lives inside the managed segment it serves (its handle is stored in the SegmentInfo),
+// so that all processes attached to the segment share the same free lists.
+// Allocations up to kMaxClassSize bytes are rounded up to one of the size classes (four classes per power of two)
+// and served from a lock-free free list per class. Empty lists are refilled by carving a slab of blocks
+// out of the underlying rbtree_best_fit segment. Larger allocations go to the underlying segment directly.
+// Blocks of a size class are never returned to the underlying segment: they remain cached in their free list
+// and are accounted for as free memory.
+//
+// Each block is preceded by a BlockPrefix, storing the size class of the block and, while the block is in a
+// free list, the offset of the next free block. Free list heads are tagged with a counter to avoid ABA.
+struct SegregatedFitPool
+{
+    static constexpr size_t kMinClassSize = 256;
+    static constexpr size_t kMaxClassSize = 1 << 20;
+    static constexpr size_t kNumClasses = 49; // 256 B ... 1 MiB, four steps per power of two
+    static constexpr size_t kSlabSize = 1 << 16; // carve at least this many bytes when refilling a class
+    static constexpr uint32_t kLargeClass = 0xFFFF;
+
+    struct BlockPrefix
+    {
+        std::atomic<uint64_t> fNext; // offset of the next free block (from the segment base), 0 terminates
+        uint32_t fClass;
+        uint32_t fReserved;
+    };
+    static_assert(sizeof(BlockPrefix) == 16, "BlockPrefix must keep the 16 byte alignment of the segment allocations");
+
+    struct SizeClassStats
+    {
+        size_t size; // block size, including the BlockPrefix
+        uint64_t total; // number of blocks carved for this class
+        uint64_t free; // number of blocks currently in the free list
+    };
+
+    SegregatedFitPool()
+    {
+        for (size_t i = 0; i < kNumClasses; ++i) {
+            fClasses[i].fHead.store(0, std::memory_order_relaxed);
+            fClasses[i].fTotal.store(0, std::memory_order_relaxed);
+            fClasses[i].fFree.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief block size (including the prefix) of the given size class
+    static constexpr size_t ClassSize(size_t classIndex)
+    {
+        return (size_t(1) << (8 + classIndex / 4)) * (4 + classIndex % 4) / 4;
+    }
+
+    /// @brief smallest size class able to hold a block of the given size (including the prefix), kNumClasses if too large
+    static size_t ClassIndex(size_t size)
+    {
+        if (size <= kMinClassSize) {
+            return 0;
+        }
+        if (size > kMaxClassSize) {
+            return kNumClasses;
+        }
+        size_t n = size - 1;
+        size_t msb = 63 - __builtin_clzll(n);
+        size_t quarter = n >> (msb - 2); // 4..7
+        return 4 * (msb - 8) + quarter - 3;
+    }
+
+    /// @brief construct the pool inside the given segment
+    template<typename S>
+    static SegregatedFitPool* Create(S& segment)
+    {
+        return new (segment.allocate(sizeof(SegregatedFitPool))) SegregatedFitPool();
+    }
+
+    /// @brief allocate a block of at least size bytes, throws boost::interprocess::bad_alloc if the segment is full
+    /// @return pointer to the usable memory (after the block prefix)
+    template<typename S>
+    char* Allocate(S& segment, size_t size)
+    {
+        char* base = static_cast<char*>(segment.get_address());
+        size_t classIndex = ClassIndex(size + sizeof(BlockPrefix));
+
+        BlockPrefix* block = nullptr;
+        if (classIndex == kNumClasses) {
+            block = static_cast<BlockPrefix*>(segment.allocate(size + sizeof(BlockPrefix)));
+            block->fClass = kLargeClass;
+        } else {
+            block = Pop(base, classIndex);
+            if (!block) {
+                block = Refill(segment, classIndex);
+            }
+        }
+        return reinterpret_cast<char*>(block) + sizeof(BlockPrefix);
+    }
+
+    /// @brief return a block obtained from Allocate()
+    template<typename S>
+    void Deallocate(S& segment, char* ptr)
+    {
+        BlockPrefix* block = Prefix(ptr);
+        if (block->fClass == kLargeClass) {
+            segment.deallocate(block);
+        } else {
+            char* base = static_cast<char*>(segment.get_address());
+            Push(base, block->fClass, block, block, 1);
+        }
+    }
+
+    /// @brief shrink a block obtained from Allocate(). Size class blocks are kept as they are.
+    template<typename S>
+    char* ShrinkInPlace(S& segment, size_t newSize, char* ptr)
+    {
+        BlockPrefix* block = Prefix(ptr);
+        if (block->fClass != kLargeClass) {
+            return ptr;
+        }
+        return SegmentBufferShrink(newSize + sizeof(BlockPrefix), reinterpret_cast<char*>(block))(segment) + sizeof(BlockPrefix);
+    }
+
+    /// @brief expand a block obtained from Allocate() in place. Size class blocks can grow up to their class size.
+    /// @return true if the block can hold at least newSize bytes
+    template<typename S>
+    bool ExpandInPlace(S& segment, size_t newSize, char* ptr)
+    {
+        BlockPrefix* block = Prefix(ptr);
+        if (block->fClass != kLargeClass) {
+            return newSize + sizeof(BlockPrefix) <= ClassSize(block->fClass);
+        }
+        return SegmentBufferExpand(newSize + sizeof(BlockPrefix), reinterpret_cast<char*>(block))(segment) != nullptr;
+    }
+
+    /// @brief bytes held in the free lists (available for allocation, but not to the underlying segment)
+    size_t GetCachedMemory() const
+    {
+        size_t cached = 0;
+        for (size_t i = 0; i < kNumClasses; ++i) {
+            cached += fClasses[i].fFree.load(std::memory_order_relaxed) * ClassSize(i);
+        }
+        return cached;
+    }
+
+    /// @brief statistics of the size classes that have been used so far
+    std::vector<SizeClassStats> GetStats() const
+    {
+        std::vector<SizeClassStats> stats;
+        for (size_t i = 0; i < kNumClasses; ++i) {
+            uint64_t total = fClasses[i].fTotal.load(std::memory_order_relaxed);
+            if (total > 0) {
+                stats.push_back(SizeClassStats{ClassSize(i), total, fClasses[i].fFree.load(std::memory_order_relaxed)});
+            }
+        }
+        return stats;
+    }
+
+  private:
+    struct SizeClass
+    {
+        std::atomic<uint64_t> fHead; // tagged head: offset / 16 in the lower 40 bits, ABA tag in the upper 24 bits
+        std::atomic<uint64_t> fTotal;
+        std::atomic<uint64_t> fFree;
+        char fPadding[64 - 3 * sizeof(std::atomic<uint64_t>)]; // keep classes on separate cache lines
+    };
+
+    static constexpr uint64_t kOffsetMask = (uint64_t(1) << 40) - 1;
+
+    static BlockPrefix* Prefix(char* ptr) { return reinterpret_cast<BlockPrefix*>(ptr - sizeof(BlockPrefix)); }
+    static uint64_t Offset(const char* base, const BlockPrefix* block) { return reinterpret_cast<const char*>(block) - base; }
+    static uint64_t Pack(uint64_t offset, uint64_t tag) { return (offset >> 4) | (tag << 40); }
+    static uint64_t UnpackOffset(uint64_t head) { return (head & kOffsetMask) << 4; }
+    static uint64_t NextTag(uint64_t head) { return (head >> 40) + 1; }
+
+    BlockPrefix* Pop(char* base, size_t classIndex)
+    {
+        SizeClass& sc = fClasses[classIndex];
+        uint64_t head = sc.fHead.load(std::memory_order_acquire);
+        while (true) {
+            uint64_t offset = UnpackOffset(head);
+            if (offset == 0) {
+                return nullptr;
+            }
+            auto block = reinterpret_cast<BlockPrefix*>(base + offset);
+            // block memory stays valid even if popped concurrently (blocks are never released), a stale read fails the CAS
+            uint64_t next = block->fNext.load(std::memory_order_relaxed);
+            if (sc.fHead.compare_exchange_weak(head, Pack(next, NextTag(head)), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                sc.fFree.fetch_sub(1, std::memory_order_relaxed);
+                return block;
+            }
+        }
+    }
+
+    // push the chain first..last (linked via fNext) of count blocks
+    void Push(char* base, size_t classIndex, BlockPrefix* first, BlockPrefix* last, uint64_t count)
+    {
+        SizeClass& sc = fClasses[classIndex];
+        uint64_t head = sc.fHead.load(std::memory_order_relaxed);
+        do {
+            last->fNext.store(UnpackOffset(head), std::memory_order_relaxed);
+        } while (!sc.fHead.compare_exchange_weak(head, Pack(Offset(base, first), NextTag(head)), std::memory_order_release, std::memory_order_relaxed));
+        sc.fFree.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // carve a slab for the given class, return one block and push the rest to the free list
+    template<typename S>
+    BlockPrefix* Refill(S& segment, size_t classIndex)
+    {
+        char* base = static_cast<char*>(segment.get_address());
+        const size_t blockSize = ClassSize(classIndex);
+        uint64_t count = std::max(kSlabSize / blockSize, size_t(1));
+
+        char* slab = nullptr;
+        try {
+            slab = static_cast<char*>(segment.allocate(count * blockSize));
+        } catch (boost::interprocess::bad_alloc&) {
+            // not enough memory for a full slab, try a single block
+            count = 1;
+            slab = static_cast<char*>(segment.allocate(blockSize));
+        }
+
+        for (uint64_t i = 0; i < count; ++i) {
+            auto block = new (slab + i * blockSize) BlockPrefix();
+            block->fClass = static_cast<uint32_t>(classIndex);
+            block->fNext.store((i + 1 < count) ? Offset(base, block) + blockSize : 0, std::memory_order_relaxed);
+            // no ShmHeader yet, make sure a segment walk does not take the slab contents for one (see ShmHeader::Valid())
+            std::memset(reinterpret_cast<char*>(block) + sizeof(BlockPrefix), 0, sizeof(uint16_t));
+        }
+        fClasses[classIndex].fTotal.fetch_add(count, std::memory_order_relaxed);
+
+        auto first = reinterpret_cast<BlockPrefix*>(slab);
+        if (count > 1) {
+            Push(base, classIndex, reinterpret_cast<BlockPrefix*>(slab + blockSize), reinterpret_cast<BlockPrefix*>(slab + (count - 1) * blockSize), count - 1);
+        }
+        return first;
+    }
+
+    SizeClass fClasses[kNumClasses];
+};
+
+static_assert(SegregatedFitPool::ClassSize(SegregatedFitPool::kNumClasses - 1) == SegregatedFitPool::kMaxClassSize, "size classes must cover up to kMaxClassSize");
+
+} // namespace fair::mq::shmem
+
+#endif /* FAIR_MQ_SHMEM_SEGREGATEDFIT_H_ */
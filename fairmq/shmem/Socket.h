@@ -22,12 +22,14 @@
 
 #include <zmq.h>
 
-#include <algorithm>         // for std::max
+#include <algorithm>         // for std::max, std::any_of
 #include <atomic>
 #include <cstddef>           // for std::size_t
 #include <cstring>           // for std::memcpy
 #include <exception>         // for std::terminate
 #include <memory>            // for std::make_unique
+#include <string>
+#include <vector>
 
 namespace fair::mq {
     class TransportFactory;
@@ -49,18 +51,28 @@ class Socket final : public fair::mq::Socket
         , fBytesRx(0)
         , fMessagesTx(0)
         , fMessagesRx(0)
+        , fMessagesDropped(0)
         , fTimeout(100)
         , fConnectedPeersCount(0)
         , fMetadataMsgSize(manager.GetMetadataMsgSize())
+        , fPublisher(type == "pub")
+        , fSubscriber(type == "sub")
     {
         assert(context);
 
-        if (type == "sub" || type == "pub") {
-            LOG(error) << "PUB/SUB socket type is not supported for shared memory transport";
-            throw SocketError("PUB/SUB socket type is not supported for shared memory transport");
+        // PUB/SUB is built on top of ROUTER/DEALER: subscribers announce themselves to the publisher on every new
+        // connection (ZMQ_PROBE_ROUTER) and the publisher sends the meta data to each known subscriber individually,
+        // taking one buffer reference per subscriber. Unlike with ZMQ_PUB, the publisher knows exactly how many
+        // receivers got the buffer, which is required for correct reference counting.
+        int zmqType = zmq::getConstant(type);
+        if (fPublisher) {
+            zmqType = ZMQ_ROUTER;
+        } else if (fSubscriber) {
+            zmqType = ZMQ_DEALER;
+            fTopics.emplace_back(); // subscribe to everything by default, same as the zeromq transport
         }
 
-        fSocket = zmq_socket(context, zmq::getConstant(type));
+        fSocket = zmq_socket(context, zmqType);
         fMonitorSocket = zmq::makeMonitorSocket(context, fSocket, fId);
 
         if (fSocket == nullptr) {
@@ -68,6 +80,21 @@ class Socket final : public fair::mq::Socket
             throw SocketError(tools::ToString("Failed creating socket ", fId, ", reason: ", zmq_strerror(errno)));
         }
 
+        if (fPublisher) {
+            // report unreachable/full subscribers instead of silently dropping the meta data
+            int mandatory = 1;
+            if (zmq_setsockopt(fSocket, ZMQ_ROUTER_MANDATORY, &mandatory, sizeof(mandatory)) != 0) {
+                LOG(error) << "Failed setting ZMQ_ROUTER_MANDATORY socket option, reason: " << zmq_strerror(errno);
+                throw SocketError(tools::ToString("Failed setting ZMQ_ROUTER_MANDATORY socket option, reason: ", zmq_strerror(errno)));
+            }
+        } else if (fSubscriber) {
+            int probe = 1;
+            if (zmq_setsockopt(fSocket, ZMQ_PROBE_ROUTER, &probe, sizeof(probe)) != 0) {
+                LOG(error) << "Failed setting ZMQ_PROBE_ROUTER socket option, reason: " << zmq_strerror(errno);
+                throw SocketError(tools::ToString("Failed setting ZMQ_PROBE_ROUTER socket option, reason: ", zmq_strerror(errno)));
+            }
+        }
+
         if (zmq_setsockopt(fSocket, ZMQ_IDENTITY, fId.c_str(), fId.length()) != 0) {
             LOG(error) << "Failed setting ZMQ_IDENTITY socket option, reason: " << zmq_strerror(errno);
         }
@@ -87,13 +114,6 @@ class Socket final : public fair::mq::Socket
             LOG(error) << "Failed setting ZMQ_RCVTIMEO socket option, reason: " << zmq_strerror(errno);
         }
 
-        // if (type == "sub")
-        // {
-        //     if (zmq_setsockopt(fSocket, ZMQ_SUBSCRIBE, nullptr, 0) != 0)
-        //     {
-        //         LOG(error) << "Failed setting ZMQ_SUBSCRIBE socket option, reason: " << zmq_strerror(errno);
-        //     }
-        // }
         LOG(debug) << "Created socket " << GetId();
     }
 
@@ -123,6 +143,18 @@ class Socket final : public fair::mq::Socket
         assertm(dynamic_cast<shmem::Message*>(msgPtr), "given mq::Message is a shmem::Message");   // NOLINT
         auto shmMsg = static_cast<shmem::Message*>(msgPtr);   // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
 
+        if (fSubscriber) {
+            LOG(error) << "Cannot send on a SUB socket (" << fId << ")";
+            return static_cast<int>(TransferCode::error);
+        }
+        if (shmMsg->fDropBuffer) {
+            ++fMessagesDropped;
+            return Discard(*shmMsg);
+        }
+        if (fPublisher) {
+            return Publish(&shmMsg, 1, false, timeout);
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -135,10 +167,12 @@ class Socket final : public fair::mq::Socket
         zmq::ZMsg zmqMsg(std::max(fMetadataMsgSize, sizeof(MetaHeader)));
         std::memcpy(zmqMsg.Data(), &meta, sizeof(MetaHeader));
 
+        InFlight inFlight(&shmMsg, 1);
         while (true) {
             int nbytes = zmq_msg_send(zmqMsg.Msg(), fSocket, flags);
             if (nbytes > 0) {
-                shmMsg->fQueued = true;
+                inFlight.Sent();
+                shmMsg->HandOver();
                 ++fMessagesTx;
                 size_t size = msg->GetSize();
                 fBytesTx += size;
@@ -167,6 +201,11 @@ class Socket final : public fair::mq::Socket
         }
         int elapsed = 0;
 
+        if (fPublisher) {
+            LOG(error) << "Cannot receive on a PUB socket (" << fId << ")";
+            return static_cast<int>(TransferCode::error);
+        }
+
         while (true) {
             Message* shmMsg = static_cast<Message*>(msg.get());
             MetaHeader meta;
@@ -181,6 +220,15 @@ class Socket final : public fair::mq::Socket
                 }
 
                 shmMsg->SetMeta(meta);
+                if (shmMsg->fReclaimed) {
+                    LOG(error) << "Received a buffer that has been reclaimed from a dead process, dropping it (" << fId << ")";
+                    return static_cast<int>(TransferCode::error);
+                }
+
+                if (fSubscriber && !MatchesTopic(*shmMsg)) {
+                    shmMsg->Deallocate();
+                    continue;
+                }
 
                 size_t size = shmMsg->GetSize();
                 fBytesRx += size;
@@ -202,6 +250,33 @@ class Socket final : public fair::mq::Socket
 
     int64_t Send(Parts::container& msgVec, int timeout = -1) override
     {
+        if (fSubscriber) {
+            LOG(error) << "Cannot send on a SUB socket (" << fId << ")";
+            return static_cast<int>(TransferCode::error);
+        }
+        if (std::any_of(msgVec.cbegin(), msgVec.cend(), [](const auto& msg) { return msg && static_cast<const Message*>(msg.get())->fDropBuffer; })) {   // NOLINT
+            ++fMessagesDropped;
+            int64_t totalSize = 0;
+            for (auto& msg : msgVec) {
+                if (msg) {
+                    totalSize += Discard(*static_cast<Message*>(msg.get()));   // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
+                }
+            }
+            return totalSize;
+        }
+        if (fPublisher) {
+            std::vector<Message*> parts;
+            parts.reserve(msgVec.size());
+            for (auto& msg : msgVec) {
+                if (!msg) {
+                    return static_cast<int>(TransferCode::error);
+                }
+                assertm(dynamic_cast<shmem::Message*>(msg.get()), "given mq::Message is a shmem::Message");   // NOLINT
+                parts.push_back(static_cast<Message*>(msg.get()));   // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
+            }
+            return Publish(parts.data(), parts.size(), true, timeout);
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -216,6 +291,8 @@ class Socket final : public fair::mq::Socket
         *meta_n = n;
         ++meta_n;
         auto metas = static_cast<MetaHeader*>(static_cast<void*>(meta_n));
+        std::vector<Message*> parts;
+        parts.reserve(n);
         for (auto& msg : msgVec) {
             auto msgPtr = msg.get();
             if (!msgPtr) {
@@ -225,17 +302,19 @@ class Socket final : public fair::mq::Socket
             auto shmMsg = static_cast<shmem::Message*>(msgPtr);   // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
             MetaHeader meta{ shmMsg->fSize, shmMsg->fHint, shmMsg->fHandle, shmMsg->fShared, shmMsg->fRegionId, shmMsg->fSegmentId, shmMsg->fManaged };
             std::memcpy(metas++, &meta, sizeof(MetaHeader));
+            parts.push_back(shmMsg);
         }
 
+        InFlight inFlight(parts.data(), parts.size());
         while (true) {
             int64_t totalSize = 0;
             int nbytes = zmq_msg_send(zmqMsg.Msg(), fSocket, flags);
             if (nbytes > 0) {
                 assert(static_cast<unsigned int>(nbytes) >= sizeof(std::size_t) + (n * sizeof(MetaHeader)));
 
-                for (auto& msg : msgVec) {
-                    Message* shmMsg = static_cast<Message*>(msg.get());
-                    shmMsg->fQueued = true;
+                inFlight.Sent();
+                for (Message* shmMsg : parts) {
+                    shmMsg->HandOver();
                     totalSize += shmMsg->fSize;
                 }
 
@@ -260,8 +339,99 @@ class Socket final : public fair::mq::Socket
         return static_cast<int>(TransferCode::error);
     }
 
+    int64_t SendRegionBlocks(UnmanagedRegionPtr& region, const mq::RegionBlock* blocks, std::size_t count, int timeout = -1) override
+    {
+        if (count == 0) {
+            LOG(warn) << "Will not send empty vector";
+            return static_cast<int>(TransferCode::error);
+        }
+        if (region->GetType() != Transport::SHM) {
+            LOG(error) << "region type (" << region->GetType() << ") does not match socket type (" << Transport::SHM << ")";
+            return static_cast<int>(TransferCode::error);
+        }
+
+        // on failure the blocks are released via the region callback, same as unsent region messages going out of scope
+        auto releaseBlocks = [&](int64_t result) {
+            for (std::size_t i = 0; i < count; ++i) {
+                Message unsent(fManager, region, blocks[i].ptr, blocks[i].size, blocks[i].hint, GetTransport());
+            }
+            return result;
+        };
+
+        if (fSubscriber) {
+            LOG(error) << "Cannot send on a SUB socket (" << fId << ")";
+            return releaseBlocks(static_cast<int>(TransferCode::error));
+        }
+        if (fPublisher) {
+            // subscribers receive individual copies of the metadata, send as regular region messages
+            Parts::container msgVec;
+            msgVec.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                msgVec.push_back(std::make_unique<Message>(fManager, region, blocks[i].ptr, blocks[i].size, blocks[i].hint, GetTransport()));
+            }
+            return Send(msgVec, timeout);
+        }
+
+        int flags = 0;
+        if (timeout == 0) {
+            flags = ZMQ_DONTWAIT;
+        }
+        int elapsed = 0;
+
+        // meta msg format: | n | kRegionBlocksFlag | RegionBlocksHeader | RegionBlockMeta 1 | ... | RegionBlockMeta n | padded to fMetadataMsgSize |
+        zmq::ZMsg zmqMsg(std::max(fMetadataMsgSize, sizeof(std::size_t) + sizeof(RegionBlocksHeader) + count * sizeof(RegionBlockMeta)));
+        auto meta_n = static_cast<std::size_t*>(zmqMsg.Data());
+        *meta_n = count | kRegionBlocksFlag;
+        ++meta_n;
+        RegionBlocksHeader header{ region->GetId(), fManager.GetSegmentId(), 0 };
+        std::memcpy(meta_n, &header, sizeof(RegionBlocksHeader));
+        auto metas = static_cast<char*>(static_cast<void*>(meta_n)) + sizeof(RegionBlocksHeader);
+
+        const char* regionBegin = static_cast<const char*>(region->GetData());
+        const char* regionEnd = regionBegin + region->GetSize();
+        int64_t totalSize = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const char* ptr = static_cast<const char*>(blocks[i].ptr);
+            if (ptr < regionBegin || ptr + blocks[i].size > regionEnd) {
+                LOG(error) << "trying to send region block with data from outside the region";
+                return static_cast<int>(TransferCode::error);
+            }
+            RegionBlockMeta meta{ static_cast<uint64_t>(ptr - regionBegin), blocks[i].size, reinterpret_cast<uint64_t>(blocks[i].hint) };
+            std::memcpy(metas, &meta, sizeof(RegionBlockMeta));
+            metas += sizeof(RegionBlockMeta);
+            totalSize += blocks[i].size;
+        }
+
+        while (true) {
+            int nbytes = zmq_msg_send(zmqMsg.Msg(), fSocket, flags);
+            if (nbytes > 0) {
+                // the blocks are now owned by the receiver, released via the region callback
+                fMessagesTx++;
+                fBytesTx += totalSize;
+                return totalSize;
+            } else if (zmq_errno() == EAGAIN || zmq_errno() == EINTR) {
+                if (fManager.Interrupted()) {
+                    return releaseBlocks(static_cast<int>(TransferCode::interrupted));
+                } else if (zmq::ShouldRetry(flags, fTimeout, timeout, elapsed)) {
+                    continue;
+                } else {
+                    return releaseBlocks(static_cast<int>(TransferCode::timeout));
+                }
+            } else {
+                return releaseBlocks(zmq::HandleErrors(fId));
+            }
+        }
+
+        return releaseBlocks(static_cast<int>(TransferCode::error));
+    }
+
     int64_t Receive(Parts::container& msgVec, int timeout = -1) override
     {
+        if (fPublisher) {
+            LOG(error) << "Cannot receive on a PUB socket (" << fId << ")";
+            return static_cast<int>(TransferCode::error);
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -277,19 +447,59 @@ class Socket final : public fair::mq::Socket
                 [[maybe_unused]] auto const size = zmqMsg.Size();
                 assert(size > sizeof(std::size_t));
                 auto meta_n = static_cast<std::size_t*>(zmqMsg.Data());
+                if (*meta_n & kRegionBlocksFlag) {
+                    totalSize = ReceiveRegionBlocks(msgVec, *meta_n & ~kRegionBlocksFlag, meta_n + 1, size);
+                    fMessagesRx++;
+                    fBytesRx += totalSize;
+                    return totalSize;
+                }
                 auto const n = *meta_n;
                 assert(size >= sizeof(std::size_t) + n * sizeof(MetaHeader));
                 ++meta_n;
                 auto metas = static_cast<MetaHeader*>(static_cast<void*>(meta_n));
-                msgVec.reserve(msgVec.size() + n);
+
                 auto const transport = GetTransport();
+                std::unique_ptr<Message> first;
+                if (fSubscriber && n > 0) {
+                    // topic is matched against the beginning of the first part
+                    first = std::make_unique<Message>(fManager, *metas, transport);
+                    if (first->fReclaimed || !MatchesTopic(*first)) {
+                        for (std::size_t i = 1; i < n; ++i) {
+                            Message dropped(fManager, metas[i], transport);
+                        }
+                        if (first->fReclaimed) {
+                            LOG(error) << "Received a buffer that has been reclaimed from a dead process, dropping the message (" << fId << ")";
+                            return static_cast<int>(TransferCode::error);
+                        }
+                        continue;
+                    }
+                }
 
-                for (std::size_t i = 0; i < n; ++i) {
+                auto const numPrevious = msgVec.size();
+                msgVec.reserve(numPrevious + n);
+
+                std::size_t i = 0;
+                if (first) {
+                    // the first part already took over its buffer for the topic check
+                    totalSize += first->GetSize();
+                    msgVec.push_back(std::move(first));
+                    ++metas;
+                    ++i;
+                }
+                bool reclaimed = false;
+                for (; i < n; ++i) {
                     msgVec.push_back(std::make_unique<Message>(fManager, *metas, transport));
                     ++metas;
                     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
                     Message* shmMsg = static_cast<Message*>(msgVec.back().get());
                     totalSize += shmMsg->GetSize();
+                    reclaimed = reclaimed || shmMsg->fReclaimed;
+                }
+                if (reclaimed) {
+                    // the remaining parts are released, the message is incomplete
+                    msgVec.erase(msgVec.begin() + static_cast<std::ptrdiff_t>(numPrevious), msgVec.end());
+                    LOG(error) << "Received a buffer that has been reclaimed from a dead process, dropping the message (" << fId << ")";
+                    return static_cast<int>(TransferCode::error);
                 }
 
                 // store statistics on how many messages have been received (handle all parts as a single message)
@@ -334,6 +544,18 @@ class Socket final : public fair::mq::Socket
 
     void SetOption(const std::string& option, const void* value, size_t valueSize) override
     {
+        if (fSubscriber && (option == "subscribe" || option == "unsubscribe")) {
+            std::string topic(static_cast<const char*>(value), valueSize);
+            if (option == "subscribe") {
+                fTopics.push_back(topic);
+            } else {
+                auto it = std::find(fTopics.begin(), fTopics.end(), topic);
+                if (it != fTopics.end()) {
+                    fTopics.erase(it);
+                }
+            }
+            return;
+        }
         if (zmq_setsockopt(fSocket, zmq::getConstant(option), value, valueSize) < 0) {
             LOG(error) << "Failed setting socket option, reason: " << zmq_strerror(errno);
         }
@@ -447,6 +669,7 @@ class Socket final : public fair::mq::Socket
     unsigned long GetBytesRx() const override { return fBytesRx; }
     unsigned long GetMessagesTx() const override { return fMessagesTx; }
     unsigned long GetMessagesRx() const override { return fMessagesRx; }
+    unsigned long GetMessagesDropped() const override { return fMessagesDropped; }
 
     [[deprecated("Use fair::mq::zmq::getConstant() from <fairmq/zeromq/Common.h> instead.")]]
     static int GetConstant(const std::string& constant) { return zmq::getConstant(constant); }
@@ -462,10 +685,203 @@ class Socket final : public fair::mq::Socket
     std::atomic<unsigned long> fBytesRx;
     std::atomic<unsigned long> fMessagesTx;
     std::atomic<unsigned long> fMessagesRx;
+    std::atomic<unsigned long> fMessagesDropped;
 
     int fTimeout;
     mutable unsigned long fConnectedPeersCount;
     std::size_t fMetadataMsgSize;
+
+    const bool fPublisher;
+    const bool fSubscriber;
+    std::vector<std::string> fSubscribers; // PUB: identities of the known subscribers
+    std::vector<std::string> fTopics; // SUB: subscribed topics (prefixes of the (first) message part)
+
+    /// Attributes the buffers of the given messages to no process while they are being sent (Message::MarkInFlight()),
+    /// returns them to this process on destruction unless the send succeeded (Sent()).
+    class InFlight
+    {
+      public:
+        InFlight(Message* const* msgs, std::size_t n)
+            : fMsgs(msgs)
+            , fN(n)
+        {
+            for (std::size_t i = 0; i < fN; ++i) {
+                fMsgs[i]->MarkInFlight();
+            }
+        }
+
+        InFlight(const InFlight&) = delete;
+        InFlight& operator=(const InFlight&) = delete;
+
+        ~InFlight()
+        {
+            if (!fSent) {
+                for (std::size_t i = 0; i < fN; ++i) {
+                    fMsgs[i]->ReturnFromFlight();
+                }
+            }
+        }
+
+        void Sent() { fSent = true; }
+
+      private:
+        Message* const* fMsgs;
+        std::size_t fN;
+        bool fSent = false;
+    };
+
+    /// PUB: register subscribers that announced themselves since the last call (empty message sent on every new connection)
+    void UpdateSubscribers()
+    {
+        while (true) {
+            zmq::ZMsg identity;
+            if (zmq_msg_recv(identity.Msg(), fSocket, ZMQ_DONTWAIT) < 0) {
+                break;
+            }
+            bool probe = true;
+            bool more = zmq_msg_more(identity.Msg());
+            while (more) {
+                zmq::ZMsg part;
+                if (zmq_msg_recv(part.Msg(), fSocket, 0) < 0) {
+                    break;
+                }
+                probe = probe && part.Size() == 0;
+                more = zmq_msg_more(part.Msg());
+            }
+
+            std::string id(static_cast<const char*>(identity.Data()), identity.Size());
+            if (probe && std::find(fSubscribers.cbegin(), fSubscribers.cend(), id) == fSubscribers.cend()) {
+                LOG(debug) << "PUB socket " << fId << ": new subscriber " << id;
+                fSubscribers.push_back(std::move(id));
+            }
+        }
+    }
+
+    // materialize the parts of a message sent with SendRegionBlocks(), return the total size
+    std::size_t ReceiveRegionBlocks(Parts::container& msgVec, std::size_t n, const void* data, [[maybe_unused]] std::size_t size)
+    {
+        assert(size >= sizeof(std::size_t) + sizeof(RegionBlocksHeader) + n * sizeof(RegionBlockMeta));
+        RegionBlocksHeader header;
+        std::memcpy(&header, data, sizeof(RegionBlocksHeader));
+        auto metas = static_cast<const char*>(data) + sizeof(RegionBlocksHeader);
+
+        msgVec.reserve(msgVec.size() + n);
+        auto const transport = GetTransport();
+        std::size_t totalSize = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            RegionBlockMeta block;
+            std::memcpy(&block, metas, sizeof(RegionBlockMeta));
+            metas += sizeof(RegionBlockMeta);
+            MetaHeader meta{ block.fSize, block.fHint, static_cast<boost::interprocess::managed_shared_memory::handle_t>(block.fOffset), -1, header.fRegionId, header.fSegmentId, false };
+            msgVec.push_back(std::make_unique<Message>(fManager, meta, transport));
+            totalSize += block.fSize;
+        }
+        return totalSize;
+    }
+
+    /// Messages created in local memory because their budget was exceeded (quota policy drop, see Manager::Allocate)
+    /// are not sent. The whole (multipart) message is released, the send returns its size so that loss tolerant callers
+    /// carry on, and it is counted in GetMessagesDropped() instead of GetMessagesTx()/GetBytesTx().
+    static int64_t Discard(Message& msg)
+    {
+        int64_t size = msg.fSize;
+        msg.Deallocate();
+        return size;
+    }
+
+    /// PUB: send the meta data of the given parts to every subscriber, each subscriber receives its own reference.
+    /// The timeout applies to the whole publication: subscribers that cannot keep up (send queue full) are waited for
+    /// until it expires, after which the remaining slow subscribers miss the message (like with ZMQ_PUB).
+    /// The reference of the sender is released after the send.
+    int64_t Publish(Message* const* msgs, std::size_t n, bool multipart, int timeout)
+    {
+        UpdateSubscribers();
+
+        int flags = 0;
+        if (timeout == 0) {
+            flags = ZMQ_DONTWAIT;
+        }
+        int elapsed = 0;
+
+        int64_t totalSize = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            totalSize += msgs[i]->fSize;
+        }
+
+        auto const metaSize = multipart ? sizeof(std::size_t) + n * sizeof(MetaHeader) : sizeof(MetaHeader);
+
+        // the buffers stay in flight once published, the reference of the sender is released below
+        InFlight inFlight(msgs, n);
+        for (auto it = fSubscribers.begin(); it != fSubscribers.end();) {
+            // meta msg format (single part): | MetaHeader | padded to fMetadataMsgSize |
+            // meta msg format (multipart): | n | MetaHeader 1 | ... | MetaHeader n | padded to fMetadataMsgSize |
+            zmq::ZMsg zmqMsg(std::max(fMetadataMsgSize, metaSize));
+            auto metas = static_cast<MetaHeader*>(zmqMsg.Data());
+            if (multipart) {
+                auto meta_n = static_cast<std::size_t*>(zmqMsg.Data());
+                *meta_n = n;
+                metas = static_cast<MetaHeader*>(static_cast<void*>(meta_n + 1));
+            }
+
+            // take one reference per part for this subscriber
+            std::vector<std::unique_ptr<Message>> refs;
+            refs.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                refs.push_back(std::make_unique<Message>(fManager, GetTransport()));
+                Message& ref = *refs.back();
+                ref.Copy(*msgs[i]);
+                MetaHeader meta{ ref.fSize, ref.fHint, ref.fHandle, ref.fShared, ref.fRegionId, ref.fSegmentId, ref.fManaged };
+                std::memcpy(metas++, &meta, sizeof(MetaHeader));
+            }
+
+            // a full send queue is reported on the routing frame, once it is accepted the meta data frame follows
+            if (zmq_send(fSocket, it->data(), it->size(), ZMQ_SNDMORE | flags) >= 0
+             && zmq_msg_send(zmqMsg.Msg(), fSocket, flags) >= 0) {
+                for (auto& ref : refs) {
+                    ref->HandOver();
+                }
+                ++it;
+            } else if (zmq_errno() == EHOSTUNREACH) {
+                LOG(debug) << "PUB socket " << fId << ": subscriber " << *it << " is gone";
+                it = fSubscribers.erase(it);
+            } else if (zmq_errno() == EAGAIN || zmq_errno() == EINTR) {
+                if (fManager.Interrupted()) {
+                    return static_cast<int>(TransferCode::interrupted);
+                } else if (zmq::ShouldRetry(flags, fTimeout, timeout, elapsed)) {
+                    continue; // retry the same subscriber with fresh references (refs are released on destruction)
+                }
+                // timeout expired, this subscriber misses the message, the remaining ones are not waited for
+                flags = ZMQ_DONTWAIT;
+                ++it;
+            } else {
+                return zmq::HandleErrors(fId);
+            }
+        }
+
+        // the subscribers hold their own references now, release the one of the sender
+        inFlight.Sent();
+        for (std::size_t i = 0; i < n; ++i) {
+            msgs[i]->Deallocate();
+        }
+
+        ++fMessagesTx;
+        fBytesTx += totalSize;
+        return totalSize;
+    }
+
+    /// SUB: check if the beginning of the message buffer matches any of the subscribed topics
+    bool MatchesTopic(const Message& msg) const
+    {
+        for (const auto& topic : fTopics) {
+            if (topic.empty()) {
+                return true;
+            }
+            if (msg.GetSize() >= topic.size() && std::memcmp(msg.GetData(), topic.data(), topic.size()) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 } // namespace fair::mq::shmem
@@ -63,9 +63,9 @@ class TransportFactory final : public fair::mq::TransportFactory
             LOG(debug) << "ProgOptions not available! Using defaults.";
         }
 
-        if (allocationAlgorithm != "rbtree_best_fit" && allocationAlgorithm != "simple_seq_fit") {
-            LOG(error) << "Provided shared memory allocation algorithm '" << allocationAlgorithm << "' is not supported. Supported are 'rbtree_best_fit'/'simple_seq_fit'";
-            throw SharedMemoryError(tools::ToString("Provided shared memory allocation algorithm '", allocationAlgorithm, "' is not supported. Supported are 'rbtree_best_fit'/'simple_seq_fit'"));
+        if (allocationAlgorithm != "rbtree_best_fit" && allocationAlgorithm != "simple_seq_fit" && allocationAlgorithm != "segregated_fit") {
+            LOG(error) << "Provided shared memory allocation algorithm '" << allocationAlgorithm << "' is not supported. Supported are 'rbtree_best_fit'/'simple_seq_fit'/'segregated_fit'";
+            throw SharedMemoryError(tools::ToString("Provided shared memory allocation algorithm '", allocationAlgorithm, "' is not supported. Supported are 'rbtree_best_fit'/'simple_seq_fit'/'segregated_fit'"));
         }
 
         try {
@@ -78,6 +78,8 @@ class TransportFactory final : public fair::mq::TransportFactory
                 LOG(error) << "failed configuring context, reason: " << zmq_strerror(errno);
             }
 
+            zmq::SetIoThreadPlacement(fZmqCtx, tools::GetThreadPlacement(config, "io"));
+
             fManager = std::make_unique<Manager>(sessionName, segmentSize, config);
         } catch (boost::interprocess::interprocess_exception& e) {
             LOG(error) << "Could not initialize shared memory transport: " << e.what();
@@ -113,6 +115,11 @@ class TransportFactory final : public fair::mq::TransportFactory
         return std::make_unique<Message>(*fManager, size, alignment, this);
     }
 
+    MessagePtr CreateChannelMessage(const std::string& channel, size_t size, Alignment alignment) override
+    {
+        return std::make_unique<Message>(*fManager, size, alignment, fManager->GetChannelBudget(channel), this);
+    }
+
     MessagePtr CreateMessage(void* data, size_t size, fair::mq::FreeFn* ffn, void* hint = nullptr) override
     {
         return std::make_unique<Message>(*fManager, data, size, ffn, hint, this);
@@ -197,6 +204,7 @@ class TransportFactory final : public fair::mq::TransportFactory
     void Interrupt() override { fManager->Interrupt(); }
     void Resume() override { fManager->Resume(); }
     void Reset() override { fManager->Reset(); }
+    bool Interrupted() override { return fManager->Interrupted(); }
 
     ~TransportFactory() override
     {
@@ -11,7 +11,9 @@
 
 #include <fairmq/shmem/Common.h>
 #include <fairmq/shmem/Monitor.h>
+#include <fairmq/shmem/Prefault.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
 #include <fairmq/UnmanagedRegion.h>
 #include <fairmq/Transports.h>
 
@@ -55,7 +57,8 @@ struct UnmanagedRegion
         : UnmanagedRegion(shmId, cfg.size, true, std::move(cfg))
     {}
 
-    UnmanagedRegion(const std::string& shmId, uint64_t size, bool controlling, RegionConfig cfg)
+    /// @param mngSegmentSize size of the management segment, if the region creates the session (see shm-mng-segment-size)
+    UnmanagedRegion(const std::string& shmId, uint64_t size, bool controlling, RegionConfig cfg, PrefaultConfig prefaultCfg = PrefaultConfig(), size_t mngSegmentSize = kManagementSegmentSize)
         : fControlling(controlling)
         , fRemoveOnDestruction(cfg.removeOnDestruction)
         , fLinger(cfg.linger)
@@ -70,6 +73,7 @@ struct UnmanagedRegion
         , fQueue(nullptr)
         , fCallback(nullptr)
         , fBulkCallback(nullptr)
+        , fPrefaultConfig(std::move(prefaultCfg))
     {
         using namespace boost::interprocess;
 
@@ -137,6 +141,11 @@ struct UnmanagedRegion
             }
         }
 
+        if (cfg.prefault && !cfg.lock && !cfg.zero) {
+            LOG(debug) << "Prefaulting region " << id << "...";
+            Prefault();
+            LOG(debug) << "Successfully prefaulted region " << id << ".";
+        }
         if (cfg.lock) {
             LOG(debug) << "Locking region " << id << "...";
             Lock();
@@ -151,7 +160,7 @@ struct UnmanagedRegion
         InitializeRefCountSegment(fRcSegmentSize);
 
         if (fControlling && created) {
-            Register(shmId, cfg);
+            Register(shmId, cfg, mngSegmentSize);
         }
 
         LOG(debug) << (created ? "Created" : "Opened") << " unmanaged shared memory region: " << fName << " (" << (fControlling ? "controller" : "viewer") << "), refCount segment size: " << fRcSegmentSize;
@@ -173,10 +182,18 @@ struct UnmanagedRegion
 
     void Zero()
     {
-        memset(fRegion.get_address(), 0x00, fRegion.get_size());
+        ZeroMemory({prefault::Range{static_cast<char*>(fRegion.get_address()), fRegion.get_size()}}, WithProgressLog(fPrefaultConfig, "Zeroing region " + fName));
+    }
+    void Prefault()
+    {
+        PrefaultMemory(fRegion.get_address(), fRegion.get_size(), WithProgressLog(fPrefaultConfig, "Prefaulting region " + fName));
     }
     void Lock()
     {
+        if (fPrefaultConfig.threads != 1) {
+            // mlock faults the pages in sequentially, prefault them in parallel first
+            Prefault();
+        }
         if (mlock(fRegion.get_address(), fRegion.get_size()) == -1) {
             LOG(error) << "Could not lock region " << fName << ". Code: " << errno << ", reason: " << strerror(errno);
             throw TransportError(tools::ToString("Could not lock region ", fName, ": ", strerror(errno)));
@@ -277,6 +294,7 @@ struct UnmanagedRegion
     std::thread fAcksSender;
     RegionCallback fCallback;
     RegionBulkCallback fBulkCallback;
+    PrefaultConfig fPrefaultConfig;
 
     static RegionConfig makeRegionConfig(uint16_t id)
     {
@@ -285,16 +303,19 @@ struct UnmanagedRegion
         return regionCfg;
     }
 
-    static void Register(const std::string& shmId, const RegionConfig& cfg)
+    // expects the regions lock (ManagementLocks::fRegionsMtx) to be held by the caller, if other session processes are running
+    // the management segment is created with mngSegmentSize, if it does not exist yet
+    static void Register(const std::string& shmId, const RegionConfig& cfg, size_t mngSegmentSize)
     {
         using namespace boost::interprocess;
         LOG(debug) << "Registering unmanaged shared memory region with id " << cfg.id.value();
-        managed_shared_memory mngSegment(open_or_create, MakeShmName(shmId, "mng").c_str(), kManagementSegmentSize);
+        managed_shared_memory mngSegment(open_or_create, MakeShmName(shmId, "mng").c_str(), mngSegmentSize);
         VoidAlloc alloc(mngSegment.get_segment_manager());
 
         Uint16RegionInfoHashMap* shmRegions = mngSegment.find_or_construct<Uint16RegionInfoHashMap>(unique_instance)(alloc);
 
         EventCounter* eventCounter = mngSegment.find_or_construct<EventCounter>(unique_instance)(0);
+        RegionEventLog* eventLog = mngSegment.find_or_construct<RegionEventLog>(unique_instance)();
 
         auto it = shmRegions->find(cfg.id.value());
         if (it != shmRegions->end()) {
@@ -304,6 +325,7 @@ struct UnmanagedRegion
 
         shmRegions->emplace(cfg.id.value(), RegionInfo(cfg.path.c_str(), cfg.creationFlags, cfg.userFlags, cfg.size, cfg.rcSegmentSize, alloc));
         (eventCounter->fCount)++;
+        eventLog->Append(cfg.id.value(), false, false);
     }
 
     void SetCallbacks(RegionCallback callback, RegionBulkCallback bulkCallback)
@@ -344,10 +366,13 @@ struct UnmanagedRegion
         return fRefCountSegment->get_handle_from_address(ptr);
     }
 
-    void StartAckSender()
+    void StartAckSender(const tools::ThreadPlacement& placement = tools::ThreadPlacement())
     {
         if (!fAcksSender.joinable()) {
-            fAcksSender = std::thread(&UnmanagedRegion::SendAcks, this);
+            fAcksSender = std::thread([this, placement]() {
+                tools::ApplyThreadPlacement("fmq-acks-tx", placement);
+                SendAcks();
+            });
         }
     }
     void SendAcks()
@@ -388,10 +413,13 @@ struct UnmanagedRegion
                                                                 << " blocks left to send: " << blocksToSend << ").";
     }
 
-    void StartAckReceiver()
+    void StartAckReceiver(const tools::ThreadPlacement& placement = tools::ThreadPlacement())
     {
         if (!fAcksReceiver.joinable()) {
-            fAcksReceiver = std::thread(&UnmanagedRegion::ReceiveAcks, this);
+            fAcksReceiver = std::thread([this, placement]() {
+                tools::ApplyThreadPlacement("fmq-acks-rx", placement);
+                ReceiveAcks();
+            });
         }
     }
     void ReceiveAcks()
@@ -85,6 +85,11 @@ int main(int argc, char** argv)
         bool runAsDaemon = false;
         bool monitor = false;
         bool debug = false;
+        bool accounting = false;
+        bool fragmentation = false;
+        bool json = false;
+        bool reclaim = false;
+        unsigned int reclaimMinAge = 10;
         bool cleanOnExit = false;
         bool getShmId = false;
         bool listAll = false;
@@ -106,6 +111,11 @@ int main(int argc, char** argv)
             ("daemonize,d"    , value<bool>(&runAsDaemon)->implicit_value(true),        "Daemonize the monitor process (only in monitoring mode)")
             ("monitor,m"      , value<bool>(&monitor)->implicit_value(true),            "Run in monitoring mode")
             ("debug,b"        , value<bool>(&debug)->implicit_value(true),              "Debug - Print a list of messages)")
+            ("accounting,a"   , value<bool>(&accounting)->implicit_value(true),         "Print buffer accounting per process (live usage, size histogram, oldest outstanding buffers)")
+            ("fragmentation,f", value<bool>(&fragmentation)->implicit_value(true),      "Print largest free block and fragmentation of the managed segments, with FAIRMQ_SHM_BLOCK_WALK also the free block histogram (with --interactive: at every interval)")
+            ("json"           , value<bool>(&json)->implicit_value(true),               "Output the fragmentation as single line JSON objects (with --fragmentation)")
+            ("reclaim"        , value<bool>(&reclaim)->implicit_value(true),            "Free the buffers held by dead processes and quit (requires a FAIRMQ_SHM_BLOCK_WALK build)")
+            ("reclaim-min-age", value<unsigned int>(&reclaimMinAge)->default_value(10), "Only reclaim buffers older than this (seconds)")
             ("clean-on-exit,e", value<bool>(&cleanOnExit)->implicit_value(true),        "Perform cleanup on exit")
             ("interval"       , value<unsigned int>(&intervalInMS)->default_value(1000),"Output interval for interactive mode")
             ("get-shmid"      , value<bool>(&getShmId)->implicit_value(true),           "Translate given session id and user id to a shmem id (uses current user id if none provided)")
@@ -158,6 +168,21 @@ int main(int argc, char** argv)
             return 0;
         }
 
+        if (accounting) {
+            Monitor::PrintAccountingInfo(ShmId{shmId});
+            return 0;
+        }
+
+        if (reclaim) {
+            Monitor::ReclaimDeadBuffers(ShmId{shmId}, reclaimMinAge);
+            return 0;
+        }
+
+        if (fragmentation && !interactive) {
+            Monitor::PrintFragmentationInfo(ShmId{shmId}, json);
+            return 0;
+        }
+
         if (listAll) {
             Monitor::ListAll(listAllPath);
             return 0;
@@ -185,6 +210,7 @@ int main(int argc, char** argv)
         LOG(info) << "Starting shared memory monitor for session: \"" << sessionName << "\" (shm id: " << shmId << ")...";
 
         Monitor shmmonitor(shmId, selfDestruct, interactive, viewOnly, timeoutInMS, intervalInMS, monitor, cleanOnExit);
+        shmmonitor.SetFragmentationSampling(fragmentation, json);
         shmmonitor.CatchSignals();
         shmmonitor.Run();
     } catch (Monitor::DaemonPresent& dp) {
@@ -0,0 +1,121 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_FUTEX_H
+#define FAIR_MQ_TOOLS_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef __linux__
+#include <climits> // INT_MAX
+#include <ctime> // timespec
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <functional> // hash
+#include <mutex>
+#endif
+
+namespace fair::mq::tools
+{
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit integer");
+
+#ifndef __linux__
+namespace detail
+{
+// waiters on platforms without futex park on a mutex/condition variable bucket picked by the word address
+struct FutexBucket
+{
+    std::mutex fMtx;
+    std::condition_variable fCV;
+};
+
+inline FutexBucket& GetFutexBucket(const void* address)
+{
+    static FutexBucket buckets[64];
+    return buckets[std::hash<const void*>()(address) % 64];
+}
+} // namespace detail
+#endif
+
+/// @brief block while word == expected, until woken by FutexWakeAll() (spurious wake ups possible)
+/// @param timeout maximum waiting time, negative - wait indefinitely
+/// @param shared word is in memory shared between processes (without futex support only waiters of the own process
+/// are woken up, the others have to rely on their timeout)
+inline void FutexWait(const std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1), bool shared = false)
+{
+#ifdef __linux__
+    timespec ts{};
+    timespec* tsp = nullptr;
+    if (timeout.count() >= 0) {
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        tsp = &ts;
+    }
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&word), shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+#else
+    (void)shared;
+    auto& bucket = detail::GetFutexBucket(&word);
+    std::unique_lock<std::mutex> lock(bucket.fMtx);
+    if (word.load() != expected) {
+        return;
+    }
+    if (timeout.count() >= 0) {
+        bucket.fCV.wait_for(lock, timeout);
+    } else {
+        bucket.fCV.wait(lock);
+    }
+#endif
+}
+
+/// @brief wake all threads blocked in FutexWait() on word (call after modifying it)
+/// @param shared word is in memory shared between processes, see FutexWait()
+inline void FutexWakeAll(std::atomic<uint32_t>& word, bool shared = false)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)shared;
+    auto& bucket = detail::GetFutexBucket(&word);
+    { std::lock_guard<std::mutex> lock(bucket.fMtx); }
+    bucket.fCV.notify_all();
+#endif
+}
+
+/// @brief block until pred(word value) holds
+/// @param timeout maximum waiting time, negative - wait indefinitely
+/// @return true if pred holds, false on timeout
+template<typename Predicate>
+bool FutexWaitUntil(const std::atomic<uint32_t>& word, Predicate&& pred, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        uint32_t value = word.load(std::memory_order_acquire);
+        if (pred(value)) {
+            return true;
+        }
+        if (timeout.count() < 0) {
+            FutexWait(word, value);
+        } else {
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds(0)) {
+                return pred(word.load(std::memory_order_acquire));
+            }
+            FutexWait(word, value, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+        }
+    }
+}
+
+} // namespace fair::mq::tools
+
+#endif /* FAIR_MQ_TOOLS_FUTEX_H */
@@ -9,6 +9,7 @@
 #ifndef FAIR_MQ_TOOLS_RATELIMIT_H
 #define FAIR_MQ_TOOLS_RATELIMIT_H
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 // #include <iostream>
@@ -16,6 +17,11 @@
 #include <thread>
 #include <chrono>
 
+#ifdef __linux__
+#include <cerrno>
+#include <ctime> // clock_nanosleep
+#endif
+
 namespace fair::mq::tools
 {
 
@@ -31,12 +37,27 @@ namespace fair::mq::tools
  *                          // correct time measurement of the first iterations
  * }
  * \endcode
+ *
+ * By default the limiter adapts its sleep time to the measured iteration rate, which is cheap but
+ * bursty at high rates (sleeps are at least ~5ms long). With Pacing::precise each iteration (or
+ * each burst of iterations) is released at its own deadline, for smooth traffic at up to a few
+ * 100 kHz:
+ * \code
+ * RateLimiter limit(200000, RateLimiter::Pacing{true, std::chrono::microseconds(20), 1});
+ * \endcode
  */
 class RateLimiter
 {
     using clock = std::chrono::steady_clock;
 
   public:
+    struct Pacing
+    {
+        bool precise = false;                 ///< release iterations at fixed deadlines instead of adapting sleeps
+        std::chrono::nanoseconds spin{0};     ///< precise: busy-wait (instead of sleep) this long before a deadline
+        unsigned int burst = 1;               ///< precise: number of iterations released together per deadline
+    };
+
     /**
      * Constructs a rate limiter.
      *
@@ -45,9 +66,22 @@ class RateLimiter
      *             loop that only calls RateLimiter::maybe_sleep).
      */
     explicit RateLimiter(float rate)
+        : RateLimiter(rate, Pacing())
+    {}
+
+    /**
+     * Constructs a rate limiter.
+     *
+     * \param rate Work rate in Hz, see above.
+     * \param pacing_options Adaptive or precise pacing, see Pacing.
+     */
+    RateLimiter(float rate, Pacing pacing_options)
         : tw_req(std::chrono::seconds(1))
         , start_time(clock::now())
+        , pacing(pacing_options)
+        , deadline(start_time)
     {
+        pacing.burst = std::max(1U, pacing.burst);
         if (rate <= 0) {
             tw_req = std::chrono::nanoseconds(1);
         } else {
@@ -68,6 +102,10 @@ class RateLimiter
     void maybe_sleep()
     {
         using namespace std::chrono;
+        if (pacing.precise) {
+            pace();
+            return;
+        }
         if (--count == 0) {
             auto now = clock::now();
             if (tw == clock::duration::zero()) {
@@ -130,6 +168,50 @@ class RateLimiter
     clock::time_point start_time;
     int count = 1;
     int skip_check_count = 1;
+    Pacing pacing;
+    clock::time_point deadline;   //! precise: release time of the current burst
+    unsigned int burst_count = 0;
+
+    void pace()
+    {
+        if (++burst_count < pacing.burst) {
+            return;
+        }
+        burst_count = 0;
+
+        const auto interval = tw_req * pacing.burst;
+        deadline += interval;
+        auto now = clock::now();
+        if (now - deadline > interval) {
+            // more than a burst behind (slow iterations or a stalled send), restart from now
+            // instead of catching up with a burst
+            deadline = now;
+            return;
+        }
+        if (deadline - now > pacing.spin) {
+            sleep_until(deadline - pacing.spin);
+        }
+        while (clock::now() < deadline) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+    }
+
+    static void sleep_until(clock::time_point t)
+    {
+#ifdef __linux__
+        // std::chrono::steady_clock is CLOCK_MONOTONIC, sleep on an absolute time so that the
+        // time spent computing the deadline does not add up
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+        std::this_thread::sleep_until(t);
+#endif
+    }
 };
 
 } // namespace fair::mq::tools
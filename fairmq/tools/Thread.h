@@ -0,0 +1,228 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_THREAD_H
+#define FAIR_MQ_TOOLS_THREAD_H
+
+#include <fairmq/tools/Strings.h>
+
+#include <fairlogger/Logger.h>
+
+#include <cerrno>
+#include <cstring> // strerror
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace fair::mq::tools
+{
+
+struct ThreadPlacementError : std::runtime_error { using std::runtime_error::runtime_error; };
+
+/**
+ * @struct ThreadPlacement Thread.h <fairmq/tools/Thread.h>
+ * @brief CPU affinity and scheduling parameters for a class of threads
+ *
+ * An empty cpu list and an empty policy leave the respective setting untouched (inherited from
+ * the creating thread).
+ */
+struct ThreadPlacement
+{
+    std::vector<int> cpus;
+    std::string policy; ///< "other", "batch", "idle", "fifo" or "rr"
+    int priority = 0;   ///< within the range of the policy (ParseThreadPlacement defaults it to the minimum)
+
+    bool Empty() const { return cpus.empty() && policy.empty(); }
+};
+
+/// @brief number of cpu ids that can be used in an affinity mask
+constexpr int MaxCpus()
+{
+#ifdef __linux__
+    return CPU_SETSIZE;
+#else
+    return 1024;
+#endif
+}
+
+/// @brief parse a cpu list of the form "0-3,8,10-11"
+/// @param list cpu list
+/// @return vector of cpu ids
+inline std::vector<int> ParseCpuList(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first || last >= MaxCpus()) {
+                throw std::out_of_range(range);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw ThreadPlacementError(ToString("Invalid cpu list '", list, "', expected e.g. '0-3,8' with cpu ids below ", MaxCpus()));
+        }
+    }
+    return cpus;
+}
+
+inline int SchedPolicyFromString(const std::string& policy)
+{
+    if (policy == "other") { return SCHED_OTHER; }
+    if (policy == "fifo") { return SCHED_FIFO; }
+    if (policy == "rr") { return SCHED_RR; }
+#ifdef SCHED_BATCH
+    if (policy == "batch") { return SCHED_BATCH; }
+#endif
+#ifdef SCHED_IDLE
+    if (policy == "idle") { return SCHED_IDLE; }
+#endif
+    throw ThreadPlacementError(ToString("Unknown scheduling policy '", policy, "', supported are other/batch/idle/fifo/rr"));
+}
+
+/// @brief set the name of the calling thread (truncated to 15 characters, the pthread limit)
+inline bool SetThreadName(const std::string& name)
+{
+#ifdef __linux__
+    int rc = pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    int rc = pthread_setname_np(name.substr(0, 15).c_str());
+#else
+    int rc = 0;
+    (void)name;
+#endif
+    if (rc != 0) {
+        LOG(debug) << "Could not set thread name to '" << name << "', reason: " << strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+/// @brief pin the calling thread to the given cpus (no-op on platforms without affinity support)
+inline bool SetThreadAffinity(const std::vector<int>& cpus)
+{
+    if (cpus.empty()) {
+        return true;
+    }
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            LOG(error) << "Could not set thread affinity, cpu id " << cpu << " out of range [0, " << CPU_SETSIZE << ")";
+            return false;
+        }
+        CPU_SET(cpu, &cpuSet);
+    }
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+    if (rc != 0) {
+        LOG(error) << "Could not set thread affinity, reason: " << strerror(rc);
+        return false;
+    }
+    return true;
+#else
+    LOG(warn) << "Thread affinity is not supported on this platform, ignoring.";
+    return false;
+#endif
+}
+
+/// @brief set scheduling policy and priority of the calling thread
+inline bool SetThreadScheduling(const std::string& policy, int priority)
+{
+    if (policy.empty()) {
+        return true;
+    }
+    sched_param param{};
+    param.sched_priority = priority;
+    int rc = pthread_setschedparam(pthread_self(), SchedPolicyFromString(policy), &param);
+    if (rc != 0) {
+        LOG(error) << "Could not set thread scheduling policy '" << policy << "' (priority " << priority << "), reason: " << strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+/// @brief name the calling thread and apply the given placement to it (only for threads created by FairMQ)
+inline void ApplyThreadPlacement(const std::string& name, const ThreadPlacement& placement)
+{
+    SetThreadName(name);
+    if (placement.Empty()) {
+        return;
+    }
+    SetThreadAffinity(placement.cpus);
+    SetThreadScheduling(placement.policy, placement.priority);
+}
+
+/// @brief build the placement for a thread class from "<class>:<cpu list>" and "<class>:<policy>[:<priority>]" entries
+/// @param affinity entries of the form "<class>:<cpu list>"
+/// @param sched entries of the form "<class>:<policy>[:<priority>]"
+/// @param threadClass thread class to extract
+inline ThreadPlacement ParseThreadPlacement(const std::vector<std::string>& affinity,
+                                            const std::vector<std::string>& sched,
+                                            const std::string& threadClass)
+{
+    ThreadPlacement placement;
+    const std::string prefix(threadClass + ":");
+    for (const auto& entry : affinity) {
+        if (StrStartsWith(entry, prefix)) {
+            placement.cpus = ParseCpuList(entry.substr(prefix.length()));
+        }
+    }
+    for (const auto& entry : sched) {
+        if (StrStartsWith(entry, prefix)) {
+            std::string spec = entry.substr(prefix.length());
+            size_t colon = spec.find(':');
+            placement.policy = spec.substr(0, colon);
+            const int policy = SchedPolicyFromString(placement.policy); // validate early
+            // fifo/rr require a priority of at least 1, the other policies 0
+            const int minPriority = sched_get_priority_min(policy);
+            const int maxPriority = sched_get_priority_max(policy);
+            placement.priority = minPriority;
+            if (colon != std::string::npos) {
+                try {
+                    placement.priority = std::stoi(spec.substr(colon + 1));
+                } catch (const std::logic_error&) {
+                    throw ThreadPlacementError(ToString("Invalid scheduling priority in '", entry, "'"));
+                }
+                if (placement.priority < minPriority || placement.priority > maxPriority) {
+                    throw ThreadPlacementError(ToString("Scheduling priority in '", entry, "' out of range for policy '", placement.policy, "' (", minPriority, "-", maxPriority, ")"));
+                }
+            }
+        }
+    }
+    return placement;
+}
+
+/// @brief read the placement for a thread class from the "thread-affinity" and "thread-sched" config properties
+/// @param config configuration (fair::mq::ProgOptions), may be nullptr
+/// @param threadClass thread class: "device", "housekeeping" or "io"
+template<typename Config>
+ThreadPlacement GetThreadPlacement(const Config* config, const std::string& threadClass)
+{
+    if (!config) {
+        return ThreadPlacement();
+    }
+    return ParseThreadPlacement(config->template GetProperty<std::vector<std::string>>("thread-affinity", {}),
+                                config->template GetProperty<std::vector<std::string>>("thread-sched", {}),
+                                threadClass);
+}
+
+} // namespace fair::mq::tools
+
+#endif /* FAIR_MQ_TOOLS_THREAD_H */
@@ -0,0 +1,89 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_TOKENBUCKET_H
+#define FAIR_MQ_TOOLS_TOKENBUCKET_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace fair::mq::tools
+{
+
+/**
+ * @class TokenBucket TokenBucket.h <fairmq/tools/TokenBucket.h>
+ * @brief Lock-free token bucket, limiting the consumption of some amount (bytes, messages) to a rate
+ *
+ * Implemented as the virtual scheduling variant of the generic cell rate algorithm: instead of a
+ * token count, a single atomic holds the time at which the bucket would be full again (all previous
+ * consumption paid off at the configured rate). Consumption may go ahead as long as this time is at
+ * most the burst allowance ahead of now, so a burst of up to rate * burst can be consumed at once.
+ * Single amounts larger than the burst allowance are admitted too, the following consumers wait
+ * for them to be paid off.
+ */
+class TokenBucket
+{
+    using clock = std::chrono::steady_clock;
+
+  public:
+    /// @param rate amount per second (> 0)
+    /// @param burst burst allowance, as time at the full rate
+    TokenBucket(double rate, std::chrono::nanoseconds burst)
+        : fNsPerUnit(1e9 / rate)
+        , fBurstNs(std::max(std::chrono::nanoseconds(0), burst).count())
+        , fFullAt(0)
+    {}
+
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket(TokenBucket&&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+    TokenBucket& operator=(TokenBucket&&) = delete;
+    ~TokenBucket() = default;
+
+    /// @brief reserve amount, if it can be consumed within maxWait
+    /// @param amount amount to reserve
+    /// @param maxWait maximum acceptable wait, negative - unlimited
+    /// @return time to wait before the reserved amount may be consumed, or a negative duration if
+    /// the wait would exceed maxWait (nothing is reserved then)
+    std::chrono::nanoseconds Reserve(uint64_t amount, std::chrono::nanoseconds maxWait)
+    {
+        const int64_t cost = Cost(amount);
+        const int64_t now = Now();
+        int64_t fullAt = fFullAt.load(std::memory_order_relaxed);
+        while (true) {
+            const int64_t wait = std::max(int64_t(0), fullAt - fBurstNs - now);
+            if (maxWait.count() >= 0 && wait > maxWait.count()) {
+                return std::chrono::nanoseconds(-1);
+            }
+            if (fFullAt.compare_exchange_weak(fullAt, std::max(fullAt, now) + cost, std::memory_order_relaxed)) {
+                return std::chrono::nanoseconds(wait);
+            }
+        }
+    }
+
+    /// @brief give back a reserved amount that has not been consumed
+    void Release(uint64_t amount) { fFullAt.fetch_sub(Cost(amount), std::memory_order_relaxed); }
+
+  private:
+    const double fNsPerUnit;
+    const int64_t fBurstNs;
+    std::atomic<int64_t> fFullAt; ///< steady clock time (ns) at which the bucket is full again
+
+    int64_t Cost(uint64_t amount) const { return static_cast<int64_t>(static_cast<double>(amount) * fNsPerUnit); }
+
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    }
+};
+
+} // namespace fair::mq::tools
+
+#endif /* FAIR_MQ_TOOLS_TOKENBUCKET_H */
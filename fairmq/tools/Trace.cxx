@@ -0,0 +1,129 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/tools/Trace.h>
+
+#include <fstream>
+#include <ostream>
+
+#include <unistd.h> // getpid
+
+using namespace std;
+
+namespace fair::mq::tools
+{
+
+namespace
+{
+
+// small sequential thread ids, for a readable timeline
+int ThreadIndex()
+{
+    static atomic<int> nextIndex(1);
+    thread_local int index = nextIndex++;
+    return index;
+}
+
+void WriteJsonString(ostream& os, const string& str)
+{
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            os << ' ';
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+} // namespace
+
+Trace::Trace()
+    : fOrigin(Clock::now())
+    , fEnabled(false)
+{}
+
+Trace& Trace::Instance()
+{
+    static Trace trace;
+    return trace;
+}
+
+void Trace::Disable()
+{
+    fEnabled.store(false, memory_order_relaxed);
+    lock_guard<mutex> lock(fMtx);
+    fEvents.clear();
+    fEvents.shrink_to_fit();
+}
+
+void Trace::Complete(string name, string category, Clock::time_point begin)
+{
+    auto end = Clock::now();
+    Add(Event{move(name),
+              move(category),
+              chrono::duration_cast<chrono::microseconds>(begin - fOrigin).count(),
+              chrono::duration_cast<chrono::microseconds>(end - begin).count(),
+              ThreadIndex()});
+}
+
+void Trace::Instant(string name, string category)
+{
+    Add(Event{move(name), move(category), chrono::duration_cast<chrono::microseconds>(Clock::now() - fOrigin).count(), -1, ThreadIndex()});
+}
+
+void Trace::Add(Event event)
+{
+    if (!Enabled()) {
+        return;
+    }
+    lock_guard<mutex> lock(fMtx);
+    if (fEvents.size() < kMaxEvents) {
+        fEvents.push_back(move(event));
+    }
+}
+
+vector<Trace::Event> Trace::GetEvents() const
+{
+    lock_guard<mutex> lock(fMtx);
+    return fEvents;
+}
+
+bool Trace::Write(const string& filename) const
+{
+    vector<Event> events = GetEvents();
+
+    ofstream file(filename, ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    const int pid = getpid();
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        file << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        WriteJsonString(file, e.name);
+        file << ",\"cat\":";
+        WriteJsonString(file, e.category);
+        if (e.duration < 0) {
+            file << ",\"ph\":\"i\",\"s\":\"p\"";
+        } else {
+            file << ",\"ph\":\"X\",\"dur\":" << e.duration;
+        }
+        file << ",\"ts\":" << e.begin << ",\"pid\":" << pid << ",\"tid\":" << e.thread << "}";
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+} // namespace fair::mq::tools
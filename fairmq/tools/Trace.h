@@ -0,0 +1,121 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_TRACE_H
+#define FAIR_MQ_TOOLS_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+namespace fair::mq::tools
+{
+
+/**
+ * @class Trace Trace.h <fairmq/tools/Trace.h>
+ * @brief Process-wide timeline of coarse grained phases (startup, state transitions), in Chrome trace format
+ *
+ * Meant for phases that happen a handful of times per transition (plugin loading, config parsing, transport
+ * creation, channel initialization, state handlers), not for per-message events.
+ * Recording is disabled by default. DeviceRunner enables it if the `trace-file` property is set (already before
+ * the configuration is parsed, if the option is given on the command line).
+ * The output can be loaded in chrome://tracing or https://ui.perfetto.dev.
+ */
+class Trace
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        std::string name;
+        std::string category;
+        int64_t begin; ///< microseconds since the trace origin
+        int64_t duration; ///< microseconds, -1 for instant events
+        int thread;
+    };
+
+    /// maximum number of recorded events, further events are dropped
+    static constexpr size_t kMaxEvents = 100000;
+
+    static Trace& Instance();
+
+    bool Enabled() const { return fEnabled.load(std::memory_order_relaxed); }
+    /// @brief stop recording and drop the recorded events
+    void Disable();
+    void Enable() { fEnabled.store(true, std::memory_order_relaxed); }
+
+    /// @brief record a phase that started at begin and ends now
+    void Complete(std::string name, std::string category, Clock::time_point begin);
+    /// @brief record a point in time (e.g. a state transition)
+    void Instant(std::string name, std::string category);
+
+    std::vector<Event> GetEvents() const;
+    /// @brief write the recorded events as Chrome trace JSON to the given file (overwriting it)
+    /// @return false if the file could not be written
+    bool Write(const std::string& filename) const;
+
+  private:
+    Trace();
+    void Add(Event event);
+
+    const Clock::time_point fOrigin;
+    std::atomic<bool> fEnabled;
+    mutable std::mutex fMtx;
+    std::vector<Event> fEvents;
+};
+
+/**
+ * @class TraceSpan Trace.h <fairmq/tools/Trace.h>
+ * @brief RAII helper recording the lifetime of the object as a phase of the process Trace
+ *
+ * @code
+ * {
+ *     TraceSpan span("LoadPlugin", "startup");
+ *     // ...
+ * }
+ * @endcode
+ */
+class TraceSpan
+{
+  public:
+    TraceSpan(std::string name, std::string category)
+        : fEnabled(Trace::Instance().Enabled())
+    {
+        if (fEnabled) {
+            fName = std::move(name);
+            fCategory = std::move(category);
+            fBegin = Trace::Clock::now();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan()
+    {
+        if (fEnabled) {
+            Trace::Instance().Complete(std::move(fName), std::move(fCategory), fBegin);
+        }
+    }
+
+  private:
+    bool fEnabled;
+    std::string fName;
+    std::string fCategory;
+    Trace::Clock::time_point fBegin;
+};
+
+} // namespace fair::mq::tools
+
+#endif /* FAIR_MQ_TOOLS_TRACE_H */
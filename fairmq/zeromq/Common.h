@@ -10,7 +10,9 @@
 
 #include <fairlogger/Logger.h>
 #include <fairmq/Error.h>
+#include <fairmq/Socket.h>
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
 #include <stdexcept>
 #include <string_view>
 #include <zmq.h>
@@ -87,6 +89,47 @@ inline int HandleErrors(const std::string& id)
     }
 }
 
+/// Apply thread placement (affinity, scheduling) to the I/O threads of the given context.
+/// Must be called before the first socket is created on the context.
+inline void SetIoThreadPlacement([[maybe_unused]] void* zmqCtx, const tools::ThreadPlacement& placement)
+{
+    if (placement.Empty()) {
+        return;
+    }
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+    for (int cpu : placement.cpus) {
+        if (zmq_ctx_set(zmqCtx, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu) != 0) {
+            LOG(error) << "failed setting ZMQ_THREAD_AFFINITY_CPU_ADD (" << cpu << "), reason: " << zmq_strerror(errno);
+            throw Error(tools::ToString("failed setting ZMQ_THREAD_AFFINITY_CPU_ADD (", cpu, "), reason: ", zmq_strerror(errno)));
+        }
+    }
+#else
+    if (!placement.cpus.empty()) {
+        LOG(warn) << "ZMQ_THREAD_AFFINITY_CPU_ADD is not supported by this ZeroMQ version, ignoring io thread affinity.";
+    }
+#endif
+    if (!placement.policy.empty()) {
+#ifdef ZMQ_THREAD_SCHED_POLICY
+        if (zmq_ctx_set(zmqCtx, ZMQ_THREAD_SCHED_POLICY, tools::SchedPolicyFromString(placement.policy)) != 0) {
+            LOG(error) << "failed setting ZMQ_THREAD_SCHED_POLICY, reason: " << zmq_strerror(errno);
+            throw Error(tools::ToString("failed setting ZMQ_THREAD_SCHED_POLICY, reason: ", zmq_strerror(errno)));
+        }
+#else
+        LOG(warn) << "ZMQ_THREAD_SCHED_POLICY is not supported by this ZeroMQ version, ignoring io thread scheduling policy.";
+#endif
+#ifdef ZMQ_THREAD_PRIORITY
+        if (placement.priority != 0 && zmq_ctx_set(zmqCtx, ZMQ_THREAD_PRIORITY, placement.priority) != 0) {
+            LOG(error) << "failed setting ZMQ_THREAD_PRIORITY, reason: " << zmq_strerror(errno);
+            throw Error(tools::ToString("failed setting ZMQ_THREAD_PRIORITY, reason: ", zmq_strerror(errno)));
+        }
+#else
+        if (placement.priority != 0) {
+            LOG(warn) << "ZMQ_THREAD_PRIORITY is not supported by this ZeroMQ version, ignoring io thread priority.";
+        }
+#endif
+    }
+}
+
 /// Lookup table for various zmq constants
 inline auto getConstant(std::string_view constant) -> int
 {
@@ -119,6 +162,9 @@ inline auto getConstant(std::string_view constant) -> int
     if (constant == "pollin") { return ZMQ_POLLIN; }
     if (constant == "pollout") { return ZMQ_POLLOUT; }
 
+    if (constant == "subscribe") { return ZMQ_SUBSCRIBE; }
+    if (constant == "unsubscribe") { return ZMQ_UNSUBSCRIBE; }
+
     throw Error(tools::ToString("getConstant called with an invalid argument: ", constant));
 }
 
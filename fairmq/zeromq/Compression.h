@@ -0,0 +1,419 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_ZMQ_COMPRESSION_H
+#define FAIR_MQ_ZMQ_COMPRESSION_H
+
+#include <fairmq/Socket.h> // SocketError
+#include <fairmq/tools/Strings.h>
+#include <fairmq/zeromq/ZMsg.h>
+
+#if FAIRMQ_HAS_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#if FAIRMQ_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm> // min, max
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib> // malloc, free
+#include <cstring> // memcpy, memmove
+#include <functional>
+#include <mutex>
+#include <new> // bad_alloc
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fair::mq::zmq
+{
+
+enum class Codec : uint8_t
+{
+    none = 0,
+    lz4 = 1,
+    zstd = 2
+};
+
+inline Codec ParseCodec(const std::string& name)
+{
+    if (name == "none") {
+        return Codec::none;
+    } else if (name == "lz4") {
+        return Codec::lz4;
+    } else if (name == "zstd") {
+        return Codec::zstd;
+    }
+    throw SocketError(tools::ToString("unknown compression codec '", name, "', expected none, lz4 or zstd"));
+}
+
+/// @return true if FairMQ was built with the library of the codec
+inline bool CodecAvailable(Codec codec)
+{
+    switch (codec) {
+        case Codec::none: return true;
+#if FAIRMQ_HAS_LZ4
+        case Codec::lz4: return true;
+#endif
+#if FAIRMQ_HAS_ZSTD
+        case Codec::zstd: return true;
+#endif
+        default: return false;
+    }
+}
+
+// Wire format of a message sent by a compressing socket (host byte order, both peers need compression enabled):
+// | CompressionHeader | CompressedPartHeader 1 | ... | CompressedPartHeader n |  first frame
+// | part 1 | ... | part n |                                                   one frame per part, raw or compressed
+// A compressed part is | number of blocks (uint64_t) | CompressedBlockHeader 1 ... m | block 1 | ... | block m |,
+// the blocks are compressed independently (in parallel, for large parts).
+struct CompressionHeader
+{
+    uint32_t fMagic;
+    uint32_t fNumParts;
+};
+
+struct CompressedPartHeader
+{
+    uint64_t fSize; // uncompressed size
+    Codec fCodec; // none if the part is sent as is
+    uint8_t fReserved[7];
+};
+
+struct CompressedBlockHeader
+{
+    uint64_t fSize; // uncompressed size
+    uint64_t fCompressedSize;
+};
+
+/// Compresses/decompresses the parts of a zeromq socket. Not thread safe (like the socket).
+class Compressor
+{
+  public:
+    static constexpr uint32_t kMagic = 0x43514d46; // "FMQC"
+    static constexpr size_t kMinBlockSize = 1 << 20; // parts are split into blocks of at least this size for parallel compression
+    static constexpr size_t kMaxBlockSize = 1 << 30; // below the LZ4 limit (LZ4_MAX_INPUT_SIZE)
+    static constexpr size_t kMaxRatio = 1 << 16;     // above the ratio of both codecs (LZ4 ~255, zstd RLE blocks ~32K)
+
+    /// @param codec codec for sending (received parts are decompressed with the codec they were compressed with)
+    /// @param level compression level, 0 - codec default. lz4: > 0 - LZ4HC level, < 0 - acceleration of the fast mode.
+    /// zstd: zstd level (negative - fast levels)
+    /// @param threshold parts smaller than this (in bytes) are sent as is
+    /// @param threads number of threads to (de)compress the blocks of large parts with (including the calling thread)
+    Compressor(Codec codec, int level, size_t threshold, int threads)
+        : fCodec(codec)
+        , fLevel(level)
+        , fThreshold(threshold)
+        , fContexts(std::max(threads, 1))
+    {
+        for (size_t i = 1; i < fContexts.size(); ++i) {
+            fWorkers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    Compressor(const Compressor&) = delete;
+    Compressor(Compressor&&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+    Compressor& operator=(Compressor&&) = delete;
+
+    Codec GetCodec() const { return fCodec; }
+
+    /// @brief compress a part into out
+    /// @return false if the part is to be sent as is (below the threshold, or incompressible)
+    bool Compress(const void* data, size_t size, ZMsg& out)
+    {
+        if (size == 0 || size < fThreshold) {
+            return false;
+        }
+
+        const size_t numBlocks = std::max((size + kMaxBlockSize - 1) / kMaxBlockSize, std::min(fContexts.size(), size / kMinBlockSize));
+        const size_t blockSize = (size + numBlocks - 1) / numBlocks;
+        const size_t tableSize = sizeof(uint64_t) + numBlocks * sizeof(CompressedBlockHeader);
+
+        // every block is compressed to its own worst case slot, the gaps are closed afterwards
+        std::vector<size_t> offsets(numBlocks);
+        size_t capacity = tableSize;
+        for (size_t i = 0; i < numBlocks; ++i) {
+            offsets[i] = capacity;
+            capacity += Bound(std::min(blockSize, size - i * blockSize));
+        }
+        char* buffer = static_cast<char*>(malloc(capacity));
+        if (!buffer) {
+            throw std::bad_alloc();
+        }
+
+        std::vector<CompressedBlockHeader> blocks(numBlocks);
+        Run(numBlocks, [&](size_t i, Context& ctx) {
+            const size_t blockBytes = std::min(blockSize, size - i * blockSize);
+            blocks[i].fSize = blockBytes;
+            blocks[i].fCompressedSize = CompressBlock(ctx, static_cast<const char*>(data) + i * blockSize, blockBytes, buffer + offsets[i], Bound(blockBytes));
+            return blocks[i].fCompressedSize > 0;
+        });
+
+        size_t compressedSize = tableSize;
+        for (const auto& b : blocks) {
+            compressedSize += b.fCompressedSize;
+        }
+        if (std::any_of(blocks.cbegin(), blocks.cend(), [](const auto& b) { return b.fCompressedSize == 0; }) || compressedSize >= size) {
+            free(buffer);
+            return false;
+        }
+
+        size_t pos = tableSize;
+        for (size_t i = 0; i < numBlocks; ++i) {
+            std::memmove(buffer + pos, buffer + offsets[i], blocks[i].fCompressedSize);
+            pos += blocks[i].fCompressedSize;
+        }
+        const uint64_t n = numBlocks;
+        std::memcpy(buffer, &n, sizeof(n));
+        std::memcpy(buffer + sizeof(n), blocks.data(), numBlocks * sizeof(CompressedBlockHeader));
+
+        out = ZMsg(buffer, compressedSize, [](void* ptr, void* /* hint */) { free(ptr); });
+        return true;
+    }
+
+    /// @brief validate the block table of a part compressed with Compress(), before allocating its uncompressed buffer
+    /// @return uncompressed size of the part according to its block table, 0 if the table is invalid (compressed sizes
+    /// not matching the part size, blocks larger than kMaxBlockSize or expanding by more than kMaxRatio, which the
+    /// sender never produces)
+    static size_t UncompressedSize(const void* data, size_t size)
+    {
+        if (size < sizeof(uint64_t)) {
+            return 0;
+        }
+        uint64_t numBlocks = 0;
+        std::memcpy(&numBlocks, data, sizeof(numBlocks));
+        if (numBlocks == 0 || numBlocks > (size - sizeof(uint64_t)) / sizeof(CompressedBlockHeader)) {
+            return 0;
+        }
+        size_t in = sizeof(uint64_t) + numBlocks * sizeof(CompressedBlockHeader);
+        size_t total = 0;
+        for (size_t i = 0; i < numBlocks; ++i) {
+            CompressedBlockHeader block;
+            std::memcpy(&block, static_cast<const char*>(data) + sizeof(uint64_t) + i * sizeof(CompressedBlockHeader), sizeof(block));
+            if (block.fSize == 0 || block.fSize > kMaxBlockSize || block.fCompressedSize == 0
+                || block.fCompressedSize > size - in || block.fSize / block.fCompressedSize > kMaxRatio) {
+                return 0;
+            }
+            in += block.fCompressedSize;
+            total += block.fSize;
+        }
+        return in == size ? total : 0;
+    }
+
+    /// @brief decompress a part compressed with the given codec into out (of the uncompressed size)
+    /// @return false if the codec is not available or the data does not match the sizes
+    bool Decompress(Codec codec, const void* data, size_t size, void* out, size_t outSize)
+    {
+        if (!CodecAvailable(codec) || codec == Codec::none || size < sizeof(uint64_t)) {
+            return false;
+        }
+        uint64_t numBlocks = 0;
+        std::memcpy(&numBlocks, data, sizeof(numBlocks));
+        if (numBlocks == 0 || numBlocks > (size - sizeof(uint64_t)) / sizeof(CompressedBlockHeader)) {
+            return false;
+        }
+        std::vector<CompressedBlockHeader> blocks(numBlocks);
+        std::memcpy(blocks.data(), static_cast<const char*>(data) + sizeof(uint64_t), numBlocks * sizeof(CompressedBlockHeader));
+
+        std::vector<size_t> inOffsets(numBlocks);
+        std::vector<size_t> outOffsets(numBlocks);
+        size_t in = sizeof(uint64_t) + numBlocks * sizeof(CompressedBlockHeader);
+        size_t total = 0;
+        for (size_t i = 0; i < numBlocks; ++i) {
+            inOffsets[i] = in;
+            outOffsets[i] = total;
+            in += blocks[i].fCompressedSize;
+            total += blocks[i].fSize;
+            if (in > size || total > outSize) {
+                return false;
+            }
+        }
+        if (in != size || total != outSize) {
+            return false;
+        }
+
+        return Run(numBlocks, [&](size_t i, Context& ctx) {
+            return DecompressBlock(codec, ctx, static_cast<const char*>(data) + inOffsets[i], blocks[i].fCompressedSize, static_cast<char*>(out) + outOffsets[i], blocks[i].fSize);
+        });
+    }
+
+    ~Compressor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(fMtx);
+            fStop = true;
+        }
+        fWorkCV.notify_all();
+        for (auto& w : fWorkers) {
+            w.join();
+        }
+    }
+
+  private:
+    // per thread codec state, created on first use
+    struct Context
+    {
+        Context() = default;
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+#if FAIRMQ_HAS_ZSTD
+        ZSTD_CCtx* fCCtx = nullptr;
+        ZSTD_DCtx* fDCtx = nullptr;
+        ~Context()
+        {
+            ZSTD_freeCCtx(fCCtx);
+            ZSTD_freeDCtx(fDCtx);
+        }
+#endif
+    };
+
+    size_t Bound(size_t size) const
+    {
+        switch (fCodec) {
+#if FAIRMQ_HAS_LZ4
+            case Codec::lz4: return LZ4_compressBound(static_cast<int>(size));
+#endif
+#if FAIRMQ_HAS_ZSTD
+            case Codec::zstd: return ZSTD_compressBound(size);
+#endif
+            default: return size;
+        }
+    }
+
+    // @return compressed size, 0 on failure
+    size_t CompressBlock([[maybe_unused]] Context& ctx, [[maybe_unused]] const char* src, [[maybe_unused]] size_t size, [[maybe_unused]] char* dst, [[maybe_unused]] size_t capacity) const
+    {
+        switch (fCodec) {
+#if FAIRMQ_HAS_LZ4
+            case Codec::lz4: {
+                int n = fLevel > 0 ? LZ4_compress_HC(src, dst, static_cast<int>(size), static_cast<int>(capacity), fLevel)
+                                   : LZ4_compress_fast(src, dst, static_cast<int>(size), static_cast<int>(capacity), fLevel < 0 ? -fLevel : 1);
+                return n > 0 ? static_cast<size_t>(n) : 0;
+            }
+#endif
+#if FAIRMQ_HAS_ZSTD
+            case Codec::zstd: {
+                if (!ctx.fCCtx && !(ctx.fCCtx = ZSTD_createCCtx())) {
+                    return 0;
+                }
+                size_t n = ZSTD_compressCCtx(ctx.fCCtx, dst, capacity, src, size, fLevel == 0 ? ZSTD_CLEVEL_DEFAULT : fLevel);
+                return ZSTD_isError(n) ? 0 : n;
+            }
+#endif
+            default: return 0;
+        }
+    }
+
+    static bool DecompressBlock(Codec codec, [[maybe_unused]] Context& ctx, [[maybe_unused]] const char* src, [[maybe_unused]] size_t size, [[maybe_unused]] char* dst, [[maybe_unused]] size_t outSize)
+    {
+        switch (codec) {
+#if FAIRMQ_HAS_LZ4
+            case Codec::lz4:
+                return size <= static_cast<size_t>(LZ4_compressBound(kMaxBlockSize)) && outSize <= kMaxBlockSize
+                    && LZ4_decompress_safe(src, dst, static_cast<int>(size), static_cast<int>(outSize)) == static_cast<int>(outSize);
+#endif
+#if FAIRMQ_HAS_ZSTD
+            case Codec::zstd: {
+                if (!ctx.fDCtx && !(ctx.fDCtx = ZSTD_createDCtx())) {
+                    return false;
+                }
+                size_t n = ZSTD_decompressDCtx(ctx.fDCtx, dst, outSize, src, size);
+                return !ZSTD_isError(n) && n == outSize;
+            }
+#endif
+            default: return false;
+        }
+    }
+
+    // run job(i, context) for i in [0, n), on the calling thread and the workers, returns false if any job failed
+    bool Run(size_t n, const std::function<bool(size_t, Context&)>& job)
+    {
+        if (n == 1 || fWorkers.empty()) {
+            bool ok = true;
+            for (size_t i = 0; i < n; ++i) {
+                ok = job(i, fContexts[0]) && ok;
+            }
+            return ok;
+        }
+        {
+            std::lock_guard<std::mutex> lock(fMtx);
+            fJob = &job;
+            fNext = 0;
+            fCount = n;
+            fPending = n;
+            fFailed = false;
+        }
+        fWorkCV.notify_all();
+        Work(0);
+        std::unique_lock<std::mutex> lock(fMtx);
+        fDoneCV.wait(lock, [this]() { return fPending == 0; });
+        fJob = nullptr;
+        return !fFailed;
+    }
+
+    void Work(size_t worker)
+    {
+        while (true) {
+            const std::function<bool(size_t, Context&)>* job = nullptr;
+            size_t i = 0;
+            {
+                std::lock_guard<std::mutex> lock(fMtx);
+                if (!fJob || fNext >= fCount) {
+                    return;
+                }
+                job = fJob;
+                i = fNext++;
+            }
+            bool ok = (*job)(i, fContexts[worker]);
+            std::lock_guard<std::mutex> lock(fMtx);
+            fFailed = fFailed || !ok;
+            if (--fPending == 0) {
+                fDoneCV.notify_all();
+            }
+        }
+    }
+
+    void WorkerLoop(size_t worker)
+    {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(fMtx);
+                fWorkCV.wait(lock, [this]() { return fStop || (fJob && fNext < fCount); });
+                if (fStop) {
+                    return;
+                }
+            }
+            Work(worker);
+        }
+    }
+
+    const Codec fCodec;
+    const int fLevel;
+    const size_t fThreshold;
+    std::vector<Context> fContexts; // one per thread, [0] - calling thread
+
+    std::vector<std::thread> fWorkers;
+    std::mutex fMtx;
+    std::condition_variable fWorkCV;
+    std::condition_variable fDoneCV;
+    const std::function<bool(size_t, Context&)>* fJob = nullptr;
+    size_t fNext = 0;
+    size_t fCount = 0;
+    size_t fPending = 0;
+    bool fFailed = false;
+    bool fStop = false;
+};
+
+} // namespace fair::mq::zmq
+
+#endif /* FAIR_MQ_ZMQ_COMPRESSION_H */
@@ -10,6 +10,8 @@
 #define FAIR_MQ_ZMQ_CONTEXT_H_
 
 #include <fairmq/tools/Strings.h>
+#include <fairmq/tools/Thread.h>
+#include <fairmq/zeromq/Common.h>
 #include <fairmq/UnmanagedRegion.h>
 
 #include <fairlogger/Logger.h>
@@ -34,10 +36,11 @@ struct ContextError : std::runtime_error { using std::runtime_error::runtime_err
 class Context
 {
   public:
-    Context(int numIoThreads)
+    Context(int numIoThreads, tools::ThreadPlacement ioPlacement = tools::ThreadPlacement(), tools::ThreadPlacement housekeepingPlacement = tools::ThreadPlacement())
         : fZmqCtx(zmq_ctx_new())
         , fInterrupted(false)
         , fRegionCounter(1)
+        , fHousekeepingPlacement(std::move(housekeepingPlacement))
     {
         if (!fZmqCtx) {
             throw ContextError(tools::ToString("failed creating context, reason: ", zmq_strerror(errno)));
@@ -53,6 +56,12 @@ class Context
             throw ContextError(tools::ToString("failed configuring context, reason: ", zmq_strerror(errno)));
         }
 
+        try {
+            SetIoThreadPlacement(fZmqCtx, ioPlacement);
+        } catch (const Error& e) {
+            throw ContextError(e.what());
+        }
+
         fRegionEvents.emplace(true, 0, nullptr, 0, 0, RegionEvent::local_only);
     }
 
@@ -95,6 +104,7 @@ class Context
 
     void RegionEventsSubscription()
     {
+        tools::ApplyThreadPlacement("fmq-zmq-revents", fHousekeepingPlacement);
         std::unique_lock<std::mutex> lock(fMtx);
         while (fRegionEventsSubscriptionActive) {
             while (!fRegionEvents.empty()) {
@@ -187,6 +197,7 @@ class Context
     std::thread fRegionEventThread;
     std::function<void(RegionInfo)> fRegionEventCallback;
     bool fRegionEventsSubscriptionActive;
+    tools::ThreadPlacement fHousekeepingPlacement;
 };
 
 } // namespace fair::mq::zmq
@@ -234,6 +234,35 @@ class Message final : public fair::mq::Message
         }
     }
 
+    bool Resize(size_t size, Alignment alignment = Alignment{0}) override
+    {
+        if (size <= GetSize()) {
+            return SetUsedSize(size);
+        }
+
+        size_t newAlignment = (alignment.alignment != 0) ? alignment.alignment : fAlignment;
+        auto newMsg = std::make_unique<zmq_msg_t>();
+        if (newAlignment != 0) {
+            auto ptrs = AllocateAligned(size, newAlignment);
+            if (zmq_msg_init_data(newMsg.get(), ptrs.second, size, [](void* /* data */, void* hint) { free(hint); }, ptrs.first) != 0) {
+                LOG(error) << "failed initializing message with size, reason: " << zmq_strerror(errno);
+                free(ptrs.first);
+                return false;
+            }
+        } else if (zmq_msg_init_size(newMsg.get(), size) != 0) {
+            LOG(error) << "failed initializing message with size, reason: " << zmq_strerror(errno);
+            return false;
+        }
+
+        if (GetSize() > 0) {
+            std::memcpy(zmq_msg_data(newMsg.get()), GetData(), GetSize());
+        }
+        CloseMessage();
+        fAlignment = newAlignment;
+        fMsg.swap(newMsg);
+        return true;
+    }
+
     void Realign()
     {
         // if alignment is provided
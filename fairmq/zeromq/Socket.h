@@ -13,6 +13,7 @@
 #include <fairmq/Socket.h>
 #include <fairmq/tools/Strings.h>
 #include <fairmq/zeromq/Common.h>
+#include <fairmq/zeromq/Compression.h>
 #include <fairmq/zeromq/Context.h>
 #include <fairmq/zeromq/Message.h>
 
@@ -20,10 +21,14 @@
 
 #include <zmq.h>
 
+#include <algorithm> // move
 #include <atomic>
+#include <cstring> // memcpy
 #include <functional>
+#include <iterator> // back_inserter
 #include <memory> // unique_ptr, make_unique
 #include <string_view>
+#include <vector>
 
 namespace fair::mq::zmq
 {
@@ -41,6 +46,8 @@ class Socket final : public fair::mq::Socket
         , fBytesRx(0)
         , fMessagesTx(0)
         , fMessagesRx(0)
+        , fBytesTxUncompressed(0)
+        , fBytesRxUncompressed(0)
         , fTimeout(100)
         , fConnectedPeersCount(0)
     {
@@ -96,6 +103,10 @@ class Socket final : public fair::mq::Socket
 
     int64_t Send(MessagePtr& msg, int timeout = -1) override
     {
+        if (fCompressor) {
+            return SendCompressed(&msg, 1, timeout);
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -126,6 +137,21 @@ class Socket final : public fair::mq::Socket
 
     int64_t Receive(MessagePtr& msg, int timeout = -1) override
     {
+        if (fCompressor) {
+            Parts::container parts;
+            int64_t nbytes = ReceiveCompressed(parts, timeout);
+            if (nbytes >= 0) {
+                if (parts.size() != 1) {
+                    LOG(error) << "Received a multipart message with " << parts.size() << " parts on " << fId << ", expected a single part";
+                    return static_cast<int>(TransferCode::error);
+                }
+                auto m = static_cast<Message*>(msg.get());
+                zmq_msg_move(m->GetMessage(), static_cast<Message*>(parts.front().get())->GetMessage());
+                m->Realign();
+            }
+            return nbytes;
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -163,6 +189,10 @@ class Socket final : public fair::mq::Socket
 
         const unsigned int vecSize = msgVec.size();
 
+        if (fCompressor && vecSize > 0) {
+            return SendCompressed(msgVec.data(), vecSize, timeout);
+        }
+
         // Sending vector typicaly handles more then one part
         if (vecSize > 1) {
             int elapsed = 0;
@@ -208,6 +238,10 @@ class Socket final : public fair::mq::Socket
 
     int64_t Receive(Parts::container& msgVec, int timeout = -1) override
     {
+        if (fCompressor) {
+            return ReceiveCompressed(msgVec, timeout);
+        }
+
         int flags = 0;
         if (timeout == 0) {
             flags = ZMQ_DONTWAIT;
@@ -255,6 +289,18 @@ class Socket final : public fair::mq::Socket
         }
     }
 
+    void SetCompression(const std::string& codec, int level, size_t threshold, int threads) override
+    {
+        Codec c = ParseCodec(codec);
+        if (c == Codec::none) {
+            fCompressor.reset();
+        } else if (!CodecAvailable(c)) {
+            throw SocketError(tools::ToString("compression codec '", codec, "' is not available, FairMQ was built without it"));
+        } else {
+            fCompressor = std::make_unique<Compressor>(c, level, threshold, threads);
+        }
+    }
+
     void* GetSocket() const { return fSocket; }
 
     void Close() override
@@ -389,6 +435,8 @@ class Socket final : public fair::mq::Socket
     unsigned long GetBytesRx() const override { return fBytesRx; }
     unsigned long GetMessagesTx() const override { return fMessagesTx; }
     unsigned long GetMessagesRx() const override { return fMessagesRx; }
+    unsigned long GetBytesTxUncompressed() const override { return fCompressor ? fBytesTxUncompressed : fBytesTx; }
+    unsigned long GetBytesRxUncompressed() const override { return fCompressor ? fBytesRxUncompressed : fBytesRx; }
 
     [[deprecated("Use fair::mq::zmq::getConstant() from <fairmq/zeromq/Common.h> instead.")]]
     static int GetConstant(const std::string& constant) { return getConstant(constant); }
@@ -396,6 +444,179 @@ class Socket final : public fair::mq::Socket
     ~Socket() override { Close(); }
 
   private:
+    /// send n parts as one multipart message, preceded by a header frame describing them (see Compression.h)
+    int64_t SendCompressed(MessagePtr* msgs, size_t n, int timeout)
+    {
+        int flags = 0;
+        if (timeout == 0) {
+            flags = ZMQ_DONTWAIT;
+        }
+        int elapsed = 0;
+
+        ZMsg header(sizeof(CompressionHeader) + n * sizeof(CompressedPartHeader));
+        CompressionHeader frameHeader{Compressor::kMagic, static_cast<uint32_t>(n)};
+        std::memcpy(header.Data(), &frameHeader, sizeof(frameHeader));
+
+        std::vector<ZMsg> compressed(n);
+        std::vector<zmq_msg_t*> frames;
+        frames.reserve(n + 1);
+        frames.push_back(header.Msg());
+        int64_t actualBytes = 0;
+        int64_t wireBytes = header.Size();
+        for (size_t i = 0; i < n; ++i) {
+            auto m = static_cast<Message*>(msgs[i].get());
+            CompressedPartHeader partHeader{m->GetSize(), Codec::none, {}};
+            if (fCompressor->Compress(m->GetData(), m->GetSize(), compressed[i])) {
+                partHeader.fCodec = fCompressor->GetCodec();
+                frames.push_back(compressed[i].Msg());
+                wireBytes += compressed[i].Size();
+            } else {
+                frames.push_back(m->GetMessage());
+                wireBytes += m->GetSize();
+            }
+            std::memcpy(static_cast<char*>(header.Data()) + sizeof(CompressionHeader) + i * sizeof(CompressedPartHeader), &partHeader, sizeof(partHeader));
+            actualBytes += m->GetSize();
+        }
+
+        while (true) {
+            bool repeat = false;
+
+            for (size_t i = 0; i < frames.size(); ++i) {
+                int nbytes = zmq_msg_send(frames[i], fSocket, (i < frames.size() - 1) ? ZMQ_SNDMORE | flags : flags);
+                if (nbytes >= 0) {
+                    continue;
+                } else if (zmq_errno() == EAGAIN || zmq_errno() == EINTR) {
+                    if (fCtx.Interrupted()) {
+                        return static_cast<int>(TransferCode::interrupted);
+                    } else if (zmq::ShouldRetry(flags, fTimeout, timeout, elapsed)) {
+                        repeat = true;
+                        break;
+                    } else {
+                        return static_cast<int>(TransferCode::timeout);
+                    }
+                } else {
+                    return zmq::HandleErrors(fId);
+                }
+            }
+
+            if (repeat) {
+                continue;
+            }
+
+            // the compressed parts went out in place of the originals, release them like zmq does with sent messages
+            for (size_t i = 0; i < n; ++i) {
+                if (frames[i + 1] != static_cast<Message*>(msgs[i].get())->GetMessage()) {
+                    msgs[i]->Rebuild();
+                }
+            }
+
+            ++fMessagesTx;
+            fBytesTx += wireBytes;
+            fBytesTxUncompressed += actualBytes;
+            return actualBytes;
+        }
+    }
+
+    /// receive a message sent by SendCompressed, appending the decompressed parts to msgVec
+    int64_t ReceiveCompressed(Parts::container& msgVec, int timeout)
+    {
+        int flags = 0;
+        if (timeout == 0) {
+            flags = ZMQ_DONTWAIT;
+        }
+        int elapsed = 0;
+
+        ZMsg header;
+        while (true) {
+            int nbytes = zmq_msg_recv(header.Msg(), fSocket, flags);
+            if (nbytes >= 0) {
+                break;
+            } else if (zmq_errno() == EAGAIN || zmq_errno() == EINTR) {
+                if (fCtx.Interrupted()) {
+                    return static_cast<int>(TransferCode::interrupted);
+                } else if (zmq::ShouldRetry(flags, fTimeout, timeout, elapsed)) {
+                    continue;
+                } else {
+                    return static_cast<int>(TransferCode::timeout);
+                }
+            } else {
+                return zmq::HandleErrors(fId);
+            }
+        }
+
+        // the remaining frames of a multipart message are delivered together with the first one
+        CompressionHeader frameHeader{0, 0};
+        if (header.Size() >= sizeof(CompressionHeader)) {
+            std::memcpy(&frameHeader, header.Data(), sizeof(frameHeader));
+        }
+        if (frameHeader.fMagic != Compressor::kMagic || frameHeader.fNumParts == 0
+            || header.Size() != sizeof(CompressionHeader) + frameHeader.fNumParts * sizeof(CompressedPartHeader)) {
+            LOG(error) << "Received a message without compression header on " << fId << ", is compression enabled on the peer?";
+            DiscardRemainingFrames(zmq_msg_more(header.Msg()));
+            return static_cast<int>(TransferCode::error);
+        }
+
+        Parts::container parts;
+        int64_t actualBytes = 0;
+        int64_t wireBytes = header.Size();
+        bool more = zmq_msg_more(header.Msg());
+        for (uint32_t i = 0; i < frameHeader.fNumParts; ++i) {
+            if (!more) {
+                LOG(error) << "Received " << i << " parts on " << fId << ", compression header announced " << frameHeader.fNumParts;
+                return static_cast<int>(TransferCode::error);
+            }
+            CompressedPartHeader partHeader;
+            std::memcpy(&partHeader, static_cast<const char*>(header.Data()) + sizeof(CompressionHeader) + i * sizeof(CompressedPartHeader), sizeof(partHeader));
+
+            auto part = std::make_unique<Message>(GetTransport());
+            if (zmq_msg_recv(part->GetMessage(), fSocket, 0) < 0) {
+                return zmq::HandleErrors(fId);
+            }
+            more = zmq_msg_more(part->GetMessage());
+            wireBytes += part->GetSize();
+
+            if (partHeader.fCodec != Codec::none) {
+                // the announced size is allocated below, it has to match the block table of the part
+                if (partHeader.fSize != Compressor::UncompressedSize(part->GetData(), part->GetSize())) {
+                    LOG(error) << "Invalid size of compressed part " << i << " on " << fId << " (" << partHeader.fSize << " bytes announced)";
+                    DiscardRemainingFrames(more);
+                    return static_cast<int>(TransferCode::error);
+                }
+                auto decompressed = std::make_unique<Message>(partHeader.fSize, GetTransport());
+                if (!fCompressor->Decompress(partHeader.fCodec, part->GetData(), part->GetSize(), decompressed->GetData(), partHeader.fSize)) {
+                    LOG(error) << "Failed decompressing part " << i << " on " << fId << " (codec " << static_cast<int>(partHeader.fCodec) << ")";
+                    DiscardRemainingFrames(more);
+                    return static_cast<int>(TransferCode::error);
+                }
+                part = std::move(decompressed);
+            }
+            actualBytes += part->GetSize();
+            parts.push_back(std::move(part));
+        }
+        if (more) {
+            LOG(error) << "Received more parts on " << fId << " than announced in the compression header (" << frameHeader.fNumParts << ")";
+            DiscardRemainingFrames(more);
+            return static_cast<int>(TransferCode::error);
+        }
+
+        std::move(parts.begin(), parts.end(), std::back_inserter(msgVec));
+        ++fMessagesRx;
+        fBytesRx += wireBytes;
+        fBytesRxUncompressed += actualBytes;
+        return actualBytes;
+    }
+
+    void DiscardRemainingFrames(bool more)
+    {
+        while (more) {
+            ZMsg frame;
+            if (zmq_msg_recv(frame.Msg(), fSocket, 0) < 0) {
+                return;
+            }
+            more = zmq_msg_more(frame.Msg());
+        }
+    }
+
     Context& fCtx;
     std::string fId;
     void* fSocket;
@@ -404,6 +625,9 @@ class Socket final : public fair::mq::Socket
     std::atomic<unsigned long> fBytesRx;
     std::atomic<unsigned long> fMessagesTx;
     std::atomic<unsigned long> fMessagesRx;
+    std::atomic<unsigned long> fBytesTxUncompressed;
+    std::atomic<unsigned long> fBytesRxUncompressed;
+    std::unique_ptr<Compressor> fCompressor;
 
     int fTimeout;
     mutable unsigned long fConnectedPeersCount;
@@ -36,7 +36,9 @@ class TransportFactory final : public fair::mq::TransportFactory
         LOG(debug) << "Transport: Using ZeroMQ library, version: " << major << "." << minor << "." << patch;
 
         if (config) {
-            fCtx = std::make_unique<Context>(config->GetProperty<int>("io-threads", 1));
+            fCtx = std::make_unique<Context>(config->GetProperty<int>("io-threads", 1),
+                                             tools::GetThreadPlacement(config, "io"),
+                                             tools::GetThreadPlacement(config, "housekeeping"));
         } else {
             LOG(debug) << "fair::mq::ProgOptions not available! Using defaults.";
             fCtx = std::make_unique<Context>(1);
@@ -145,6 +147,7 @@ class TransportFactory final : public fair::mq::TransportFactory
     void Interrupt() override { fCtx->Interrupt(); }
     void Resume() override { fCtx->Resume(); }
     void Reset() override { fCtx->Reset(); }
+    bool Interrupted() override { return fCtx->Interrupted(); }
 
     ~TransportFactory() override { LOG(debug) << "Destroying ZeroMQ transport..."; }
 
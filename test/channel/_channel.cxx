@@ -12,8 +12,10 @@
 #include <fairmq/Tools.h>
 #include <fairmq/TransportFactory.h>
 #include <gtest/gtest.h>
+#include <random>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace
 {
@@ -82,6 +84,33 @@ TEST(Channel, Validation)
     channel.UpdateRateLogging(1);
     ASSERT_NO_THROW(channel.Validate());
 
+    channel.UpdateCompression("gzip");
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateCompression("zstd");
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateCompressionThreshold(-1);
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateCompressionThreshold(0);
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateCompressionThreads(0);
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateCompressionThreads(4);
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateCompression("none");
+    channel.UpdateMaxBytesPerSec(-1);
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateMaxBytesPerSec(1000000);
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateMaxMsgsPerSec(-1);
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateMaxMsgsPerSec(0);
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateShapingBurstMs(-1);
+    ASSERT_THROW(channel.Validate(), Channel::ChannelConfigurationError);
+    channel.UpdateShapingBurstMs(0);
+    ASSERT_NO_THROW(channel.Validate());
+    channel.UpdateMaxBytesPerSec(0);
+
     Channel channel2 = channel;
     ASSERT_NO_THROW(channel2.Validate());
     ASSERT_EQ(channel2.Validate(), true);
@@ -135,4 +164,130 @@ TEST(Channel, GetNumberOfConnectedPeers_shmem)
     testConnectedPeers("shmem");
 }
 
+void testShaping(const string& transport)
+{
+    using namespace std::chrono;
+
+    ProgOptions config;
+    config.SetProperty<string>("session", tools::Uuid());
+    string const address(tools::ToString("ipc://test_shaping_", config.GetProperty<string>("session")));
+    auto factory(TransportFactory::CreateTransportFactory(transport, tools::Uuid(), &config));
+
+    Channel push("data[0]", "push", factory);
+    Channel pull("data[1]", "pull", factory);
+    push.UpdateMaxBytesPerSec(1000000);
+    push.UpdateMaxMsgsPerSec(500);
+    push.UpdateShapingBurstMs(10);
+    push.Init();
+    ASSERT_TRUE(push.IsShaped());
+    ASSERT_FALSE(pull.IsShaped());
+    push.Bind(address);
+    pull.Connect(address);
+
+    // 10 x 10 kB at 1 MB/s, the first two fit into the burst allowance (10 ms), the rest waits 10 ms each
+    auto const start = steady_clock::now();
+    for (int i = 0; i < 10; ++i) {
+        auto msg(push.NewMessage(10000));
+        ASSERT_EQ(push.Send(msg), 10000);
+    }
+    EXPECT_GE(steady_clock::now() - start, milliseconds(75));
+
+    Channel::ShapingStats stats = push.GetShapingStats();
+    EXPECT_GE(stats.delayedSends, 7);
+    EXPECT_GE(stats.delay, milliseconds(75));
+    EXPECT_EQ(stats.timeouts, 0);
+
+    // not waiting for the bandwidth limit with a timeout of 0
+    auto msg(push.NewMessage(10000));
+    ASSERT_EQ(push.Send(msg, 0), static_cast<int64_t>(TransferCode::timeout));
+    EXPECT_EQ(push.GetShapingStats().timeouts, 1);
+
+    for (int i = 0; i < 10; ++i) {
+        auto received(pull.NewMessage());
+        ASSERT_EQ(pull.Receive(received), 10000);
+    }
+}
+
+TEST(Channel, Shaping_zeromq)
+{
+    testShaping("zeromq");
+}
+
+TEST(Channel, Shaping_shmem)
+{
+    testShaping("shmem");
+}
+
+#if FAIRMQ_HAS_LZ4 || FAIRMQ_HAS_ZSTD
+void testCompression(const string& codec)
+{
+    ProgOptions config;
+    config.SetProperty<string>("session", tools::Uuid());
+    string const address(tools::ToString("ipc://test_compression_", config.GetProperty<string>("session")));
+    auto factory(TransportFactory::CreateTransportFactory("zeromq", tools::Uuid(), &config));
+
+    Channel push("data[0]", "push", factory);
+    Channel pull("data[1]", "pull", factory);
+    push.GetSocket().SetCompression(codec, 0, 4096, 2);
+    pull.GetSocket().SetCompression(codec, 0, 4096, 2);
+    push.Bind(address);
+    pull.Connect(address);
+
+    auto fill = [](Message& msg, bool compressible) {
+        mt19937 gen(msg.GetSize());
+        auto data = static_cast<char*>(msg.GetData());
+        for (size_t i = 0; i < msg.GetSize(); ++i) {
+            data[i] = compressible ? "FairMQ"[gen() % 6] : static_cast<char>(gen());
+        }
+        return string(data, msg.GetSize());
+    };
+    auto content = [](const MessagePtr& msg) { return string(static_cast<const char*>(msg->GetData()), msg->GetSize()); };
+
+    // large enough to be split into blocks, compressed by two threads
+    size_t const size = 3 * 1024 * 1024 + 17;
+    auto msg(push.NewMessage(size));
+    string const expected(fill(*msg, true));
+    ASSERT_EQ(push.Send(msg), size);
+    auto received(pull.NewMessage(Alignment{64}));
+    ASSERT_EQ(pull.Receive(received), size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(received->GetData()) % 64, 0);
+    EXPECT_EQ(content(received), expected);
+
+    EXPECT_EQ(push.GetBytesTxUncompressed(), size);
+    EXPECT_EQ(pull.GetBytesRxUncompressed(), size);
+    EXPECT_LT(push.GetBytesTx(), size / 2);
+    EXPECT_EQ(pull.GetBytesRx(), push.GetBytesTx());
+
+    // below the threshold and incompressible parts are sent as they are
+    Parts parts(push.NewMessage(100), push.NewMessage(100000), push.NewMessage(100000));
+    vector<string> expectedParts{fill(parts[0], true), fill(parts[1], false), fill(parts[2], true)};
+    ASSERT_EQ(push.Send(parts), 200100);
+    Parts receivedParts;
+    auto const bytesRx(pull.GetBytesRx());
+    ASSERT_EQ(pull.Receive(receivedParts), 200100);
+    ASSERT_EQ(receivedParts.Size(), 3);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(content(receivedParts.At(i)), expectedParts.at(i));
+    }
+    EXPECT_EQ(pull.GetBytesRxUncompressed(), size + 200100);
+    // the incompressible part dominates the bytes on the wire
+    EXPECT_GT(pull.GetBytesRx() - bytesRx, 100100);
+    EXPECT_LT(pull.GetBytesRx() - bytesRx, 150000);
+}
+#endif
+
+#if FAIRMQ_HAS_LZ4
+TEST(Channel, Compression_lz4)
+{
+    testCompression("lz4");
+}
+#endif
+
+#if FAIRMQ_HAS_ZSTD
+TEST(Channel, Compression_zstd)
+{
+    testCompression("zstd");
+}
+#endif
+
 } /* namespace */
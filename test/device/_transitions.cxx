@@ -7,10 +7,12 @@
  ********************************************************************************/
 
 #include <fairmq/Device.h>
+#include <fairmq/StateMachine.h>
 #include <fairlogger/Logger.h>
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <vector>
 #include <thread>
 
@@ -42,4 +44,42 @@ TEST(Transitions, InvalidChangeStateOrThrow)
     if (t.joinable()) { t.join(); }
 }
 
+TEST(Transitions, PendingStateNotification)
+{
+    using namespace std::chrono_literals;
+
+    StateMachine fsm;
+    fsm.Start();
+    EXPECT_EQ(fsm.GetCurrentState(), State::Idle);
+    EXPECT_FALSE(fsm.NewStatePending());
+    EXPECT_FALSE(fsm.WaitForPendingStateFor(10));
+
+    thread requester([&] {
+        this_thread::sleep_for(50ms);
+        fsm.ChangeState(Transition::InitDevice);
+    });
+    EXPECT_TRUE(fsm.WaitForPendingStateFor(5000));
+    EXPECT_TRUE(fsm.NewStatePending());
+    EXPECT_EQ(fsm.GetCurrentState(), State::Idle);
+    requester.join();
+    EXPECT_FALSE(fsm.ChangeState(Transition::End)); // another transition is pending
+
+    vector<State> states;
+    fsm.HandleStates([&](State state) {
+        states.push_back(state);
+        switch (state) {
+            case State::InitializingDevice: fsm.ChangeState(Transition::CompleteInit); break;
+            case State::Initialized: fsm.ChangeState(Transition::ResetDevice); break;
+            case State::ResettingDevice: fsm.ChangeState(Transition::Auto); break;
+            case State::Idle: fsm.ChangeState(Transition::End); break;
+            default: break;
+        }
+    });
+    fsm.ProcessWork();
+
+    EXPECT_EQ(states, (vector<State>{State::InitializingDevice, State::Initialized, State::ResettingDevice, State::Idle, State::Exiting}));
+    EXPECT_EQ(fsm.GetCurrentState(), State::Exiting);
+    EXPECT_FALSE(fsm.NewStatePending());
+}
+
 } // namespace
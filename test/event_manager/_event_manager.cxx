@@ -8,7 +8,12 @@
 
 #include <gtest/gtest.h>
 #include <fairmq/EventManager.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace
 {
@@ -17,6 +22,7 @@ using namespace std;
 using namespace fair::mq;
 
 struct TestEvent : fair::mq::Event<const std::string&> {};
+using IntCallback = std::function<void(typename TestEvent::KeyType, int)>;
 
 TEST(EventManager, Basics)
 {
@@ -61,4 +67,102 @@ TEST(EventManager, Basics)
     ASSERT_EQ(value2, "over 9000");
 }
 
+TEST(EventManager, SubscribersAndOrder)
+{
+    EventManager mgr{};
+    vector<string> calls;
+
+    ASSERT_FALSE((mgr.HasSubscribers<TestEvent, int>()));
+    ASSERT_THROW((mgr.Unsubscribe<TestEvent, int>("nobody")), std::out_of_range);
+
+    mgr.Subscribe<TestEvent, int>("a", IntCallback{[&](TestEvent::KeyType, int) { calls.push_back("a"); }});
+    mgr.Subscribe<TestEvent, int>("b", IntCallback{[&](TestEvent::KeyType, int) { calls.push_back("b"); }});
+    ASSERT_TRUE((mgr.HasSubscribers<TestEvent, int>()));
+    ASSERT_FALSE((mgr.HasSubscribers<TestEvent, string>()));
+
+    // resubscribing moves the subscriber to the end
+    mgr.Subscribe<TestEvent, int>("a", IntCallback{[&](TestEvent::KeyType, int) { calls.push_back("a2"); }});
+    mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1);
+    ASSERT_EQ(calls, (vector<string>{"b", "a2"}));
+
+    // subscribing from a callback takes effect with the next emission
+    calls.clear();
+    mgr.Subscribe<TestEvent, int>("c", IntCallback{[&](TestEvent::KeyType, int) {
+        calls.push_back("c");
+        mgr.Subscribe<TestEvent, int>("d", IntCallback{[&](TestEvent::KeyType, int) { calls.push_back("d"); }});
+    }});
+    mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 2);
+    ASSERT_EQ(calls, (vector<string>{"b", "a2", "c"}));
+
+    mgr.Unsubscribe<TestEvent, int>("a");
+    mgr.Unsubscribe<TestEvent, int>("b");
+    mgr.Unsubscribe<TestEvent, int>("c");
+    mgr.Unsubscribe<TestEvent, int>("d");
+    ASSERT_FALSE((mgr.HasSubscribers<TestEvent, int>()));
+}
+
+TEST(EventManager, ConcurrentEmitAndSubscribe)
+{
+    EventManager mgr{};
+    atomic<int> calls(0);
+    atomic<bool> stop(false);
+
+    mgr.Subscribe<TestEvent, int>("counter", IntCallback{[&](TestEvent::KeyType, int value) { calls += value; }});
+
+    vector<thread> emitters;
+    for (int i = 0; i < 4; ++i) {
+        emitters.emplace_back([&] {
+            while (!stop) {
+                mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1);
+            }
+        });
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        auto id = to_string(i % 10);
+        mgr.Subscribe<TestEvent, int>(id, IntCallback{[](TestEvent::KeyType, int) {}});
+        mgr.Unsubscribe<TestEvent, int>(id);
+    }
+    stop = true;
+    for (auto& t : emitters) {
+        t.join();
+    }
+
+    int before = calls;
+    mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1);
+    ASSERT_EQ(calls, before + 1);
+}
+
+TEST(EventManager, UnsubscribeWaitsForEmissions)
+{
+    EventManager mgr{};
+    atomic<bool> entered(false);
+    atomic<bool> done(false);
+
+    mgr.Subscribe<TestEvent, int>("slow", IntCallback{[&](TestEvent::KeyType, int) {
+        entered = true;
+        this_thread::sleep_for(chrono::milliseconds(100));
+        done = true;
+    }});
+
+    thread emitter([&] { mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1); });
+    while (!entered) {
+        this_thread::yield();
+    }
+    mgr.Unsubscribe<TestEvent, int>("slow");
+    EXPECT_TRUE(done);
+    emitter.join();
+
+    // unsubscribing from a callback (of the same thread) does not wait for itself
+    int calls = 0;
+    mgr.Subscribe<TestEvent, int>("self", IntCallback{[&](TestEvent::KeyType, int) {
+        ++calls;
+        mgr.Unsubscribe<TestEvent, int>("self");
+    }});
+    mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1);
+    mgr.Emit<TestEvent>(TestEvent::KeyType{"test"}, 1);
+    EXPECT_EQ(calls, 1);
+    EXPECT_FALSE((mgr.HasSubscribers<TestEvent, int>()));
+}
+
 } // namespace
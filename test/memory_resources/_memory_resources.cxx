@@ -173,4 +173,69 @@ TEST(MemoryResources, getMessage)
     EXPECT_TRUE(messageArray[0] == 4 && messageArray[1] == 5 && messageArray[2] == 6);
 }
 
+void Arena(const string& transport)
+{
+    size_t session{tools::UuidHash()};
+    ProgOptions config;
+    config.SetProperty<string>("session", to_string(session));
+    config.SetProperty<bool>("shm-monitor", true);
+
+    FactoryType factory = TransportFactory::CreateTransportFactory(transport, fair::mq::tools::Uuid(), &config);
+
+    struct Item
+    {
+        int i;
+        double d;
+    };
+
+    ArenaResource arena(factory.get(), 4096);
+    polymorphic_allocator<Item> alloc(&arena);
+
+    // many small objects share the chunks
+    for (int i = 0; i < 100; ++i) {
+        Item* item = alloc.allocate(1);
+        new (item) Item{i, 0.5};
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(item) % alignof(Item), 0);
+    }
+    EXPECT_EQ(arena.getNumberOfMessages(), 1);
+    EXPECT_EQ(arena.getUsedSize(), 100 * sizeof(Item));
+
+    // an allocation exceeding the chunk size gets its own chunk
+    void* large = arena.allocate(4096, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0);
+    EXPECT_EQ(arena.getNumberOfMessages(), 2);
+    memset(large, 0, 4096);
+
+    {
+        MessagePtr msg = arena.finalize();
+        EXPECT_EQ(arena.getNumberOfMessages(), 0);
+        EXPECT_EQ(msg->GetSize(), 100 * sizeof(Item) + 4096);
+        auto data = static_cast<Item*>(msg->GetData());
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(data[i].i, i);
+        }
+    }
+
+    for (int i = 0; i < 300; ++i) {
+        new (alloc.allocate(1)) Item{i, 0.5};
+    }
+    Parts parts = arena.finalizeParts();
+    EXPECT_EQ(parts.Size(), 300 * sizeof(Item) / 4096 + 1);
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part->GetSize();
+    }
+    EXPECT_EQ(total, 300 * sizeof(Item));
+}
+
+TEST(MemoryResources, arena_zeromq)
+{
+    Arena("zeromq");
+}
+
+TEST(MemoryResources, arena_shmem)
+{
+    Arena("shmem");
+}
+
 }   // namespace
@@ -7,6 +7,7 @@
  ********************************************************************************/
 
 #include <fairmq/Channel.h>
+#include <fairmq/MessageBuilder.h>
 #include <fairmq/ProgOptions.h>
 #include <fairmq/tools/Semaphore.h>
 #include <fairmq/tools/Strings.h>
@@ -103,6 +104,131 @@ auto RunPushPullWithMsgResize(string const & transport, string const & _address,
     }
 }
 
+auto RunMsgGrow(string const & transport, string const & allocation = "rbtree_best_fit") -> void
+{
+    ProgOptions config;
+    config.SetProperty<string>("session", tools::Uuid());
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<string>("shm-allocation", allocation);
+    auto factory(TransportFactory::CreateTransportFactory(transport, tools::Uuid(), &config));
+
+    {
+        auto msg(factory->CreateMessage(4));
+        memcpy(msg->GetData(), "ABCD", 4);
+        ASSERT_TRUE(msg->Resize(3000000));
+        ASSERT_EQ(msg->GetSize(), 3000000);
+        ASSERT_EQ(AsStringView(*msg).substr(0, 4), "ABCD");
+        ASSERT_TRUE(msg->Resize(2));
+        ASSERT_EQ(AsStringView(*msg), "AB");
+    }
+
+    {
+        // growing a shared buffer must not affect the other reference
+        auto msg(factory->CreateMessage(4));
+        memcpy(msg->GetData(), "ABCD", 4);
+        auto msgCopy(factory->CreateMessage());
+        msgCopy->Copy(*msg);
+        ASSERT_TRUE(msg->Resize(1000, Alignment{64}));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(msg->GetData()) % 64, 0);
+        ASSERT_EQ(AsStringView(*msg).substr(0, 4), "ABCD");
+        ASSERT_EQ(AsStringView(*msgCopy), "ABCD");
+    }
+
+    {
+        // without alignment requirement the buffer could be grown in place, but not while it is shared
+        auto msg(factory->CreateMessage(4));
+        memcpy(msg->GetData(), "ABCD", 4);
+        auto msgCopy(factory->CreateMessage());
+        msgCopy->Copy(*msg);
+        ASSERT_TRUE(msg->Resize(1000));
+        ASSERT_NE(msg->GetData(), msgCopy->GetData());
+        ASSERT_EQ(AsStringView(*msg).substr(0, 4), "ABCD");
+        ASSERT_EQ(AsStringView(*msgCopy), "ABCD");
+    }
+
+    if (transport == "shmem") {
+        // growing beyond the segment size fails, the message keeps its buffer
+        auto msg(factory->CreateMessage(4));
+        memcpy(msg->GetData(), "ABCD", 4);
+        ASSERT_FALSE(msg->Resize(200000000));
+        ASSERT_EQ(AsStringView(*msg), "ABCD");
+    }
+
+    {
+        auto empty(factory->CreateMessage());
+        ASSERT_TRUE(empty->Resize(10));
+        ASSERT_EQ(empty->GetSize(), 10);
+    }
+
+    {
+        MessageBuilder builder(*factory, 16);
+        string expected;
+        for (int i = 0; i < 10000; ++i) {
+            string chunk(tools::ToString(i, ","));
+            builder.Append(chunk.data(), chunk.size());
+            expected += chunk;
+        }
+        char* out = builder.Reserve(5);
+        memcpy(out, "12345", 5);
+        builder.Commit(3);
+        expected += "123";
+        ASSERT_EQ(builder.GetSize(), expected.size());
+        auto msg(builder.Finalize());
+        ASSERT_EQ(AsStringView(*msg), expected);
+    }
+}
+
+auto RunSendGather(string const & transport, string const & _address) -> void
+{
+    ProgOptions config;
+    config.SetProperty<string>("session", tools::Uuid());
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    auto factory(TransportFactory::CreateTransportFactory(transport, tools::Uuid(), &config));
+
+    Channel push{"Push", "push", factory};
+    Channel pull{"Pull", "pull", factory};
+    auto const address(tools::ToString(_address, "_", transport, "_", config.GetProperty<string>("session")));
+    push.Bind(address);
+    pull.Connect(address);
+
+    vector<string> records;
+    vector<GatherBuffer> buffers;
+    for (int i = 0; i < 100; ++i) {
+        records.push_back(tools::ToString("record ", i, string(static_cast<size_t>(i % 7), 'x')));
+    }
+    records.emplace_back(); // empty segments are allowed
+    for (auto const& record : records) {
+        buffers.push_back(GatherBuffer{record.data(), record.size()});
+    }
+
+    ASSERT_GT(push.SendGather(buffers), 0);
+
+    auto inMsg(pull.NewMessage());
+    ASSERT_GT(pull.Receive(inMsg), 0);
+    GatherView view(*inMsg);
+    ASSERT_EQ(view.Size(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        ASSERT_EQ(string_view(static_cast<char const*>(view[i].data), view[i].size), records.at(i));
+    }
+    ASSERT_THROW(view.At(records.size()), out_of_range);
+
+    ASSERT_GT(push.SendGather(nullptr, 0), 0);
+    ASSERT_GT(pull.Receive(inMsg), 0);
+    ASSERT_TRUE(GatherView(*inMsg).Empty());
+
+    auto invalid(push.NewSimpleMessage("abc"));
+    ASSERT_THROW(GatherView{*invalid}, runtime_error);
+
+    // descending end offsets would yield a segment of negative size
+    auto descending(push.NewMessage(4 * sizeof(uint64_t), Alignment{alignof(uint64_t)}));
+    auto header = static_cast<uint64_t*>(descending->GetData());
+    header[0] = 2;
+    header[1] = 8;
+    header[2] = 4;
+    ASSERT_THROW(GatherView{*descending}, runtime_error);
+}
+
 auto RunMsgRebuild(const string& transport, bool expandedShmMetadata = false) -> void
 {
     ProgOptions config;
@@ -408,6 +534,31 @@ TEST(Resize, shmem_expanded_metadata) // NOLINT
     RunPushPullWithMsgResize("shmem", "ipc://test_message_resize", true);
 }
 
+TEST(Grow, zeromq) // NOLINT
+{
+    RunMsgGrow("zeromq");
+}
+
+TEST(Grow, shmem) // NOLINT
+{
+    RunMsgGrow("shmem");
+}
+
+TEST(Grow, shmem_segregated_fit) // NOLINT
+{
+    RunMsgGrow("shmem", "segregated_fit");
+}
+
+TEST(SendGather, zeromq) // NOLINT
+{
+    RunSendGather("zeromq", "ipc://test_send_gather");
+}
+
+TEST(SendGather, shmem) // NOLINT
+{
+    RunSendGather("shmem", "ipc://test_send_gather");
+}
+
 TEST(Rebuild, zeromq) // NOLINT
 {
     RunMsgRebuild("zeromq");
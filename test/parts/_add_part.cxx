@@ -61,6 +61,24 @@ TEST_F(AddPart, MultipleParts)
     ASSERT_TRUE(mParts.Size() == oldSize + 3);
 }
 
+TEST_F(AddPart, KeepsCapacity)
+{
+    mParts.Reserve(8);
+    auto const data = mParts.fParts.data();
+    mParts.AddPart(mFactory->NewSimpleMessage("1"));
+    mParts.AddPart(fair::mq::Parts(mFactory->NewSimpleMessage("2"), mFactory->NewSimpleMessage("3")));
+    ASSERT_EQ(mParts.Size(), 3);
+
+    mParts.Clear();
+    ASSERT_TRUE(mParts.Empty());
+    ASSERT_GE(mParts.Capacity(), 8);
+
+    // adding to an empty Parts with sufficient capacity keeps the storage
+    mParts.AddPart(fair::mq::Parts(mFactory->NewSimpleMessage("4"), mFactory->NewSimpleMessage("5")));
+    ASSERT_EQ(mParts.Size(), 2);
+    ASSERT_EQ(mParts.fParts.data(), data);
+}
+
 TEST(Construction, AppendMultipleParts)
 {
     auto factory = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
@@ -191,6 +191,43 @@ TEST(ProgOptions, SubscribeAndSet)
                                         { fs::path("C:\\Windows"), fs::path("C:\\Windows\\System32") });
 }
 
+TEST(ProgOptions, PropertyHandle)
+{
+    ProgOptions o;
+    o.SetProperty<float>("threshold", 1.5);
+    o.SetProperty<string>("label", "first");
+
+    ASSERT_THROW(o.GetPropertyHandle<float>("nonexistent"), PropertyNotFoundError);
+
+    auto threshold = o.GetPropertyHandle<float>("threshold");
+    auto label = o.GetPropertyHandle<string>("label");
+    EXPECT_EQ(threshold.Get(), 1.5);
+    EXPECT_EQ(label.Get(), "first");
+
+    o.SetProperty<float>("threshold", 2.5);
+    o.UpdateProperty<string>("label", "second");
+    EXPECT_EQ(threshold.Get(), 2.5);
+    EXPECT_EQ(*label, "second");
+
+    // a snapshot keeps its value across updates
+    auto snapshot = label.Snapshot();
+    o.SetProperty<string>("label", "third");
+    EXPECT_EQ(*snapshot, "second");
+    EXPECT_EQ(*label.Snapshot(), "third");
+
+    o.SetProperties({{"threshold", boost::any(3.5f)}});
+    EXPECT_EQ(*threshold, 3.5);
+    EXPECT_EQ(o.GetPropertyHandle<float>("threshold").Get(), 3.5);
+
+    // type change: handle keeps the last value of its type
+    o.SetProperty<int>("threshold", 4);
+    EXPECT_EQ(threshold.Get(), 3.5);
+
+    // deletion: handle keeps the last value
+    o.DeleteProperty("label");
+    EXPECT_EQ(label.Get(), "third");
+}
+
 TEST(PropertyHelper, ConvertPropertyToString)
 {
     EXPECT_EQ(PropertyHelper::ConvertPropertyToString(Property(static_cast<char>('a'))), "a");
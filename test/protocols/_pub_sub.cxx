@@ -40,6 +40,8 @@ auto RunPubSub(string transport) -> void
             << " --id pub_" << transport
             << " --control static"
             << " --session " << session
+            << " --transport " << transport
+            << " --shm-segment-size 100000000"
             << " --color false"
             << " --channel-config name=data,type=pub,method=bind,address=" << dataAddress
             << "                  name=control,type=pull,method=bind,address=" << ctrlAddress;
@@ -53,6 +55,8 @@ auto RunPubSub(string transport) -> void
             << " --id sub_1" << transport
             << " --control static"
             << " --session " << session
+            << " --transport " << transport
+            << " --shm-segment-size 100000000"
             << " --color false"
             << " --channel-config name=data,type=sub,method=connect,address=" << dataAddress
             << "                  name=control,type=push,method=connect,address=" << ctrlAddress;
@@ -66,6 +70,8 @@ auto RunPubSub(string transport) -> void
             << " --id sub_2" << transport
             << " --control static"
             << " --session " << session
+            << " --transport " << transport
+            << " --shm-segment-size 100000000"
             << " --color false"
             << " --channel-config name=data,type=sub,method=connect,address=" << dataAddress
             << "                  name=control,type=push,method=connect,address=" << ctrlAddress;
@@ -88,4 +94,9 @@ TEST(PubSub, zeromq)
     EXPECT_EXIT(RunPubSub("zeromq"), ::testing::ExitedWithCode(0), "PUB-SUB test successfull");
 }
 
+TEST(PubSub, shmem)
+{
+    EXPECT_EXIT(RunPubSub("shmem"), ::testing::ExitedWithCode(0), "PUB-SUB test successfull");
+}
+
 } // namespace
@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <cstring> // memset
 #include <map>
 #include <memory> // make_unique
 #include <string>
@@ -335,6 +336,98 @@ void RegionCallbacks(const string& transport, const string& _address)
     LOG(info) << "2 done.";
 }
 
+void RegionBlocks(const string& transport, const string& _address)
+{
+    size_t session(tools::UuidHash());
+    std::string address(tools::ToString(_address, "_", transport));
+
+    ProgOptions config;
+    config.SetProperty<string>("session", to_string(session));
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<bool>("shm-monitor", true);
+
+    auto factory = TransportFactory::CreateTransportFactory(transport, tools::Uuid(), &config);
+
+    Channel push("Push", "push", factory);
+    push.Bind(address);
+
+    Channel pull("Pull", "pull", factory);
+    pull.Connect(address);
+
+    constexpr size_t numBlocks = 64;
+    constexpr size_t blockSize = 100;
+    tools::Semaphore blocker;
+    size_t numAcks = 0;
+
+    auto region = factory->CreateUnmanagedRegion(numBlocks * blockSize, [&](const std::vector<RegionBlock>& blocks) {
+        numAcks += blocks.size();
+        if (numAcks == numBlocks) {
+            blocker.Signal();
+        }
+    });
+
+    std::vector<RegionBlock> blocks;
+    for (size_t i = 0; i < numBlocks; ++i) {
+        char* ptr = static_cast<char*>(region->GetData()) + i * blockSize;
+        std::memset(ptr, static_cast<int>(i), blockSize);
+        blocks.emplace_back(ptr, blockSize, reinterpret_cast<void*>(i + 1));
+    }
+
+    ASSERT_EQ(push.SendRegionBlocks(region, blocks), numBlocks * blockSize);
+
+    {
+        Parts parts;
+        ASSERT_EQ(pull.Receive(parts), numBlocks * blockSize);
+        ASSERT_EQ(parts.Size(), numBlocks);
+        for (size_t i = 0; i < numBlocks; ++i) {
+            ASSERT_EQ(parts[i].GetSize(), blockSize);
+            ASSERT_EQ(static_cast<char*>(parts[i].GetData())[blockSize - 1], static_cast<char>(i));
+        }
+    }
+
+    blocker.Wait();
+}
+
+void RegionBlocksUnsent(const string& transport, const string& _address)
+{
+    size_t session(tools::UuidHash());
+    std::string address(tools::ToString(_address, "_", transport));
+
+    ProgOptions config;
+    config.SetProperty<string>("session", to_string(session));
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<bool>("shm-monitor", true);
+
+    auto factory = TransportFactory::CreateTransportFactory(transport, tools::Uuid(), &config);
+
+    // no peer ever connects, the send times out
+    Channel push("Push", "push", factory);
+    push.Bind(address);
+
+    constexpr size_t numBlocks = 16;
+    constexpr size_t blockSize = 100;
+    tools::Semaphore blocker;
+    size_t numAcks = 0;
+
+    auto region = factory->CreateUnmanagedRegion(numBlocks * blockSize, [&](const std::vector<RegionBlock>& blocks) {
+        numAcks += blocks.size();
+        if (numAcks == numBlocks) {
+            blocker.Signal();
+        }
+    });
+
+    std::vector<RegionBlock> blocks;
+    for (size_t i = 0; i < numBlocks; ++i) {
+        blocks.emplace_back(static_cast<char*>(region->GetData()) + i * blockSize, blockSize, reinterpret_cast<void*>(i + 1));
+    }
+
+    ASSERT_EQ(push.SendRegionBlocks(region, blocks, 0), static_cast<int64_t>(TransferCode::timeout));
+
+    // the unsent blocks are released via the region callback
+    blocker.Wait();
+    ASSERT_EQ(numAcks, numBlocks);
+}
+
 TEST(RegionsSizeMismatch, shmem)
 {
     RegionsSizeMismatch();
@@ -370,6 +463,26 @@ TEST(Callbacks, shmem)
     RegionCallbacks("shmem", "ipc://test_region_callbacks");
 }
 
+TEST(Blocks, zeromq)
+{
+    RegionBlocks("zeromq", "ipc://test_region_blocks");
+}
+
+TEST(Blocks, shmem)
+{
+    RegionBlocks("shmem", "ipc://test_region_blocks");
+}
+
+TEST(BlocksUnsent, zeromq)
+{
+    RegionBlocksUnsent("zeromq", "ipc://test_region_blocks_unsent");
+}
+
+TEST(BlocksUnsent, shmem)
+{
+    RegionBlocksUnsent("shmem", "ipc://test_region_blocks_unsent");
+}
+
 TEST(EventSubscriptionsExternalRegion, shmem)
 {
     RegionEventSubscriptions("shmem", true);
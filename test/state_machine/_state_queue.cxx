@@ -0,0 +1,119 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/StateQueue.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace std;
+using namespace fair::mq;
+
+TEST(StateQueue, PushAndWait)
+{
+    using namespace std::chrono_literals;
+
+    StateQueue queue;
+    EXPECT_EQ(queue.WaitForNext(10ms), make_pair(false, State::Ok));
+
+    queue.Push(State::Idle);
+    queue.Push(State::InitializingDevice);
+    EXPECT_EQ(queue.WaitForNext(), State::Idle);
+    EXPECT_EQ(queue.WaitForNext(10ms), make_pair(true, State::InitializingDevice));
+
+    // an error state stays at the front
+    queue.Push(State::Error);
+    EXPECT_THROW(queue.WaitForNext(), DeviceErrorState);
+    EXPECT_THROW(queue.WaitForNext(), DeviceErrorState);
+    queue.Clear();
+    EXPECT_EQ(queue.WaitForNext(0ms), make_pair(false, State::Ok));
+
+    // a full queue drops the oldest states
+    for (size_t i = 0; i < StateQueue::kCapacity + 2; ++i) {
+        queue.Push(i < 2 ? State::Idle : State::Running);
+    }
+    EXPECT_EQ(queue.WaitForNext(), State::Running);
+    queue.Clear();
+
+    // an error state is never dropped, new states are dropped instead
+    queue.Push(State::Error);
+    for (size_t i = 0; i < StateQueue::kCapacity + 2; ++i) {
+        queue.Push(State::Running);
+    }
+    EXPECT_THROW(queue.WaitForNext(), DeviceErrorState);
+    queue.Clear();
+
+    // a state dropped from the full queue counts as consumed for WaitForState
+    queue.Push(State::Bound);
+    for (size_t i = 0; i < StateQueue::kCapacity; ++i) {
+        queue.Push(State::Running);
+    }
+    queue.WaitForState(State::Bound);
+    EXPECT_EQ(queue.WaitForNext(), State::Running);
+    queue.Clear();
+
+    atomic<bool> flag(false);
+    thread notifier([&] {
+        this_thread::sleep_for(50ms);
+        queue.Notify([&] { flag = true; });
+    });
+    EXPECT_EQ(queue.WaitForCustom([&] { return flag.load(); }), make_pair(false, State::Ok));
+    notifier.join();
+}
+
+TEST(StateQueue, ConcurrentPushers)
+{
+    StateQueue queue;
+    constexpr int numPushers = 4;
+    constexpr int numStates = 60; // all fit into the queue
+    vector<thread> pushers;
+    for (int i = 0; i < numPushers; ++i) {
+        pushers.emplace_back([&] {
+            for (int j = 0; j < numStates; ++j) {
+                queue.Push(j % 2 ? State::Running : State::Ready);
+            }
+        });
+    }
+    int running = 0;
+    for (int i = 0; i < numPushers * numStates; ++i) {
+        running += queue.WaitForNext() == State::Running ? 1 : 0;
+    }
+    for (auto& t : pushers) {
+        t.join();
+    }
+    EXPECT_EQ(running, numPushers * numStates / 2);
+    EXPECT_FALSE(queue.WaitForNext(std::chrono::milliseconds(0)).first);
+}
+
+TEST(StateQueue, LockedIsExclusive)
+{
+    StateQueue queue;
+    constexpr int numSignals = 10000;
+    int counter = 0; // not atomic, the signals are serialized
+    vector<thread> signalers;
+    for (int i = 0; i < 4; ++i) {
+        signalers.emplace_back([&] {
+            for (int j = 0; j < numSignals; ++j) {
+                queue.Locked([&] { ++counter; });
+            }
+        });
+    }
+    queue.WaitForCustom([&] { return counter == 4 * numSignals; });
+    for (auto& t : signalers) {
+        t.join();
+    }
+    EXPECT_EQ(counter, 4 * numSignals);
+}
+
+} // namespace
@@ -0,0 +1,57 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/tools/RateLimit.h>
+#include <gtest/gtest.h>
+#include <chrono>
+
+namespace
+{
+
+using namespace fair::mq::tools;
+using namespace std::chrono;
+
+// runs iterations of an empty loop limited to rate, returns the elapsed time
+nanoseconds RunLimited(float rate, RateLimiter::Pacing pacing, int iterations)
+{
+    auto start = steady_clock::now();
+    RateLimiter limiter(rate, pacing);
+    for (int i = 0; i < iterations; ++i) {
+        limiter.maybe_sleep();
+    }
+    return duration_cast<nanoseconds>(steady_clock::now() - start);
+}
+
+TEST(Tools, RateLimiterPrecise)
+{
+    // 2000 iterations at 20 kHz, deadlines never release an iteration early
+    auto elapsed = RunLimited(20000, RateLimiter::Pacing{true, nanoseconds(0), 1}, 2000);
+    EXPECT_GE(elapsed, milliseconds(100));
+    EXPECT_LT(elapsed, milliseconds(400));
+}
+
+TEST(Tools, RateLimiterPreciseSpin)
+{
+    auto elapsed = RunLimited(20000, RateLimiter::Pacing{true, microseconds(20), 1}, 2000);
+    EXPECT_GE(elapsed, milliseconds(100));
+    EXPECT_LT(elapsed, milliseconds(400));
+}
+
+TEST(Tools, RateLimiterPreciseBurst)
+{
+    // 100 iterations at 1 kHz, released in bursts of 10 every 10 ms
+    auto elapsed = RunLimited(1000, RateLimiter::Pacing{true, nanoseconds(0), 10}, 100);
+    EXPECT_GE(elapsed, milliseconds(100));
+    EXPECT_LT(elapsed, milliseconds(400));
+
+    // the first 9 iterations of a burst pass without waiting
+    elapsed = RunLimited(1, RateLimiter::Pacing{true, nanoseconds(0), 10}, 9);
+    EXPECT_LT(elapsed, milliseconds(500));
+}
+
+} // namespace
@@ -0,0 +1,55 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/tools/Thread.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using namespace fair::mq::tools;
+
+TEST(Tools, ThreadParseCpuList)
+{
+    EXPECT_EQ(ParseCpuList("0-3,8"), std::vector<int>({0, 1, 2, 3, 8}));
+    EXPECT_EQ(ParseCpuList("5"), std::vector<int>({5}));
+    EXPECT_TRUE(ParseCpuList("").empty());
+    EXPECT_THROW(ParseCpuList("3-1"), ThreadPlacementError);
+    EXPECT_THROW(ParseCpuList("a"), ThreadPlacementError);
+    EXPECT_THROW(ParseCpuList(std::to_string(MaxCpus())), ThreadPlacementError);
+    EXPECT_THROW(ParseCpuList("0-100000"), ThreadPlacementError);
+    EXPECT_EQ(ParseCpuList(std::to_string(MaxCpus() - 1)), std::vector<int>({MaxCpus() - 1}));
+}
+
+TEST(Tools, ThreadParsePlacement)
+{
+    std::vector<std::string> affinity{"io:2-3", "housekeeping:0"};
+    std::vector<std::string> sched{"io:fifo:10"};
+
+    auto io = ParseThreadPlacement(affinity, sched, "io");
+    EXPECT_EQ(io.cpus, std::vector<int>({2, 3}));
+    EXPECT_EQ(io.policy, "fifo");
+    EXPECT_EQ(io.priority, 10);
+
+    auto hk = ParseThreadPlacement(affinity, sched, "housekeeping");
+    EXPECT_EQ(hk.cpus, std::vector<int>({0}));
+    EXPECT_TRUE(hk.policy.empty());
+
+    EXPECT_TRUE(ParseThreadPlacement(affinity, sched, "device").Empty());
+    EXPECT_THROW(ParseThreadPlacement({}, {"io:nonsense"}, "io"), ThreadPlacementError);
+
+    // realtime policies default to their minimum priority, priorities out of range are rejected
+    EXPECT_EQ(ParseThreadPlacement({}, {"io:rr"}, "io").priority, sched_get_priority_min(SCHED_RR));
+    EXPECT_EQ(ParseThreadPlacement({}, {"io:other"}, "io").priority, 0);
+    EXPECT_THROW(ParseThreadPlacement({}, {"io:fifo:0"}, "io"), ThreadPlacementError);
+    EXPECT_THROW(ParseThreadPlacement({}, {"io:other:5"}, "io"), ThreadPlacementError);
+}
+
+} /* namespace */
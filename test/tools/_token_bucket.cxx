@@ -0,0 +1,69 @@
+/********************************************************************************
+ *    Copyright (C) 2025 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/tools/TokenBucket.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace fair::mq::tools;
+using namespace std::chrono;
+
+TEST(Tools, TokenBucketReserve)
+{
+    // 1000 units per second (1 ms per unit), burst of 10 ms
+    TokenBucket bucket(1000, milliseconds(10));
+    const nanoseconds unlimited(-1);
+
+    // the burst allowance is available at once, an amount larger than the burst too
+    EXPECT_EQ(bucket.Reserve(10, unlimited), nanoseconds(0));
+    EXPECT_EQ(bucket.Reserve(100, unlimited), nanoseconds(0));
+
+    // the following consumer waits for the 110 units to be paid off (minus the burst allowance)
+    auto wait = bucket.Reserve(1, unlimited);
+    EXPECT_GT(wait, milliseconds(95));
+    EXPECT_LE(wait, milliseconds(100));
+
+    // nothing is reserved if the wait exceeds maxWait
+    EXPECT_LT(bucket.Reserve(1, milliseconds(50)).count(), 0);
+    EXPECT_LT(bucket.Reserve(1, nanoseconds(0)).count(), 0);
+
+    // released amounts shorten the wait
+    bucket.Release(101);
+    wait = bucket.Reserve(1, unlimited);
+    EXPECT_LE(wait, milliseconds(1));
+}
+
+TEST(Tools, TokenBucketConcurrentReserve)
+{
+    TokenBucket bucket(1000000, nanoseconds(0)); // 1 us per unit
+    const auto start = steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                bucket.Reserve(100, nanoseconds(-1));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // 4000 reservations of 100 us are queued up behind each other, none of them is lost
+    const auto wait = bucket.Reserve(0, nanoseconds(-1));
+    EXPECT_GE(wait + (steady_clock::now() - start), milliseconds(400));
+    EXPECT_LE(wait, milliseconds(400));
+}
+
+} // namespace
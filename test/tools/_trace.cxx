@@ -0,0 +1,62 @@
+/********************************************************************************
+ *    Copyright (C) 2024 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <fairmq/tools/Trace.h>
+#include <fairmq/tools/Unique.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio> // std::remove
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+
+using namespace fair::mq::tools;
+
+TEST(Tools, TraceRecordAndWrite)
+{
+    Trace& trace = Trace::Instance();
+    trace.Disable();
+    trace.Enable();
+
+    {
+        TraceSpan span("phase \"one\"", "test");
+    }
+    trace.Instant("transition", "test");
+
+    auto events = trace.GetEvents();
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events.at(0).name, "phase \"one\"");
+    EXPECT_EQ(events.at(0).category, "test");
+    EXPECT_GE(events.at(0).duration, 0);
+    EXPECT_EQ(events.at(1).duration, -1);
+    EXPECT_GE(events.at(1).begin, events.at(0).begin);
+
+    std::string filename("/tmp/fairmq_trace_test_" + Uuid() + ".json");
+    ASSERT_TRUE(trace.Write(filename));
+    std::ifstream file(filename);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(content.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0);
+    EXPECT_NE(content.find("\"name\":\"phase \\\"one\\\"\""), std::string::npos);
+    EXPECT_NE(content.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(content.find("\"ph\":\"i\""), std::string::npos);
+    EXPECT_EQ(std::count(content.begin(), content.end(), '{'), 3);
+
+    trace.Disable();
+    {
+        TraceSpan span("dropped", "test");
+    }
+    EXPECT_TRUE(trace.GetEvents().empty());
+}
+
+} // namespace
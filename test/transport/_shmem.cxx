@@ -6,14 +6,28 @@
  *                  copied verbatim in the file "LICENSE"                       *
  ********************************************************************************/
 
+#include <fairmq/Channel.h>
 #include <fairmq/ProgOptions.h>
+#include <fairmq/shmem/Common.h>
 #include <fairmq/shmem/Monitor.h>
+#include <fairmq/shmem/Prefault.h>
 #include <fairmq/tools/Unique.h>
 #include <fairmq/TransportFactory.h>
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint> // uintptr_t
+#include <cstring> // memset
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility> // make_pair
+#include <vector>
+
+#include <sys/wait.h> // waitpid
+#include <unistd.h> // getpid, fork
 
 namespace
 {
@@ -36,9 +50,509 @@ void GetFreeMemory()
     ASSERT_THROW(shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 1), shmem::Monitor::MonitorError);
 }
 
+void SegregatedFitAllocation()
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<string>("shm-allocation", "segregated_fit");
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+    size_t freeBefore = shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0);
+    ASSERT_EQ(shmem::Monitor::GetCachedMemory(shmem::SessionId{sessionId}, 0), 0);
+
+    {
+        vector<MessagePtr> msgs;
+        for (size_t size : {0, 1, 200, 1000, 4096, 70000, 1 << 20, 3 << 20}) {
+            msgs.push_back(factory->CreateMessage(size, Alignment{64}));
+            ASSERT_EQ(msgs.back()->GetSize(), size);
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(msgs.back()->GetData()) % 64, 0);
+            memset(msgs.back()->GetData(), 'x', size);
+        }
+        // shrinking keeps the data, regardless of whether the block is in a size class or not
+        for (auto& msg : msgs) {
+            if (msg->GetSize() > 1) {
+                ASSERT_TRUE(msg->SetUsedSize(msg->GetSize() / 2));
+                ASSERT_EQ(static_cast<char*>(msg->GetData())[0], 'x');
+            }
+        }
+    }
+
+    // freed blocks remain cached in the size classes, they are reported separately from the free memory
+    // (together they match the initial free memory, minus the bookkeeping overhead of the allocator for the carved slabs)
+    size_t freeAfter = shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0);
+    size_t cachedAfter = shmem::Monitor::GetCachedMemory(shmem::SessionId{sessionId}, 0);
+    ASSERT_GT(cachedAfter, 0);
+    ASSERT_LT(freeAfter, freeBefore);
+    ASSERT_LE(freeAfter + cachedAfter, freeBefore);
+    ASSERT_LT(freeBefore - (freeAfter + cachedAfter), 1024);
+}
+
+void AllocationWakesUpOnFree()
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<size_t>("shm-segment-size", 10000000);
+    // wait up to 20s, polling would only retry after 10s
+    config.SetProperty<int>("bad-alloc-max-attempts", 3);
+    config.SetProperty<int>("bad-alloc-attempt-interval", 10000);
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+
+    auto msg1 = factory->CreateMessage(8000000);
+    thread releaser([&msg1]() {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        msg1.reset();
+    });
+
+    auto start = chrono::steady_clock::now();
+    auto msg2 = factory->CreateMessage(8000000);
+    auto waited = chrono::steady_clock::now() - start;
+    releaser.join();
+
+    ASSERT_EQ(msg2->GetSize(), 8000000);
+    ASSERT_LT(waited, chrono::seconds(5));
+}
+
+void RegionEventLogReadAndOverrun()
+{
+    using namespace boost::posix_time;
+    auto log = make_unique<shmem::RegionEventLog>();
+    auto never = [] { return false; };
+    vector<shmem::RegionEventLog::Entry> entries;
+
+    uint64_t position = log->Next();
+    log->Append(1, false, false);
+    log->Append(0, true, false);
+    log->Append(1, false, true);
+    ASSERT_TRUE(log->Read(position, entries, microsec_clock::universal_time() + milliseconds(100), never));
+    ASSERT_EQ(entries.size(), 3);
+    ASSERT_EQ(position, 3);
+    EXPECT_EQ(entries.at(0).fId, 1);
+    EXPECT_FALSE(entries.at(0).fManaged);
+    EXPECT_TRUE(entries.at(1).fManaged);
+    EXPECT_TRUE(entries.at(2).fDestroyed);
+
+    // no new events: returns at the deadline without entries
+    entries.clear();
+    ASSERT_TRUE(log->Read(position, entries, microsec_clock::universal_time() + milliseconds(10), never));
+    ASSERT_TRUE(entries.empty());
+
+    // a writer wakes up a waiting reader
+    thread writer([&] {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        log->Append(2, false, false);
+    });
+    ASSERT_TRUE(log->Read(position, entries, microsec_clock::universal_time() + seconds(10), never));
+    writer.join();
+    ASSERT_EQ(entries.size(), 1);
+
+    // falling behind by more than the capacity is reported
+    for (uint64_t i = 0; i < shmem::RegionEventLog::kCapacity + 1; ++i) {
+        log->Append(3, false, false);
+    }
+    entries.clear();
+    ASSERT_FALSE(log->Read(position, entries, microsec_clock::universal_time() + milliseconds(10), never));
+    ASSERT_EQ(entries.size(), shmem::RegionEventLog::kCapacity);
+    ASSERT_EQ(position, log->Next());
+}
+
+void Accounting()
+{
+    EXPECT_EQ(shmem::ShmAccounting::SizeClass(1), 0);
+    EXPECT_EQ(shmem::ShmAccounting::SizeClass(128), 0);
+    EXPECT_EQ(shmem::ShmAccounting::SizeClass(129), 1);
+    EXPECT_EQ(shmem::ShmAccounting::SizeClass(size_t(1) << 40), shmem::ShmAccounting::kNumSizeClasses - 1);
+
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+
+    auto own = [&]() {
+        for (const auto& info : shmem::Monitor::GetAccountingInfo(shmem::SessionId{sessionId})) {
+            if (info.fPid == getpid()) {
+                return info;
+            }
+        }
+        throw runtime_error("no accounting slot for the own process");
+    };
+
+    {
+        vector<MessagePtr> msgs;
+        for (size_t size : {100, 1000, 1000, 1 << 20}) {
+            msgs.push_back(factory->CreateMessage(size));
+        }
+        auto info = own();
+        EXPECT_TRUE(info.fAlive);
+        EXPECT_EQ(info.fSegmentId, 0);
+        EXPECT_EQ(info.fAllocations, 4);
+        EXPECT_EQ(info.fOutstanding, 4);
+        EXPECT_GT(info.fBytes, (1 << 20) + 2100);
+        EXPECT_EQ(info.fOutstandingBySize.size(), 3);
+        EXPECT_EQ(info.fNumOldest, 4);
+        EXPECT_FALSE(info.fOlderThanTracked);
+
+        uint64_t bytes = info.fBytes;
+        ASSERT_TRUE(msgs.back()->SetUsedSize(1000));
+        EXPECT_LT(own().fBytes, bytes - 1000000);
+    }
+
+    auto info = own();
+    EXPECT_EQ(info.fAllocations, 4);
+    EXPECT_EQ(info.fOutstanding, 0);
+    EXPECT_EQ(info.fBytes, 0);
+    EXPECT_GT(info.fPeakBytes, (1 << 20));
+}
+
+void Fragmentation()
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+
+    EXPECT_TRUE(shmem::Monitor::GetFragmentationInfo(shmem::SessionId{sessionId}).empty());
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+
+    auto infos = shmem::Monitor::GetFragmentationInfo(shmem::SessionId{sessionId});
+    ASSERT_EQ(infos.size(), 1);
+    EXPECT_EQ(infos.at(0).fAllocationAlgorithm, "rbtree_best_fit");
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+    EXPECT_EQ(infos.at(0).fNumFreeBlocks, 1);
+#endif
+    // the largest free block is probed (up to 64 bytes) and excludes the allocator block header
+    EXPECT_NEAR(infos.at(0).fFragmentation, 0., 0.001);
+    // the free blocks include their block headers, the allocator free memory count differs slightly
+    EXPECT_NEAR(infos.at(0).fFreeMemory, shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0), 1024);
+
+    // free every other buffer, leaving 1 MB holes between the remaining ones
+    vector<MessagePtr> msgs;
+    for (int i = 0; i < 20; ++i) {
+        msgs.push_back(factory->CreateMessage(1000000));
+    }
+    for (size_t i = 0; i < msgs.size(); i += 2) {
+        msgs.at(i).reset();
+    }
+
+    infos = shmem::Monitor::GetFragmentationInfo(shmem::SessionId{sessionId});
+    ASSERT_EQ(infos.size(), 1);
+    const auto& info = infos.at(0);
+    EXPECT_NEAR(info.fFreeMemory, shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0), 1024);
+    EXPECT_LT(info.fLargestFreeBlock, info.fFreeMemory - 10 * 1000000);
+    EXPECT_GT(info.fFragmentation, 0.);
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+    EXPECT_EQ(info.fNumFreeBlocks, 11);
+    size_t counted = 0;
+    for (const auto& [limit, count] : info.fFreeBlockHistogram) {
+        counted += count;
+    }
+    EXPECT_EQ(counted, info.fNumFreeBlocks);
+    EXPECT_EQ(info.fFreeBlockHistogram.front(), make_pair(size_t(1) << 20, size_t(10)));
+#endif
+}
+
+void PrefaultAndZero()
+{
+    const size_t size = 3 * shmem::prefault::kChunkSize + 12345;
+    vector<char> expected(size);
+    for (size_t i = 0; i < size; ++i) {
+        expected[i] = static_cast<char>(i % 251);
+    }
+    vector<char> buffer(expected);
+
+    shmem::PrefaultConfig cfg;
+    cfg.threads = 4;
+    cfg.progress = [](size_t done, size_t total) { EXPECT_LE(done, total); };
+
+    // prefaulting does not modify the content
+    shmem::PrefaultMemory(buffer.data(), size, cfg);
+    EXPECT_EQ(buffer, expected);
+    cfg.populate = true;
+    shmem::PrefaultMemory(buffer.data(), size, cfg);
+    EXPECT_EQ(buffer, expected);
+
+    // zero two ranges, spanning several chunks, leave the rest untouched
+    const size_t firstEnd = shmem::prefault::kChunkSize + 100;
+    const size_t secondBegin = 2 * shmem::prefault::kChunkSize;
+    shmem::ZeroMemory({shmem::prefault::Range{buffer.data(), firstEnd}, shmem::prefault::Range{buffer.data() + secondBegin, size - secondBegin}}, cfg);
+    for (size_t i = 0; i < size; ++i) {
+        const char value = (i < firstEnd || i >= secondBegin) ? 0 : expected[i];
+        if (buffer[i] != value) {
+            FAIL() << "unexpected value at " << i;
+        }
+    }
+}
+
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+void ReclaimDeadBuffers(const string& allocationAlgorithm)
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", false);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<string>("shm-allocation", allocationAlgorithm);
+
+    // a child process allocates buffers and dies without freeing them
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) {
+        auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+        for (size_t size : {100, 1000, 1000, 100000, 2000000}) {
+            factory->CreateMessage(size).release(); // NOLINT(bugprone-unused-return-value)
+        }
+        _exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+    const size_t freeBefore = shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0);
+    auto msg = factory->CreateMessage(1000);
+
+    auto childInfo = [&]() {
+        for (const auto& info : shmem::Monitor::GetAccountingInfo(shmem::SessionId{sessionId})) {
+            if (info.fPid == child) {
+                return info;
+            }
+        }
+        throw runtime_error("no accounting slot for the child process");
+    };
+    EXPECT_FALSE(childInfo().fAlive);
+    EXPECT_EQ(childInfo().fOutstanding, 5);
+
+    // too young
+    auto result = shmem::Monitor::ReclaimDeadBuffers(shmem::SessionId{sessionId}, 3600, false);
+    EXPECT_EQ(result.fDeadPids, vector<pid_t>{child});
+    EXPECT_EQ(result.fBuffers, 0);
+    EXPECT_EQ(result.fSkipped, 5);
+
+    result = shmem::Monitor::ReclaimDeadBuffers(shmem::SessionId{sessionId}, 0, false);
+    EXPECT_EQ(result.fBuffers, 5);
+    EXPECT_GT(result.fBytes, 2102100);
+    EXPECT_EQ(childInfo().fOutstanding, 0);
+    EXPECT_EQ(childInfo().fBytes, 0);
+    EXPECT_GT(shmem::Monitor::GetFreeMemory(shmem::SessionId{sessionId}, 0), freeBefore);
+
+    // the buffers of the live process are left alone
+    result = shmem::Monitor::ReclaimDeadBuffers(shmem::SessionId{sessionId}, 0, false);
+    EXPECT_TRUE(result.fDeadPids.empty());
+    EXPECT_EQ(result.fBuffers, 0);
+    memset(msg->GetData(), 0, msg->GetSize());
+
+    // the child did not release its reference to the session
+    msg.reset();
+    factory.reset();
+    shmem::Monitor::Cleanup(shmem::SessionId{sessionId}, false);
+}
+
+void ReclaimKeepsBuffersInFlight()
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", false);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    const string address("ipc://test_shmem_in_flight_" + sessionId);
+    const size_t size = 1000000;
+
+    // a child process sends a buffer and dies before the receiver takes it over
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) {
+        auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+        Channel push{"data[0]", "push", factory};
+        push.Bind(address);
+        auto msg = factory->CreateMessage(size);
+        memset(msg->GetData(), 42, size);
+        if (push.Send(msg, 10000) != static_cast<int64_t>(size)) {
+            _exit(1);
+        }
+        // give the io thread the time to pass the meta data on to the receiver
+        this_thread::sleep_for(chrono::milliseconds(500));
+        _exit(0);
+    }
+
+    {
+        auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+        Channel pull{"data[1]", "pull", factory};
+        pull.Connect(address);
+        int status = 0;
+        ASSERT_EQ(waitpid(child, &status, 0), child);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+
+        // the queued buffer is attributed to no process while in flight, it is not reclaimed with its sender
+        auto result = shmem::Monitor::ReclaimDeadBuffers(shmem::SessionId{sessionId}, 0, false);
+        EXPECT_EQ(result.fBuffers, 0);
+
+        auto msg = factory->CreateMessage();
+        ASSERT_EQ(pull.Receive(msg, 1000), static_cast<int64_t>(size));
+        EXPECT_EQ(static_cast<const char*>(msg->GetData())[0], 42);
+        EXPECT_EQ(static_cast<const char*>(msg->GetData())[size - 1], 42);
+        for (const auto& info : shmem::Monitor::GetAccountingInfo(shmem::SessionId{sessionId})) {
+            if (info.fPid == getpid()) {
+                EXPECT_EQ(info.fOutstanding, 1);
+            }
+        }
+    }
+
+    // the child did not release its reference to the session
+    shmem::Monitor::Cleanup(shmem::SessionId{sessionId}, false);
+}
+#endif
+
+void Quota(const string& policy)
+{
+    ProgOptions config;
+    string sessionId(to_string(tools::UuidHash()));
+    config.SetProperty<string>("session", sessionId);
+    config.SetProperty<bool>("shm-monitor", true);
+    config.SetProperty<size_t>("shm-segment-size", 100000000);
+    config.SetProperty<size_t>("shm-quota", 4000000);
+    config.SetProperty<vector<string>>("shm-channel-quota", {"data=1500000"});
+    config.SetProperty<string>("shm-quota-policy", policy);
+
+    auto factory = TransportFactory::CreateTransportFactory("shmem", tools::Uuid(), &config);
+    Channel push{"data[0]", "push", factory};
+    Channel pull{"data[1]", "pull", factory};
+    push.Bind("ipc://test_shmem_quota_" + sessionId);
+    pull.Connect("ipc://test_shmem_quota_" + sessionId);
+
+    auto budget = [&](const string& channel) {
+        for (const auto& info : shmem::Monitor::GetBudgetInfo(shmem::SessionId{sessionId})) {
+            if (info.fPid == getpid() && info.fChannel == channel) {
+                return info;
+            }
+        }
+        throw runtime_error("no budget for '" + channel + "'");
+    };
+    EXPECT_EQ(budget("").fLimit, 4000000);
+    EXPECT_EQ(budget("data").fLimit, 1500000);
+
+    {
+        auto msg1 = push.NewMessage(1000000);
+        auto msg2 = factory->CreateMessage(1500000); // device budget only
+        EXPECT_GT(budget("").fBytes, 2500000);
+        EXPECT_GT(budget("data").fBytes, 1000000);
+        EXPECT_LT(budget("data").fBytes, 1001000);
+
+        if (policy == "fail") {
+            EXPECT_THROW(pull.NewMessage(1000000), MessageBadAlloc); // channel budget, shared by the sub-channels
+            EXPECT_THROW(factory->CreateMessage(2000000), MessageBadAlloc);
+            EXPECT_EQ(budget("").fFailed, 1);
+            EXPECT_EQ(budget("data").fFailed, 1);
+        } else if (policy == "drop") {
+            auto dropped = push.NewMessage(1000000);
+            ASSERT_EQ(dropped->GetSize(), 1000000);
+            memset(dropped->GetData(), 0, dropped->GetSize());
+            EXPECT_EQ(budget("data").fDropped, 1);
+            // a dropped message is counted as dropped, not as sent, and never arrives
+            EXPECT_EQ(push.Send(dropped), 1000000);
+            EXPECT_EQ(push.GetMessagesDropped(), 1);
+            EXPECT_EQ(push.GetMessagesTx(), 0);
+            auto received = pull.NewMessage();
+            EXPECT_EQ(pull.Receive(received, 100), static_cast<int>(TransferCode::timeout));
+            EXPECT_EQ(push.Send(msg1), 1000000);
+            EXPECT_EQ(pull.Receive(received, 1000), 1000000);
+        } else {
+            thread releaser([&msg2]() {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                msg2.reset();
+            });
+            auto msg3 = factory->CreateMessage(1500000);
+            releaser.join();
+            EXPECT_EQ(msg3->GetSize(), 1500000);
+            EXPECT_EQ(budget("").fBlocked, 1);
+        }
+    }
+
+    EXPECT_EQ(budget("").fBytes, 0);
+    EXPECT_EQ(budget("data").fBytes, 0);
+    EXPECT_GT(budget("").fPeakBytes, 2500000);
+}
+
 TEST(Monitor, GetFreeMemory)
 {
     GetFreeMemory();
 }
 
+TEST(Allocation, SegregatedFit)
+{
+    SegregatedFitAllocation();
+}
+
+TEST(Allocation, WakeUpOnFree)
+{
+    AllocationWakesUpOnFree();
+}
+
+TEST(Monitor, Accounting)
+{
+    Accounting();
+}
+
+TEST(Monitor, Fragmentation)
+{
+    Fragmentation();
+}
+
+#ifdef FAIRMQ_SHM_BLOCK_WALK
+TEST(Monitor, ReclaimDeadBuffers)
+{
+    ReclaimDeadBuffers("rbtree_best_fit");
+}
+
+TEST(Monitor, ReclaimDeadBuffersSegregatedFit)
+{
+    ReclaimDeadBuffers("segregated_fit");
+}
+
+TEST(Monitor, ReclaimKeepsBuffersInFlight)
+{
+    ReclaimKeepsBuffersInFlight();
+}
+#else
+TEST(Monitor, ReclaimDeadBuffersNotBuiltIn)
+{
+    EXPECT_THROW(shmem::Monitor::ReclaimDeadBuffers(shmem::SessionId{to_string(tools::UuidHash())}, 0, false), shmem::Monitor::MonitorError);
+}
+#endif
+
+TEST(Quota, Fail)
+{
+    Quota("fail");
+}
+
+TEST(Quota, Drop)
+{
+    Quota("drop");
+}
+
+TEST(Quota, Block)
+{
+    Quota("block");
+}
+
+TEST(Prefault, PrefaultAndZero)
+{
+    PrefaultAndZero();
+}
+
+TEST(RegionEventLog, ReadAndOverrun)
+{
+    RegionEventLogReadAndOverrun();
+}
+
 } // namespace